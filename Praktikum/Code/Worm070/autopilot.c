@@ -0,0 +1,314 @@
+// Worm070 - Aufgabenblatt 8
+// ============================================================================
+//  Modul: autopilot.c  –  Wegsuche zum nächsten Futter
+// ============================================================================
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "worm.h"
+#include "board_model.h"
+#include "worm_model.h"
+#include "headless.h"
+#include "timing.h"
+#include "bitboard.h"
+#include "reach.h"
+#include "autopilot.h"
+
+// ============================================================================
+//  initializeAutopilot / freeAutopilot
+// ============================================================================
+
+enum ResCodes initializeAutopilot(struct autopilot* aap, struct board* aboard)
+{
+    long cells = (long)(aboard->last_row + 1 + 2 * BOARD_BORDER) * aboard->stride;
+    long frontier_cap = (long)getNumberOfCells(aboard);
+
+    if (cells > aap->cells) {
+        freeAutopilot(aap);
+
+        aap->visited = calloc(cells, sizeof(uint32_t));
+        aap->parent  = malloc(cells * sizeof(cellidx_t));
+        aap->free_at = malloc(cells * sizeof(uint32_t));
+        if (aap->visited == NULL || aap->parent == NULL || aap->free_at == NULL) {
+            freeAutopilot(aap);
+            return RES_FAILED;
+        }
+        aap->cells      = cells;
+        aap->generation = 0;
+    }
+
+    if (frontier_cap > aap->frontier_cap) {
+        free(aap->frontier);
+        aap->frontier = malloc(frontier_cap * sizeof(cellidx_t));
+        if (aap->frontier == NULL) {
+            freeAutopilot(aap);
+            return RES_FAILED;
+        }
+        aap->frontier_cap = frontier_cap;
+    }
+
+    aap->expanded    = 0;
+    aap->path_length = -1;
+    aap->avoided     = false;
+    return RES_OK;
+}
+
+void freeAutopilot(struct autopilot* aap)
+{
+    free(aap->frontier);
+    free(aap->visited);
+    free(aap->parent);
+    free(aap->free_at);
+
+    aap->frontier     = NULL;
+    aap->visited      = NULL;
+    aap->parent       = NULL;
+    aap->free_at      = NULL;
+    aap->cells        = 0;
+    aap->frontier_cap = 0;
+}
+
+// ============================================================================
+//  planAutopilot
+// ============================================================================
+
+static inline bool isFood(cell_t code)
+{
+    return code >= BC_FOOD_1 && code <= BC_FOOD_3;
+}
+
+// Richtung, in der target direkt neben from liegt
+static enum WormHeading headingTowards(struct board* aboard,
+                                       cellidx_t from, cellidx_t target)
+{
+    for (int dir = 0; dir < WORM_HEADINGS; dir++) {
+        if (neighbourIndex(aboard, from, (enum WormHeading)dir) == target) {
+            return (enum WormHeading)dir;
+        }
+    }
+    return WORM_UP;   // nicht erreichbar: target ist immer ein Nachbar
+}
+
+// Fallenprüfung (siehe autopilot.h): dir, wenn danach genug Platz bleibt,
+// sonst die Richtung mit dem größten erreichbaren Gebiet.
+static enum WormHeading avoidTraps(struct reachTracker* areach,
+                                   struct worm* aworm,
+                                   enum WormHeading dir)
+{
+    int need = getWormLength(aworm);
+    int best_area = reachAfterMove(areach, dir);
+    enum WormHeading best = dir;
+
+    if (best_area >= need) {
+        return dir;
+    }
+    for (int d = 0; d < WORM_HEADINGS; d++) {
+        if (d != (int)dir) {
+            int area = reachAfterMove(areach, (enum WormHeading)d);
+            if (area > best_area) {
+                best_area = area;
+                best = (enum WormHeading)d;
+            }
+        }
+    }
+    return best;
+}
+
+// ----------------------------------------------------------------------------
+// Vorgehen:
+//    - neue Generation; läuft der Zähler über, wird visited einmal gelöscht
+//    - free_at für alle Wurmsegmente eintragen (siehe autopilot.h)
+//    - BFS schichtweise: depth ist die Zugnummer der gerade erreichten
+//      Zellen. Rand und Auffüllung sind Barrieren, es gibt also keine
+//      Koordinatenprüfung; jede Zelle kommt höchstens einmal in frontier.
+//    - beim ersten Futter abbrechen, sonst die zuletzt erreichte (am
+//      weitesten entfernte) Zelle als Ziel nehmen
+//    - über parent bis zum Nachbarn des Kopfes zurücklaufen
+//    - mit Reach-Tracker: Zug auf Fallen prüfen
+// ----------------------------------------------------------------------------
+int planAutopilot(struct autopilot* aap,
+                  struct board* aboard,
+                  struct worm* aworm,
+                  enum WormHeading* adir)
+{
+    if (++aap->generation == 0) {
+        memset(aap->visited, 0, aap->cells * sizeof(uint32_t));
+        aap->generation = 1;
+    }
+    uint32_t gen = aap->generation;
+
+    uint32_t delay = (uint32_t)aworm->pending_growth + 1;
+    for (unsigned int i = aworm->tail; i != aworm->head + 1; i++) {
+        aap->free_at[aworm->wormcells[i & aworm->mask]] = (i - aworm->tail) + delay;
+    }
+
+    const cell_t* cells = aboard->cells;
+    cellidx_t* frontier = aap->frontier;
+    cellidx_t start = getWormHeadCell(aworm);
+    cellidx_t goal  = start;
+    long qhead = 0;
+    long qtail = 0;
+    uint32_t depth = 0;
+    int found = -1;
+
+    aap->visited[start] = gen;
+    aap->parent[start]  = start;
+    frontier[qtail++]   = start;
+
+    while (qhead < qtail && found < 0) {
+        long layer_end = qtail;
+        depth++;
+
+        for (; qhead < layer_end && found < 0; qhead++) {
+            cellidx_t cur = frontier[qhead];
+
+            for (int dir = 0; dir < WORM_HEADINGS; dir++) {
+                cellidx_t next = (cellidx_t)(cur + aboard->dir_offset[dir]);
+                cell_t code = cells[next];
+
+                if (aap->visited[next] == gen || code == BC_BARRIER ||
+                    (code == BC_USED_BY_WORM && aap->free_at[next] > depth)) {
+                    continue;
+                }
+
+                aap->visited[next] = gen;
+                aap->parent[next]  = cur;
+                frontier[qtail++]  = next;
+
+                if (isFood(code)) {
+                    goal  = next;
+                    found = (int)depth;
+                    break;
+                }
+            }
+        }
+    }
+
+    aap->expanded    = qtail - 1;
+    aap->path_length = found;
+    aap->avoided     = false;
+
+    if (found < 0) {
+        goal = frontier[qtail - 1];   // am weitesten entfernt (oder start)
+    }
+
+    if (goal == start) {
+        *adir = aworm->heading;       // eingeschlossen
+        return found;
+    }
+
+    while (aap->parent[goal] != start) {
+        goal = aap->parent[goal];
+    }
+    *adir = headingTowards(aboard, start, goal);
+
+    if (aboard->reach != NULL) {
+        enum WormHeading safe = avoidTraps(aboard->reach, aworm, *adir);
+        aap->avoided = (safe != *adir);
+        *adir = safe;
+    }
+    return found;
+}
+
+// ============================================================================
+//  runAutopilotBenchmark
+// ============================================================================
+
+static int lengthClass(int length)
+{
+    int c = 0;
+    while (length > 1 && c < AP_BENCH_CLASSES - 1) {
+        length >>= 1;
+        c++;
+    }
+    return c;
+}
+
+// Startet ein Spiel und hängt Bitboard und Reach-Tracker an.
+static enum ResCodes startBenchmarkGame(int rows, int cols,
+                                        struct board* aboard,
+                                        struct worm* aworm,
+                                        struct bitboard* abits,
+                                        struct reachTracker* areach)
+{
+    if (startHeadlessGame(aboard, aworm, rows, cols) != RES_OK ||
+        attachBitboard(aboard, abits) != RES_OK ||
+        attachReachTracker(aboard, areach, aworm) != RES_OK) {
+        return RES_FAILED;
+    }
+    return RES_OK;
+}
+
+// Spielschleife des Benchmarks; Board, Wurm und Autopilot sind angelegt.
+static enum ResCodes benchmarkLoop(long ticks, int rows, int cols,
+                                   struct board* aboard,
+                                   struct worm* aworm,
+                                   struct autopilot* aap,
+                                   struct bitboard* abits,
+                                   struct reachTracker* areach,
+                                   struct autopilotBench* abench)
+{
+    while (abench->ticks < ticks) {
+        enum WormHeading dir;
+        int length = (int)(aworm->head - aworm->tail + 1);
+        int c = lengthClass(length);
+
+        long long t0 = monotonicNowNs();
+        planAutopilot(aap, aboard, aworm, &dir);
+        abench->ns[c] += monotonicNowNs() - t0;
+        abench->plans[c]++;
+        abench->expanded[c] += aap->expanded;
+        abench->avoided += aap->avoided;
+
+        setWormHeading(aworm, dir);
+
+        long food_before = aboard->food_eaten;
+        enum GameStates game_state = stepHeadlessGame(aboard, aworm);
+        abench->food += aboard->food_eaten - food_before;
+        abench->ticks++;
+
+        if (abench->ticks % AP_BENCH_GROW_EVERY == 0) {
+            growWorm(aworm, BONUS_MANUAL);
+        }
+
+        if (game_state != WORM_GAME_ONGOING) {
+            abench->games++;
+            if (startBenchmarkGame(rows, cols, aboard, aworm,
+                                   abits, areach) != RES_OK) {
+                return RES_FAILED;
+            }
+        }
+    }
+    return RES_OK;
+}
+
+enum ResCodes runAutopilotBenchmark(long ticks, int rows, int cols,
+                                    struct autopilotBench* abench)
+{
+    struct board theBoard = {0};
+    struct worm  theWorm  = {0};
+    struct autopilot ap   = {0};
+    struct bitboard bits  = {0};
+    struct reachTracker reach = {0};
+    enum ResCodes res = RES_FAILED;
+
+    memset(abench, 0, sizeof(*abench));
+
+    if (initializeBitboard(&bits, rows, cols) == RES_OK &&
+        startBenchmarkGame(rows, cols, &theBoard, &theWorm,
+                           &bits, &reach) == RES_OK &&
+        initializeAutopilot(&ap, &theBoard) == RES_OK) {
+        res = benchmarkLoop(ticks, rows, cols, &theBoard, &theWorm, &ap,
+                            &bits, &reach, abench);
+    }
+    abench->reach_incremental = reach.incremental;
+    abench->reach_fills       = reach.fills;
+
+    freeAutopilot(&ap);
+    freeReachTracker(&reach);
+    freeBitboard(&bits);
+    freeWorm(&theWorm);
+    freeBoard(&theBoard);
+    return res;
+}
@@ -0,0 +1,116 @@
+// Worm070 - Aufgabenblatt 8
+// ============================================================================
+//  autopilot.h – Automatische Steuerung über Wegsuche zum nächsten Futter
+//
+//  Idee:
+//    In jedem Spieltakt sucht eine Breitensuche (BFS) vom Kopf aus den
+//    kürzesten Weg zum nächsten Futterstück (BC_FOOD_1 bis BC_FOOD_3) und
+//    setzt die Richtung auf den ersten Schritt dieses Weges. Alle acht
+//    Richtungen aus enum WormHeading kosten einen Zug, daher ist die BFS
+//    bereits optimal (A* brächte bei mehreren Zielen und Einheitskosten
+//    nur eine Prioritätswarteschlange mit sich).
+//
+//  Wurmzellen, die unterwegs frei werden:
+//    Zug d (d = 1, 2, ...) gibt vor dem Schritt das Schwanzsegment frei,
+//    sofern kein Wachstum mehr aussteht (cleanWormTail()). Segment k (vom
+//    Schwanz gezählt, ab 0) ist bei ausstehendem Wachstum p also ab Zug
+//    k + p + 1 frei. Die Suche darf eine Wurmzelle in Tiefe d betreten,
+//    wenn sie bis dahin frei ist; insbesondere zählt die Schwanzzelle schon
+//    beim ersten Zug als frei. Wachstum durch Futter unterwegs wird nicht
+//    berücksichtigt.
+//
+//  Ohne erreichbares Futter steuert der Autopilot die am weitesten
+//  entfernte erreichbare Zelle an (viel Platz), ganz ohne freie Nachbarn
+//  behält er die Richtung bei.
+//
+//  Fallen:
+//    Hängt am Board ein Reach-Tracker (reach.h), prüft der Autopilot den
+//    geplanten Zug: Ist das danach erreichbare Gebiet kleiner als der Wurm
+//    (Länge plus ausstehendes Wachstum), sperrt er sich ein. Dann nimmt er
+//    die Richtung mit dem größten Gebiet. Der Tracker beantwortet die
+//    Frage meist ohne Flood Fill.
+//
+//  Speicher:
+//    Warteschlange (frontier), besucht-Markierung (visited), Vorgänger
+//    (parent) und Freigabezeitpunkte (free_at) werden einmal in der Größe
+//    des Boards angelegt. visited enthält statt true/false die Generation
+//    der Suche, in der die Zelle erreicht wurde: eine neue Suche erhöht nur
+//    generation, nichts muss gelöscht werden. Ein Plan kommt damit ohne
+//    malloc und ohne Löschen aus; der Aufwand ist proportional zur
+//    durchsuchten Fläche.
+// ============================================================================
+
+#ifndef _AUTOPILOT_H
+#define _AUTOPILOT_H
+
+#include <stdint.h>
+#include "worm.h"
+#include "board_model.h"
+#include "worm_model.h"
+
+// ---------------------------------------------------------------------------
+//  struct autopilot – wiederverwendbare Suchpuffer
+// ---------------------------------------------------------------------------
+struct autopilot {
+    long cells;              // Einträge in visited/parent/free_at (Zellnummern)
+    long frontier_cap;       // Einträge in frontier (Zellen des Spielfelds)
+
+    cellidx_t* frontier;     // BFS-Warteschlange, Schicht für Schicht
+    uint32_t* visited;       // Generation, in der die Zelle erreicht wurde
+    cellidx_t* parent;       // Vorgänger auf dem kürzesten Weg
+    uint32_t* free_at;       // Wurmzellen: Zug, ab dem die Zelle frei ist
+    uint32_t generation;     // Nummer der aktuellen Suche
+
+    long expanded;           // in der letzten Suche erreichte Zellen
+    int path_length;         // Länge des letzten Weges zum Futter, -1 = keiner
+    bool avoided;            // letzter Plan wurde wegen einer Falle geändert
+};
+
+// Legt die Suchpuffer passend zur Größe von aboard an. Vor dem ersten
+// Aufruf muss der Autopilot mit Nullen initialisiert sein; danach wird
+// vorhandener Speicher weiterverwendet, wenn er reicht.
+// RES_FAILED ohne Speicher.
+extern enum ResCodes initializeAutopilot(struct autopilot* aap,
+                                         struct board* aboard);
+
+extern void freeAutopilot(struct autopilot* aap);
+
+// Plant einen Zug: sucht den kürzesten Weg zum nächsten Futter und legt
+// die Richtung des ersten Schritts in *adir ab (ohne Ziel siehe oben).
+// Der Wurm wird nicht verändert. Liefert die Weglänge oder -1, wenn kein
+// Futter erreichbar ist.
+extern int planAutopilot(struct autopilot* aap,
+                         struct board* aboard,
+                         struct worm* aworm,
+                         enum WormHeading* adir);
+
+// ---------------------------------------------------------------------------
+//  Benchmark der Planungskosten
+// ---------------------------------------------------------------------------
+// runAutopilotBenchmark() spielt ticks Schritte headless mit dem Autopiloten
+// auf einem rows x cols großen Feld. Damit der Wurm auch ohne Futter wächst,
+// kommt alle AP_BENCH_GROW_EVERY Schritte BONUS_MANUAL hinzu. Beendete
+// Spiele werden neu gestartet. Gemessen wird jeder planAutopilot()-Aufruf,
+// aufgeteilt nach der Wurmlänge in Zweierpotenz-Klassen:
+// Klasse i enthält Längen 2^i bis 2^(i+1) - 1. Am Board hängen Bitboard
+// und Reach-Tracker, die Fallenprüfung ist also mitgemessen.
+// ---------------------------------------------------------------------------
+#define AP_BENCH_CLASSES    24
+#define AP_BENCH_GROW_EVERY 4
+
+struct autopilotBench {
+    long plans[AP_BENCH_CLASSES];       // Anzahl Planungen je Längenklasse
+    long long ns[AP_BENCH_CLASSES];     // Summe der Planungszeit
+    long long expanded[AP_BENCH_CLASSES]; // Summe der erreichten Zellen
+    long ticks;                         // ausgeführte Spielschritte
+    long games;                         // beendete Spiele
+    long food;                          // gefressene Futterstücke
+    long avoided;                       // wegen einer Falle geänderte Pläne
+    long reach_incremental;             // Reach-Tracker: lokal erledigt
+    long reach_fills;                   // Reach-Tracker: Flood Fills
+};
+
+extern enum ResCodes runAutopilotBenchmark(long ticks, int rows, int cols,
+                                           struct autopilotBench* abench);
+
+#endif  // _AUTOPILOT_H
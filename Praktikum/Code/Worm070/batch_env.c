@@ -0,0 +1,390 @@
+// Worm070 - Aufgabenblatt 8
+// ============================================================================
+//  Modul: batch_env.c  –  Viele Headless-Spiele im Gleichschritt
+// ============================================================================
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "worm.h"
+#include "board_model.h"
+#include "worm_model.h"
+#include "render.h"
+#include "headless.h"
+#include "batch_env.h"
+#include "touchlog.h"
+#include "obs_encoder.h"
+#include "timing.h"
+
+// ============================================================================
+//  Hilfsfunktionen
+// ============================================================================
+
+// Setzt Spiel i auf das Startlevel zurück: resetLevel() schreibt nur die
+// im letzten Spiel geänderten Zellen aus dem Abbild zurück und setzt die
+// Zähler, dann wird der Wurm neu angelegt (Deque wird weiterverwendet).
+// Jede Episode jedes Spiels bekommt einen eigenen Futterstrom; die
+// Nummer hängt nur von i und der Episode dieses Spiels ab, nicht von n.
+static void resetEnv(struct batchEnv* aenv, int i)
+{
+    struct board* b = &aenv->boards[i];
+
+    resetLevel(b);
+    setFoodSeed(b, FOOD_SEED, (uint64_t)i << 32 | (uint32_t)aenv->env_games[i]);
+
+    initializeWorm(b,
+                   &aenv->worms[i],
+                   getNumberOfCells(b),
+                   WORM_INITIAL_LENGTH,
+                   aenv->start_pos,
+                   WORM_RIGHT,
+                   COLP_USER_WORM);
+
+    aenv->steps[i] = 0;
+    aenv->env_games[i]++;
+}
+
+// Schreibt die Beobachtung von Spiel i nach out (BATCH_OBS_SIZE Bytes).
+static void writeObservation(struct batchEnv* aenv, int i, uint8_t* out)
+{
+    struct board* b = &aenv->boards[i];
+    struct worm*  w = &aenv->worms[i];
+    const cell_t* head = b->cells + getWormHeadCell(w);
+
+    for (int dir = 0; dir < WORM_HEADINGS; dir++) {
+        out[dir] = head[b->dir_offset[dir]];
+    }
+    out[WORM_HEADINGS] = (uint8_t)w->heading;
+}
+
+// ============================================================================
+//  initializeBatchEnv / freeBatchEnv
+// ============================================================================
+// Vorgehen:
+//    - Startlevel einmal mit initializeLevel() aufbauen; dessen Zellen
+//      werden zum Abbild level_cells
+//    - Zellen aller Spiele in einem Block reservieren, jedes Board ist eine
+//      Kopie des Level-Boards mit eigenem Ausschnitt im Block
+//    - Abbild einmal in jeden Ausschnitt kopieren und je Board ein
+//      Änderungsprotokoll mit level_cells als gemeinsamem Abbild anhängen
+//    - alle Spiele zurücksetzen
+// ============================================================================
+
+enum ResCodes initializeBatchEnv(struct batchEnv* aenv,
+                                 int n, int rows, int cols,
+                                 int max_steps)
+{
+    struct board level = {0};
+
+    if (n <= 0) {
+        return RES_FAILED;
+    }
+
+    if (initializeLevel(&level, getNullRenderer(), rows, cols) != RES_OK) {
+        freeBoard(&level);
+        return RES_FAILED;
+    }
+
+    aenv->n         = n;
+    aenv->rows      = rows;
+    aenv->cols      = cols;
+    aenv->max_steps = max_steps;
+
+    aenv->cells_per_env = (long)(rows + 2 * BOARD_BORDER) * level.stride;
+    aenv->level_cells   = level.cells;          // Speicher übernehmen
+    aenv->level_food    = getNumberOfFoodItems(&level);
+    aenv->level_hash    = level.hash;
+    aenv->start_pos.y   = getLastRowOnBoard(&level);
+    aenv->start_pos.x   = 0;
+
+    aenv->total_steps = 0;
+    aenv->episodes    = 0;
+
+    // stride ist ein Vielfaches von BOARD_ALIGN, also beginnt jedes Board
+    // an einer Cache-Line
+    aenv->cell_slab = aligned_alloc(BOARD_ALIGN,
+                                    (size_t)n * aenv->cells_per_env * sizeof(cell_t));
+    aenv->boards = calloc(n, sizeof(struct board));
+    aenv->worms  = calloc(n, sizeof(struct worm));
+    aenv->steps  = calloc(n, sizeof(int));
+    aenv->env_games = calloc(n, sizeof(int));
+    aenv->logs   = calloc(n, sizeof(struct touchLog));
+    aenv->board_ptrs = malloc(n * sizeof(struct board*));
+    aenv->worm_ptrs  = malloc(n * sizeof(struct worm*));
+
+    if (aenv->cell_slab == NULL || aenv->boards == NULL ||
+        aenv->worms == NULL || aenv->steps == NULL || aenv->env_games == NULL ||
+        aenv->logs == NULL || aenv->board_ptrs == NULL ||
+        aenv->worm_ptrs == NULL) {
+        freeBatchEnv(aenv);
+        return RES_FAILED;
+    }
+
+    for (int i = 0; i < n; i++) {
+        aenv->boards[i] = level;
+        aenv->boards[i].cells    = aenv->cell_slab + i * aenv->cells_per_env;
+        aenv->boards[i].capacity = aenv->cells_per_env;
+        memcpy(aenv->boards[i].cells, aenv->level_cells,
+               aenv->cells_per_env * sizeof(cell_t));
+        aenv->board_ptrs[i] = &aenv->boards[i];
+        aenv->worm_ptrs[i]  = &aenv->worms[i];
+        if (attachTouchLog(&aenv->boards[i], &aenv->logs[i],
+                           aenv->level_cells) != RES_OK) {
+            freeBatchEnv(aenv);
+            return RES_FAILED;
+        }
+    }
+
+    resetBatchEnv(aenv, NULL);
+
+    // Die Würmer konnten keinen Speicher bekommen
+    for (int i = 0; i < n; i++) {
+        if (aenv->worms[i].wormcells == NULL) {
+            freeBatchEnv(aenv);
+            return RES_FAILED;
+        }
+    }
+    return RES_OK;
+}
+
+void freeBatchEnv(struct batchEnv* aenv)
+{
+    if (aenv->worms != NULL) {
+        for (int i = 0; i < aenv->n; i++) {
+            freeWorm(&aenv->worms[i]);
+        }
+    }
+
+    // Die Zellen der Boards liegen in cell_slab, daher kein freeBoard();
+    // nur die Mengen der freien Zellen gehören dem einzelnen Board
+    if (aenv->boards != NULL) {
+        for (int i = 0; i < aenv->n; i++) {
+            freeFreeCells(&aenv->boards[i]);
+        }
+    }
+    if (aenv->logs != NULL) {
+        for (int i = 0; i < aenv->n; i++) {
+            freeTouchLog(&aenv->logs[i]);
+        }
+    }
+    free(aenv->cell_slab);
+    free(aenv->level_cells);
+    free(aenv->boards);
+    free(aenv->worms);
+    free(aenv->steps);
+    free(aenv->env_games);
+    free(aenv->logs);
+    free(aenv->board_ptrs);
+    free(aenv->worm_ptrs);
+
+    aenv->cell_slab   = NULL;
+    aenv->level_cells = NULL;
+    aenv->boards      = NULL;
+    aenv->worms       = NULL;
+    aenv->steps       = NULL;
+    aenv->env_games   = NULL;
+    aenv->logs        = NULL;
+    aenv->board_ptrs  = NULL;
+    aenv->worm_ptrs   = NULL;
+    aenv->n           = 0;
+}
+
+// ============================================================================
+//  resetBatchEnv / stepBatchEnv
+// ============================================================================
+
+void resetBatchEnv(struct batchEnv* aenv, uint8_t* obs)
+{
+    for (int i = 0; i < aenv->n; i++) {
+        resetEnv(aenv, i);
+        if (obs != NULL) {
+            writeObservation(aenv, i, obs + i * BATCH_OBS_SIZE);
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------
+//  stepBatchEnv
+// ----------------------------------------------------------------------------
+// Ablauf pro Spiel:
+//    - Aktion übernehmen (gültige Richtung) oder Richtung beibehalten
+//    - cleanWormTail() + moveWorm() wie im Terminal
+//    - Belohnung: Futter am gesunkenen Futterzähler erkennen, Spielende
+//      am Spielzustand
+//    - Ende auch, wenn alles Futter gefressen oder max_steps erreicht ist
+//    - beendetes Spiel sofort zurücksetzen, dann Beobachtung schreiben
+// ----------------------------------------------------------------------------
+void stepBatchEnv(struct batchEnv* aenv,
+                  const int8_t* actions,
+                  float* rewards,
+                  uint8_t* dones,
+                  uint8_t* obs)
+{
+    for (int i = 0; i < aenv->n; i++) {
+        struct board* b = &aenv->boards[i];
+        struct worm*  w = &aenv->worms[i];
+        enum GameStates game_state = WORM_GAME_ONGOING;
+        long food_before = b->food_eaten;
+        float reward = 0.0f;
+        bool done = false;
+
+        if (actions[i] >= 0 && actions[i] < WORM_HEADINGS) {
+            setWormHeading(w, (enum WormHeading)actions[i]);
+        }
+
+        cleanWormTail(b, w);
+        moveWorm(b, w, &game_state);
+        aenv->steps[i]++;
+
+        if (game_state != WORM_GAME_ONGOING) {
+            reward = BATCH_REWARD_DEATH;
+            done = true;
+        } else {
+            if (b->food_eaten > food_before) {
+                reward = BATCH_REWARD_FOOD;
+            }
+            if (b->food_items == 0 ||
+                (aenv->max_steps > 0 && aenv->steps[i] >= aenv->max_steps)) {
+                done = true;
+            }
+        }
+
+        rewards[i] = reward;
+        dones[i]   = done;
+
+        if (done) {
+            resetEnv(aenv, i);
+            aenv->episodes++;
+        }
+
+        writeObservation(aenv, i, obs + i * BATCH_OBS_SIZE);
+    }
+
+    aenv->total_steps += aenv->n;
+}
+
+// ============================================================================
+//  Beobachtung als Ebenen
+// ============================================================================
+// Alle Boards einer Batch-Umgebung sind gleich groß, encodeBoards*() kann
+// also nur am Radius scheitern.
+// ============================================================================
+
+long batchPlaneElements(struct batchEnv* aenv, int radius)
+{
+    return radius == BATCH_PLANES_FULL
+         ? (long)OBS_PLANE_COUNT * aenv->rows * aenv->cols
+         : obsCropElements(radius);
+}
+
+enum ResCodes encodeBatchEnvU8(struct batchEnv* aenv, int radius,
+                               uint8_t* out)
+{
+    return radius == BATCH_PLANES_FULL
+         ? encodeBoardsU8(aenv->board_ptrs, aenv->worm_ptrs, aenv->n, out)
+         : encodeCropsU8(aenv->board_ptrs, aenv->worm_ptrs, aenv->n,
+                         radius, out);
+}
+
+enum ResCodes encodeBatchEnvF32(struct batchEnv* aenv, int radius,
+                                float* out)
+{
+    return radius == BATCH_PLANES_FULL
+         ? encodeBoardsF32(aenv->board_ptrs, aenv->worm_ptrs, aenv->n, out)
+         : encodeCropsF32(aenv->board_ptrs, aenv->worm_ptrs, aenv->n,
+                          radius, out);
+}
+
+// ============================================================================
+//  runBatchHeadless
+// ============================================================================
+// Ausweichsteuerung nur aus der Beobachtung: Richtung beibehalten, solange
+// die Zielzelle betretbar ist, sonst die erste betretbare der acht
+// Richtungen.
+// ============================================================================
+
+static bool obsPassable(uint8_t code)
+{
+    return code != BC_BARRIER && code != BC_USED_BY_WORM;
+}
+
+static int8_t chooseAction(const uint8_t* obs)
+{
+    if (obsPassable(obs[obs[WORM_HEADINGS]])) {
+        return BATCH_ACTION_KEEP;
+    }
+    for (int dir = 0; dir < WORM_HEADINGS; dir++) {
+        if (obsPassable(obs[dir])) {
+            return (int8_t)dir;
+        }
+    }
+    return BATCH_ACTION_KEEP;
+}
+
+enum ResCodes runBatchHeadless(long ticks, long game_ticks,
+                               int n, int rows, int cols,
+                               int planes, bool planes_f32,
+                               struct headlessStats* astats)
+{
+    struct batchEnv env = {0};
+    struct timespec start, end;
+    long long step_ns = 0, encode_ns = 0;
+    void* plane_buf = NULL;
+    enum ResCodes res = RES_FAILED;
+
+    int8_t*  actions = malloc(sizeof(int8_t) * n);
+    float*   rewards = malloc(sizeof(float) * n);
+    uint8_t* dones   = malloc(sizeof(uint8_t) * n);
+    uint8_t* obs     = malloc(sizeof(uint8_t) * n * BATCH_OBS_SIZE);
+
+    if (actions != NULL && rewards != NULL && dones != NULL && obs != NULL &&
+        initializeBatchEnv(&env, n, rows, cols, (int)game_ticks) == RES_OK) {
+
+        if (planes != BATCH_PLANES_NONE) {
+            size_t elem = planes_f32 ? sizeof(float) : sizeof(uint8_t);
+            plane_buf = malloc((size_t)n * batchPlaneElements(&env, planes) * elem);
+        }
+
+        res = planes == BATCH_PLANES_NONE || plane_buf != NULL ? RES_OK
+                                                               : RES_FAILED;
+        resetBatchEnv(&env, obs);
+        clock_gettime(CLOCK_MONOTONIC, &start);
+
+        for (long t = 0; res == RES_OK && t < ticks; t++) {
+            for (int i = 0; i < n; i++) {
+                actions[i] = chooseAction(obs + i * BATCH_OBS_SIZE);
+            }
+
+            long long t0 = monotonicNowNs();
+            stepBatchEnv(&env, actions, rewards, dones, obs);
+            long long t1 = monotonicNowNs();
+            step_ns += t1 - t0;
+
+            if (plane_buf != NULL) {
+                res = planes_f32 ? encodeBatchEnvF32(&env, planes, plane_buf)
+                                 : encodeBatchEnvU8(&env, planes, plane_buf);
+                encode_ns += monotonicNowNs() - t1;
+            }
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        astats->ticks   = env.total_steps;
+        astats->games   = env.episodes;
+        astats->start_seconds  = 0.0;
+        astats->step_seconds   = step_ns * 1e-9;
+        astats->encode_seconds = encode_ns * 1e-9;
+        astats->hash_checks    = 0;
+        astats->seconds = (end.tv_sec - start.tv_sec)
+                        + (end.tv_nsec - start.tv_nsec) * 1e-9;
+    }
+
+    freeBatchEnv(&env);
+    free(plane_buf);
+    free(actions);
+    free(rewards);
+    free(dones);
+    free(obs);
+    return res;
+}
@@ -0,0 +1,166 @@
+// Worm070 - Aufgabenblatt 8
+// ============================================================================
+//  batch_env.h – Viele Headless-Spiele im Gleichschritt (Batch-Umgebung)
+//
+//  Für das Training von Steuerungen laufen tausende Spiele parallel. Einzeln
+//  über doLevel() oder runHeadless() kostet das vor allem Aufruf-Overhead
+//  und Cache-Misses. Die Batch-Umgebung hält deshalb N unabhängige Boards
+//  und Würmer nebeneinander:
+//
+//    - die Zellen aller Boards liegen in einem zusammenhängenden Block
+//      (cell_slab), Board i ab cell_slab + i * cells_per_env
+//    - Boards und Würmer liegen je in einem Array von struct board bzw.
+//      struct worm (array of structures); nur die Zähler der Umgebung
+//      (steps, env_games) sind parallele Arrays. Eine echte Aufteilung in
+//      parallele Arrays je Feld (Kopfzelle, Richtung, Deque-Zähler, ...)
+//      bräuchte eine zweite Fassung der Spielregeln neben cleanWormTail()
+//      und moveWorm() samt Hashwerten, Menge der freien Zellen und
+//      Änderungsprotokoll. Stattdessen liegen die Felder, die ein Schritt
+//      liest, in struct board vorne beisammen (die Dirty-Liste am Ende),
+//      so dass ein Schritt je Spiel nur wenige Cache-Lines der Struktur
+//      berührt. Bei sehr vielen Spielen dominieren ohnehin die Zugriffe
+//      auf cell_slab.
+//    - stepBatchEnv() führt für alle N Spiele genau einen Schritt aus und
+//      schreibt Belohnung, Ende-Flag und Beobachtung in die Puffer des
+//      Aufrufers; beendete Spiele starten sofort neu
+//    - ein Neustart schreibt nur die im letzten Spiel geänderten Zellen aus
+//      dem gespeicherten Startlevel zurück (resetLevel(), touchlog.h),
+//      statt initializeLevel() Zelle für Zelle durchlaufen zu lassen
+//
+//    - encodeBatchEnvU8/F32() kodieren alle Spiele zusätzlich als
+//      One-Hot-Ebenen (obs_encoder.h), ganzes Spielfeld oder Ausschnitt
+//      um den Kopf
+//
+//  Die Spiellogik ist dieselbe wie im Terminal: cleanWormTail() und
+//  moveWorm() aus worm_model.c.
+// ============================================================================
+
+#ifndef _BATCH_ENV_H
+#define _BATCH_ENV_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "worm.h"
+#include "board_model.h"
+#include "worm_model.h"
+#include "headless.h"
+
+struct touchLog;   // siehe touchlog.h
+
+// ---------------------------------------------------------------------------
+//  Beobachtung, Aktion, Belohnung
+// ---------------------------------------------------------------------------
+//
+//  Beobachtung (BATCH_OBS_SIZE Bytes pro Spiel):
+//    obs[0 .. WORM_HEADINGS-1]  BoardCode der acht Nachbarzellen des Kopfes,
+//                               Reihenfolge wie enum WormHeading
+//    obs[WORM_HEADINGS]         aktuelle Richtung (enum WormHeading)
+//
+//  Aktion (ein int8_t pro Spiel):
+//    0 .. WORM_HEADINGS-1       neue Richtung (enum WormHeading)
+//    BATCH_ACTION_KEEP          Richtung beibehalten (jeder andere Wert auch)
+//
+//  Belohnung pro Schritt:
+//    BATCH_REWARD_FOOD          Futter gefressen
+//    BATCH_REWARD_DEATH         Crash, Rand oder Selbstkollision
+//    sonst 0
+// ---------------------------------------------------------------------------
+
+#define BATCH_OBS_SIZE     (WORM_HEADINGS + 1)
+#define BATCH_ACTION_KEEP  (-1)
+#define BATCH_REWARD_FOOD  1.0f
+#define BATCH_REWARD_DEATH (-1.0f)
+
+// ---------------------------------------------------------------------------
+//  Beobachtung als Ebenen (obs_encoder.h)
+// ---------------------------------------------------------------------------
+//  radius > 0                 Ausschnitt mit diesem Radius um den Kopf
+//  BATCH_PLANES_FULL          ganzes Spielfeld
+//  BATCH_PLANES_NONE          keine Ebenen (nur für runBatchHeadless())
+// ---------------------------------------------------------------------------
+
+#define BATCH_PLANES_NONE  (-1)
+#define BATCH_PLANES_FULL  0
+
+// ---------------------------------------------------------------------------
+//  struct batchEnv
+// ---------------------------------------------------------------------------
+struct batchEnv {
+    int n;                   // Anzahl der Spiele
+    int rows;                // Spielfeldgröße (für alle Spiele gleich)
+    int cols;
+    int max_steps;           // Schritte pro Spiel bis zum Abbruch, 0 = unbegrenzt
+
+    cell_t* cell_slab;       // Zellen aller Boards, n * cells_per_env
+    long cells_per_env;      // Zellen pro Board inklusive Rand und Auffüllung
+
+    cell_t* level_cells;     // Abbild des Startlevels (cells_per_env Zellen)
+    int level_food;          // Futter im Startlevel
+    uint64_t level_hash;     // Zobrist-Hashwert des Startlevels
+    struct pos start_pos;    // Startposition des Kopfes
+
+    struct board* boards;    // n Boards, cells zeigen in cell_slab
+    struct worm* worms;      // n Würmer
+    struct touchLog* logs;   // n Änderungsprotokolle, Abbild level_cells
+    struct board** board_ptrs; // &boards[i] bzw. &worms[i] für obs_encoder.h
+    struct worm** worm_ptrs;
+
+    int* steps;              // Schritte im laufenden Spiel, pro Spiel
+    int* env_games;          // begonnene Spiele pro Spiel (Futterstrom, rng.h)
+
+    long total_steps;        // Schritte aller Spiele seit initializeBatchEnv()
+    long episodes;           // beendete Spiele
+};
+
+// Legt n Spiele der Größe rows x cols mit dem Startlevel aus
+// initializeLevel() an (Null-Renderer). max_steps > 0 beendet ein Spiel
+// nach so vielen Schritten. Vor dem ersten Aufruf mit Nullen
+// initialisieren; Freigabe mit freeBatchEnv().
+// Liefert RES_FAILED bei ungültiger Größe oder fehlendem Speicher.
+extern enum ResCodes initializeBatchEnv(struct batchEnv* aenv,
+                                        int n, int rows, int cols,
+                                        int max_steps);
+
+// Gibt den Speicher der Batch-Umgebung frei.
+extern void freeBatchEnv(struct batchEnv* aenv);
+
+// Setzt alle Spiele auf das Startlevel zurück und schreibt die ersten
+// Beobachtungen nach obs (n * BATCH_OBS_SIZE Bytes, darf NULL sein).
+extern void resetBatchEnv(struct batchEnv* aenv, uint8_t* obs);
+
+// Führt für jedes Spiel i die Aktion actions[i] und einen Spielschritt aus.
+// Schreibt rewards[i], dones[i] (1 = Spiel in diesem Schritt beendet) und
+// die Beobachtung nach obs + i * BATCH_OBS_SIZE. Beendete Spiele werden
+// sofort neu gestartet; ihre Beobachtung gehört dann schon zum neuen Spiel.
+// actions, rewards, dones und obs haben je n Einträge (obs n * BATCH_OBS_SIZE).
+extern void stepBatchEnv(struct batchEnv* aenv,
+                         const int8_t* actions,
+                         float* rewards,
+                         uint8_t* dones,
+                         uint8_t* obs);
+
+// Anzahl der Elemente pro Spiel, die encodeBatchEnvU8/F32() mit radius
+// schreiben.
+extern long batchPlaneElements(struct batchEnv* aenv, int radius);
+
+// Kodiert alle n Spiele als Ebenen nach out (n * batchPlaneElements()
+// Elemente, Layout siehe obs_encoder.h). Liefert RES_FAILED bei einem
+// Radius über OBS_MAX_CROP_RADIUS.
+extern enum ResCodes encodeBatchEnvU8(struct batchEnv* aenv, int radius,
+                                      uint8_t* out);
+extern enum ResCodes encodeBatchEnvF32(struct batchEnv* aenv, int radius,
+                                       float* out);
+
+// Benchmark: ticks Batch-Schritte mit n Spielen und einer einfachen
+// Ausweichsteuerung, die nur die Beobachtungen auswertet. game_ticks wird
+// zu max_steps (0 = unbegrenzt). astats->ticks zählt Spielschritte aller
+// Spiele (ticks * n). Mit planes != BATCH_PLANES_NONE werden nach jedem
+// Schritt alle Spiele zusätzlich als Ebenen kodiert (planes_f32: float
+// statt uint8_t); astats->step_seconds und astats->encode_seconds trennen
+// die Zeit für Schritt und Kodierung.
+extern enum ResCodes runBatchHeadless(long ticks, long game_ticks,
+                                      int n, int rows, int cols,
+                                      int planes, bool planes_f32,
+                                      struct headlessStats* astats);
+
+#endif  // _BATCH_ENV_H
@@ -0,0 +1,299 @@
+// Worm070 - Aufgabenblatt 8
+// ============================================================================
+//  Modul: bitboard.c  –  Spielfeld als Bitebenen mit wortweisen Abfragen
+// ============================================================================
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "worm.h"
+#include "board_model.h"
+#include "bitboard.h"
+
+// Wortgröße der Zeilen und Ausrichtung des Speichers (eine Cache-Line)
+#define BITS_PER_WORD  64
+#define BITBOARD_ALIGN 64
+
+// ============================================================================
+//  Hilfsfunktionen
+// ============================================================================
+
+// Reserviert words Wörter, auf eine Cache-Line ausgerichtet und genullt.
+static uint64_t* allocWords(long words)
+{
+    size_t bytes = (size_t)words * sizeof(uint64_t);
+    bytes = (bytes + BITBOARD_ALIGN - 1) / BITBOARD_ALIGN * BITBOARD_ALIGN;
+
+    uint64_t* p = aligned_alloc(BITBOARD_ALIGN, bytes);
+    if (p != NULL) {
+        memset(p, 0, bytes);
+    }
+    return p;
+}
+
+// Maske der Bits x0..x1 (Bitposition in der Zeile, also Spalte + Rand)
+// innerhalb von Wort w.
+static inline uint64_t spanMask(int w, int x0, int x1)
+{
+    int lo = w * BITS_PER_WORD;
+    int hi = lo + BITS_PER_WORD - 1;
+
+    if (x1 < lo || x0 > hi) {
+        return 0;
+    }
+
+    int from = (x0 > lo ? x0 : lo) - lo;
+    int to   = (x1 < hi ? x1 : hi) - lo;
+    uint64_t upto = (to == BITS_PER_WORD - 1) ? ~(uint64_t)0
+                                              : (((uint64_t)1 << (to + 1)) - 1);
+    return upto & ~(((uint64_t)1 << from) - 1);
+}
+
+// Alle belegten Zellen (irgendeine Ebene) in Wort w von Zeile y.
+static inline uint64_t occupiedWord(struct bitboard* abits, int y, int w)
+{
+    uint64_t occ = 0;
+    for (int p = 0; p < BP_COUNT; p++) {
+        occ |= bitboardRow(abits, p, y)[w];
+    }
+    return occ;
+}
+
+// ============================================================================
+//  Verwaltung
+// ============================================================================
+
+enum ResCodes initializeBitboard(struct bitboard* abits, int rows, int cols)
+{
+    abits->rows = rows;
+    abits->cols = cols;
+    abits->plane_rows = rows + 2 * BOARD_BORDER;
+    abits->words_per_row = strideForCols(cols) / BITS_PER_WORD;
+
+    long plane_words = (long)abits->plane_rows * abits->words_per_row;
+
+    abits->planes  = allocWords(BP_COUNT * plane_words);
+    abits->scratch = allocWords(2 * plane_words + 2 * abits->words_per_row);
+
+    if (abits->planes == NULL || abits->scratch == NULL) {
+        freeBitboard(abits);
+        return RES_FAILED;
+    }
+    return RES_OK;
+}
+
+void freeBitboard(struct bitboard* abits)
+{
+    free(abits->planes);
+    free(abits->scratch);
+    abits->planes  = NULL;
+    abits->scratch = NULL;
+}
+
+void loadBitboardFromBoard(struct bitboard* abits, struct board* aboard)
+{
+    memset(abits->planes, 0,
+           sizeof(uint64_t) * BP_COUNT * bitboardPlaneWords(abits));
+
+    // Gleiches Layout (siehe attachBitboard()): Zellnummer == Bitnummer,
+    // Rand und Auffüllung landen als Barriere in BP_BARRIER
+    long cells = (long)bitboardPlaneWords(abits) * BITS_PER_WORD;
+    for (long idx = 0; idx < cells; idx++) {
+        updateBitboardIndex(abits, (cellidx_t)idx, BC_FREE_CELL,
+                            getContentAtIndex(aboard, (cellidx_t)idx));
+    }
+}
+
+enum ResCodes attachBitboard(struct board* aboard, struct bitboard* abits)
+{
+    if (abits != NULL) {
+        // Zellnummer == Bitnummer setzt gleiche Zeilenlänge voraus
+        if (abits->rows != aboard->last_row + 1 ||
+            abits->words_per_row * BITS_PER_WORD != aboard->stride) {
+            return RES_FAILED;
+        }
+        loadBitboardFromBoard(abits, aboard);
+    }
+    aboard->bits = abits;
+    return RES_OK;
+}
+
+int bitboardPlaneWords(struct bitboard* abits)
+{
+    return abits->plane_rows * abits->words_per_row;
+}
+
+// ============================================================================
+//  Abfragen
+// ============================================================================
+
+int countFreeCells(struct bitboard* abits)
+{
+    int count = 0;
+
+    // Rand und Auffüllung sind Barrieren und zählen daher nicht mit
+    for (int y = 0; y < abits->rows; y++) {
+        for (int w = 0; w < abits->words_per_row; w++) {
+            count += __builtin_popcountll(~occupiedWord(abits, y, w));
+        }
+    }
+    return count;
+}
+
+bool findAnyFood(struct bitboard* abits,
+                 struct pos* apos,
+                 enum BoardCodes* acode)
+{
+    int words = bitboardPlaneWords(abits);
+    uint64_t* f1 = bitboardRow(abits, BP_FOOD_1, -BOARD_BORDER);
+    uint64_t* f2 = bitboardRow(abits, BP_FOOD_2, -BOARD_BORDER);
+    uint64_t* f3 = bitboardRow(abits, BP_FOOD_3, -BOARD_BORDER);
+
+    for (int i = 0; i < words; i++) {
+        uint64_t any = f1[i] | f2[i] | f3[i];
+        if (any == 0) {
+            continue;
+        }
+
+        int bit = __builtin_ctzll(any);
+        apos->y = i / abits->words_per_row - BOARD_BORDER;
+        apos->x = (i % abits->words_per_row) * BITS_PER_WORD + bit - BOARD_BORDER;
+
+        uint64_t m = (uint64_t)1 << bit;
+        *acode = (f1[i] & m) ? BC_FOOD_1 : (f2[i] & m) ? BC_FOOD_2 : BC_FOOD_3;
+        return true;
+    }
+    return false;
+}
+
+bool isRowSpanFree(struct bitboard* abits, int y, int x0, int x1)
+{
+    if (y < 0 || y >= abits->rows || x0 < 0 || x1 >= abits->cols || x0 > x1) {
+        return false;
+    }
+
+    x0 += BOARD_BORDER;
+    x1 += BOARD_BORDER;
+
+    for (int w = x0 / BITS_PER_WORD; w <= x1 / BITS_PER_WORD; w++) {
+        if (occupiedWord(abits, y, w) & spanMask(w, x0, x1)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool isRectFree(struct bitboard* abits, int y0, int x0, int y1, int x1)
+{
+    if (y0 < 0 || y1 >= abits->rows || y0 > y1) {
+        return false;
+    }
+
+    for (int y = y0; y <= y1; y++) {
+        if (!isRowSpanFree(abits, y, x0, x1)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+//  Flood Fill
+// ----------------------------------------------------------------------------
+// Vorgehen:
+//    reach enthält die bisher erreichten Zellen. Eine Zeile wird "entspannt",
+//    indem die erreichten Bits der Nachbarzeilen und der Zeile selbst
+//    ODER-verknüpft, um eine Spalte nach links und rechts verbreitert und mit
+//    den betretbaren Zellen maskiert werden (8er-Nachbarschaft). Innerhalb
+//    der Zeile wird das wiederholt, bis sich nichts mehr ändert.
+//    Abwechselnde Durchläufe von oben nach unten und zurück lassen die Füllung
+//    in beide Richtungen in einem Durchlauf weit vordringen.
+//    Der Barrierenrand ist nie betretbar; die Nachbarzeilen jeder
+//    Spielfeldzeile existieren daher immer und brauchen keine Sonderfälle.
+// ----------------------------------------------------------------------------
+
+// out = in, um eine Spalte nach links und rechts verbreitert
+static inline void dilateRow(const uint64_t* in, uint64_t* out, int wpr)
+{
+    for (int w = 0; w < wpr; w++) {
+        uint64_t up   = (in[w] << 1) | (w > 0 ? in[w - 1] >> 63 : 0);
+        uint64_t down = (in[w] >> 1) | (w + 1 < wpr ? in[w + 1] << 63 : 0);
+        out[w] = in[w] | up | down;
+    }
+}
+
+static bool relaxRow(struct bitboard* abits,
+                     uint64_t* reach, const uint64_t* passable,
+                     uint64_t* row, uint64_t* tmp, int y)
+{
+    int wpr = abits->words_per_row;
+    uint64_t* r = reach + (long)(y + BOARD_BORDER) * wpr;
+    const uint64_t* pass = passable + (long)(y + BOARD_BORDER) * wpr;
+    bool changed = false;
+
+    for (int w = 0; w < wpr; w++) {
+        row[w] = r[w - wpr] | r[w] | r[w + wpr];
+    }
+
+    for (;;) {
+        bool grown = false;
+        dilateRow(row, tmp, wpr);
+        for (int w = 0; w < wpr; w++) {
+            uint64_t next = (tmp[w] & pass[w]) | r[w];
+            if (next != r[w]) {
+                r[w] = next;
+                grown = true;
+                changed = true;
+            }
+            row[w] = r[w];
+        }
+        if (!grown) {
+            break;
+        }
+    }
+    return changed;
+}
+
+int floodFillFromPos(struct bitboard* abits, struct pos start, uint64_t* out)
+{
+    int words = bitboardPlaneWords(abits);
+    int wpr = abits->words_per_row;
+    uint64_t* passable = abits->scratch;
+    uint64_t* reach = out != NULL ? out : abits->scratch + words;
+    uint64_t* row = abits->scratch + 2L * words;
+    uint64_t* tmp = row + wpr;
+
+    // Betretbar: frei oder Futter, also weder Wurm noch Barriere
+    uint64_t* worm = bitboardRow(abits, BP_WORM, -BOARD_BORDER);
+    uint64_t* barrier = bitboardRow(abits, BP_BARRIER, -BOARD_BORDER);
+    for (int i = 0; i < words; i++) {
+        passable[i] = ~(worm[i] | barrier[i]);
+        reach[i] = 0;
+    }
+
+    if (start.y < 0 || start.y >= abits->rows ||
+        start.x < 0 || start.x >= abits->cols) {
+        return 0;
+    }
+    long start_bit = (long)(start.y + BOARD_BORDER) * wpr * BITS_PER_WORD
+                   + start.x + BOARD_BORDER;
+    reach[start_bit / BITS_PER_WORD] |= (uint64_t)1 << (start_bit % BITS_PER_WORD);
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (int y = 0; y < abits->rows; y++) {
+            changed |= relaxRow(abits, reach, passable, row, tmp, y);
+        }
+        for (int y = abits->rows - 1; y >= 0; y--) {
+            changed |= relaxRow(abits, reach, passable, row, tmp, y);
+        }
+    }
+
+    int count = 0;
+    for (int i = 0; i < words; i++) {
+        reach[i] &= passable[i];
+        count += __builtin_popcountll(reach[i]);
+    }
+    return count;
+}
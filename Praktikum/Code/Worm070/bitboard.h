@@ -0,0 +1,203 @@
+// Worm070 - Aufgabenblatt 8
+// ============================================================================
+//  bitboard.h – Spielfeld als Bitebenen (Bitboard)
+//
+//  Idee:
+//    Statt eines Bytes pro Zelle gibt es für jeden BoardCode außer
+//    BC_FREE_CELL eine eigene Bitebene. Jede Zeile einer Ebene besteht aus
+//    64-Bit-Wörtern, ein Bit pro Spalte. Die Ebenen haben dasselbe Layout
+//    wie board.cells, also inklusive Barrierenrand und Zeilenauffüllung
+//    (siehe board_model.h); Rand und Auffüllung stehen in BP_BARRIER.
+//    Ein 26x70-Spielfeld braucht damit pro Ebene nur 28 * 2 Wörter
+//    (448 Byte), alle Ebenen zusammen passen bequem in den L1-Cache.
+//
+//    Abfragen über viele Zellen (freie Zellen zählen, Futter suchen, Zeilen
+//    oder Rechtecke prüfen, Flood Fill) arbeiten wortweise mit Popcount,
+//    Bitmasken und Shifts, also 64 Zellen pro Operation. Die Wortschleifen
+//    sind so geschrieben, dass der Compiler sie vektorisieren kann.
+//
+//  Verwendung:
+//    Das Bitboard ist eine zusätzliche Darstellung neben board.cells.
+//    Mit attachBitboard() wird es an ein Board gehängt; ab dann halten
+//    placeItem() und setContentAt() beide Darstellungen synchron.
+// ============================================================================
+
+#ifndef _BITBOARD_H
+#define _BITBOARD_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "worm.h"
+#include "board_model.h"
+
+// ============================================================================
+//  Bitebenen
+// ============================================================================
+//
+//  BC_FREE_CELL hat keine eigene Ebene: frei ist, wo in keiner Ebene ein
+//  Bit gesetzt ist.
+// ============================================================================
+
+enum BitPlanes {
+    BP_WORM,      // BC_USED_BY_WORM
+    BP_FOOD_1,    // BC_FOOD_1
+    BP_FOOD_2,    // BC_FOOD_2
+    BP_FOOD_3,    // BC_FOOD_3
+    BP_BARRIER,   // BC_BARRIER
+    BP_COUNT
+};
+
+// ============================================================================
+//  struct bitboard
+// ============================================================================
+//
+//  rows / cols:
+//    Anzahl der Zeilen und Spalten des Spielfelds (ohne Rand).
+//
+//  plane_rows:
+//    Zeilen einer Ebene inklusive Rand (rows + 2 * BOARD_BORDER).
+//
+//  words_per_row:
+//    Anzahl der 64-Bit-Wörter pro Zeile einer Ebene (strideForCols() / 64).
+//
+//  planes:
+//    BP_COUNT Ebenen direkt hintereinander, jede plane_rows * words_per_row
+//    Wörter. Bit i einer Ebene gehört zur Zelle mit Zellnummer i
+//    (cellidx_t), Spalte x einer Zeile also zu Bit x + BOARD_BORDER.
+//    Jedes Bit ist eine Zelle; es gibt keine ungültigen Bits am Zeilenende.
+//
+//  scratch:
+//    Arbeitsspeicher für den Flood Fill (zwei Ebenen und zwei Zeilen),
+//    einmalig angelegt, damit Abfragen ohne malloc auskommen.
+// ============================================================================
+
+struct bitboard {
+    int rows;
+    int cols;
+    int plane_rows;
+    int words_per_row;
+    uint64_t* planes;
+    uint64_t* scratch;
+};
+
+// Liefert die Ebene zu einem BoardCode, BP_COUNT für BC_FREE_CELL.
+static inline enum BitPlanes planeOfCode(enum BoardCodes code)
+{
+    switch (code) {
+        case BC_USED_BY_WORM: return BP_WORM;
+        case BC_FOOD_1:       return BP_FOOD_1;
+        case BC_FOOD_2:       return BP_FOOD_2;
+        case BC_FOOD_3:       return BP_FOOD_3;
+        case BC_BARRIER:      return BP_BARRIER;
+        default:              return BP_COUNT;
+    }
+}
+
+// Zeiger auf Zeile y der Ebene plane (Spielfeldzeile; -1 und rows sind
+// die Randzeilen).
+static inline uint64_t* bitboardRow(struct bitboard* abits,
+                                    enum BitPlanes plane, int y)
+{
+    return abits->planes
+         + ((long)plane * abits->plane_rows + y + BOARD_BORDER) * abits->words_per_row;
+}
+
+// Ändert die Zelle mit Zellnummer idx (siehe cellidx_t) von old_code auf
+// new_code. Da board.stride ein Vielfaches von 64 ist und ein Bitboard
+// gleicher Größe genau stride / 64 Wörter pro Zeile hat, ist die Zellnummer
+// zugleich die Bitnummer innerhalb einer Ebene.
+static inline void updateBitboardIndex(struct bitboard* abits,
+                                       cellidx_t idx,
+                                       enum BoardCodes old_code,
+                                       enum BoardCodes new_code)
+{
+    uint64_t bit = (uint64_t)1 << (idx & 63);
+    long w = (long)(idx >> 6);
+    long plane_words = (long)abits->plane_rows * abits->words_per_row;
+    enum BitPlanes p;
+
+    if ((p = planeOfCode(old_code)) != BP_COUNT) {
+        abits->planes[p * plane_words + w] &= ~bit;
+    }
+    if ((p = planeOfCode(new_code)) != BP_COUNT) {
+        abits->planes[p * plane_words + w] |= bit;
+    }
+}
+
+// Ändert die Zelle (y, x) von old_code auf new_code (zwei Bitoperationen).
+static inline void updateBitboardCell(struct bitboard* abits,
+                                      int y, int x,
+                                      enum BoardCodes old_code,
+                                      enum BoardCodes new_code)
+{
+    int col = x + BOARD_BORDER;
+    uint64_t bit = (uint64_t)1 << (col & 63);
+    int w = col >> 6;
+    enum BitPlanes p;
+
+    if ((p = planeOfCode(old_code)) != BP_COUNT) {
+        bitboardRow(abits, p, y)[w] &= ~bit;
+    }
+    if ((p = planeOfCode(new_code)) != BP_COUNT) {
+        bitboardRow(abits, p, y)[w] |= bit;
+    }
+}
+
+// ============================================================================
+//  Verwaltung
+// ============================================================================
+
+// Legt ein leeres Bitboard für rows x cols Zellen an (alle Zellen frei,
+// auch der Rand; er wird erst mit loadBitboardFromBoard() gefüllt).
+// Liefert RES_FAILED, wenn kein Speicher verfügbar ist.
+extern enum ResCodes initializeBitboard(struct bitboard* abits,
+                                        int rows, int cols);
+
+// Gibt den Speicher des Bitboards frei.
+extern void freeBitboard(struct bitboard* abits);
+
+// Überträgt den kompletten Inhalt von aboard->cells (inklusive Rand) in das
+// Bitboard.
+extern void loadBitboardFromBoard(struct bitboard* abits, struct board* aboard);
+
+// Hängt das Bitboard an das Board (lädt es vorher). NULL hängt es ab.
+// Aufruf nach initializeLevel(), da initializeBoard() die Verbindung löst.
+// Das Bitboard muss mit derselben Größe wie das Board angelegt sein
+// (sonst RES_FAILED).
+extern enum ResCodes attachBitboard(struct board* aboard, struct bitboard* abits);
+
+// Anzahl der Wörter einer Ebene (inklusive Rand); so groß muss ein
+// Ausgabepuffer für floodFillFromPos() sein.
+extern int bitboardPlaneWords(struct bitboard* abits);
+
+// ============================================================================
+//  Abfragen
+// ============================================================================
+
+// Anzahl der freien Zellen (BC_FREE_CELL) auf dem ganzen Board.
+extern int countFreeCells(struct bitboard* abits);
+
+// Sucht irgendein Futter. Liefert true und Position/Code, wenn es eines gibt.
+extern bool findAnyFood(struct bitboard* abits,
+                        struct pos* apos,
+                        enum BoardCodes* acode);
+
+// true, wenn die Zellen x0..x1 (einschließlich) in Zeile y alle frei sind.
+extern bool isRowSpanFree(struct bitboard* abits, int y, int x0, int x1);
+
+// true, wenn das Rechteck (y0,x0)..(y1,x1) (einschließlich) komplett frei ist.
+extern bool isRectFree(struct bitboard* abits,
+                       int y0, int x0, int y1, int x1);
+
+// Flood Fill in 8 Richtungen (wie die Bewegung des Wurms) über alle
+// betretbaren Zellen (frei oder Futter), ausgehend von start.
+// start ist immer Ausgangspunkt, auch wenn es belegt ist (z. B. der
+// Wurmkopf), wird aber nur mitgezählt, wenn es selbst betretbar ist.
+// Liefert die Anzahl der erreichten betretbaren Zellen. Ist out nicht NULL,
+// enthält es danach die erreichten Zellen als Bitebene
+// (bitboardPlaneWords() Wörter, Bitnummer = Zellnummer).
+extern int floodFillFromPos(struct bitboard* abits,
+                            struct pos start,
+                            uint64_t* out);
+
+#endif  // _BITBOARD_H
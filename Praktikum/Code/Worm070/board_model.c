@@ -7,14 +7,18 @@
 //   - Prüfen, ob das Terminalfenster groß genug ist            (initializeBoard)
 //   - Spielfeld mit freien Zellen, Barrieren und Futter füllen (initializeLevel)
 //   - Inhalt einzelner Zellen setzen und abfragen              (placeItem, getContentAt)
+//   - Ausgaben an den Renderer des Boards weiterreichen        (renderItem, renderBoard,
+//                                                               presentBoard)
 //   - Verwalten der Anzahl an verbliebenen Futterstellen
 //
 //  Wichtige Begriffe:
 //
 //   * Board / Spielfeld:
 //       Ein rechteckiger Bereich im Terminal, in dem sich der Wurm bewegt.
-//       Dieser Bereich wird in der Struktur struct board als 2D-Array
-//       (cells[y][x]) gespeichert.
+//       Dieser Bereich wird in der Struktur struct board als zeilenweise
+//       angelegter Block auf dem Heap gespeichert, umgeben von einem Rand
+//       aus Barrieren (siehe cellAt()). Die Größe wird zur Laufzeit
+//       festgelegt.
 //
 //   * Message Area:
 //       Unten im Fenster sind einige Zeilen als Ausgabe-Bereich für
@@ -24,40 +28,129 @@
 // ============================================================================
 
 #include <curses.h>
-#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "worm.h"
 #include "board_model.h"
-#include "messages.h"
+#include "render.h"
+#include "bitboard.h"
+#include "zobrist.h"
+#include "reach.h"
+#include "touchlog.h"
+
+// ============================================================================
+//  Richtungstabellen
+// ============================================================================
+// Reihenfolge wie enum WormHeading (worm.h).
+
+const int heading_dy[WORM_HEADINGS] = { -1, 1,  0, 0, -1, -1, 1,  1 };
+const int heading_dx[WORM_HEADINGS] = {  0, 0, -1, 1, -1,  1, 1, -1 };
 
 // ============================================================================
 //  initializeBoard
 // ============================================================================
 
-enum ResCodes initializeBoard(struct board* aboard) {
-    if (COLS < MIN_NUMBER_OF_COLS ||
-        LINES < MIN_NUMBER_OF_ROWS + ROWS_RESERVED) {
+// Gemeinsamer Teil von initializeBoard() und initializeBoardFromImage():
+// alles außer dem Füllen der Zellen. Liefert die Anzahl der Zellen des
+// Blocks oder 0 bei einem Fehler.
+static long prepareBoard(struct board* aboard,
+                         struct renderer* arenderer,
+                         int rows, int cols) {
+    aboard->renderer  = arenderer;
+    aboard->dirty_len = 0;
+    aboard->bits      = NULL;
+    aboard->reach     = NULL;
+    aboard->touched   = NULL;
+    aboard->free_set.stale = true;
+    aboard->food_eaten     = 0;
+
+    if (rows < MIN_NUMBER_OF_ROWS || rows > MAX_NUMBER_OF_ROWS ||
+        cols < MIN_NUMBER_OF_COLS || cols > MAX_NUMBER_OF_COLS) {
+        return 0;
+    }
 
-        char buf[100];
-        sprintf(
-            buf,
-            "Das Fenster ist zu klein: wir brauchen %dx%d",
-            MIN_NUMBER_OF_COLS,
-            MIN_NUMBER_OF_ROWS + ROWS_RESERVED
-        );
+    // Die Größenprüfung übernimmt der Renderer: ncurses prüft das
+    // Terminalfenster, der Null-Renderer braucht kein Terminal.
+    if (arenderer->checkSize(arenderer, rows, cols) != RES_OK) {
+        return 0;
+    }
+
+    // Zeilenlänge inklusive Rand auf volle Cache-Lines aufrunden
+    int stride = strideForCols(cols);
+    long needed = (long)(rows + 2 * BOARD_BORDER) * stride;
+
+    // Alle Zellnummern müssen in cellidx_t passen (UNUSED_CELL_INDEX frei)
+    if (needed > (long)MAX_CELL_INDEX) {
+        return 0;
+    }
+
+    if (needed > aboard->capacity) {
+        free(aboard->cells);
+        aboard->cells = aligned_alloc(BOARD_ALIGN, needed * sizeof(cell_t));
+        aboard->capacity = (aboard->cells != NULL) ? needed : 0;
+        if (aboard->cells == NULL) {
+            return 0;
+        }
+    }
+
+    aboard->stride   = stride;
+    aboard->last_row = rows - 1;
+    aboard->last_col = cols - 1;
+
+    for (int dir = 0; dir < WORM_HEADINGS; dir++) {
+        aboard->dir_offset[dir] = heading_dy[dir] * stride + heading_dx[dir];
+    }
 
-        showDialog(buf, "Bitte eine Taste druecken");
+    return needed;
+}
+
+enum ResCodes initializeBoard(struct board* aboard,
+                              struct renderer* arenderer,
+                              int rows, int cols) {
+    long needed = prepareBoard(aboard, arenderer, rows, cols);
+
+    if (needed == 0) {
         return RES_FAILED;
     }
 
-    aboard->last_row = MIN_NUMBER_OF_ROWS - 1;
-    aboard->last_col = MIN_NUMBER_OF_COLS - 1;
+    // Rand und Auffüllung sind Barrieren; das Innere wird von
+    // initializeLevel() überschrieben.
+    memset(aboard->cells, BC_BARRIER, needed * sizeof(cell_t));
+    aboard->hash = 0;   // nur Barrieren, siehe zobrist.h
 
     return RES_OK;
 }
 
+enum ResCodes initializeBoardFromImage(struct board* aboard,
+                                       struct renderer* arenderer,
+                                       int rows, int cols,
+                                       const cell_t* image,
+                                       uint64_t hash,
+                                       int food_items) {
+    long needed = prepareBoard(aboard, arenderer, rows, cols);
+
+    if (needed == 0) {
+        return RES_FAILED;
+    }
+
+    // Das Abbild enthält Rand und Auffüllung bereits: eine Kopie genügt
+    memcpy(aboard->cells, image, needed * sizeof(cell_t));
+    aboard->hash       = hash;
+    aboard->food_items = food_items;
+
+    return RES_OK;
+}
+
+void freeBoard(struct board* aboard) {
+    free(aboard->cells);
+    aboard->cells    = NULL;
+    aboard->capacity = 0;
+    freeFreeCells(aboard);
+}
+
 // ============================================================================
-//  placeItem – logischen Inhalt setzen UND Symbol zeichnen
+//  placeItem – logischen Inhalt setzen UND Symbol an den Renderer geben
 // ============================================================================
 
 void placeItem(struct board* aboard,
@@ -66,25 +159,146 @@ void placeItem(struct board* aboard,
                chtype symbol,
                enum ColorPairs color_pair)
 {
-    if (y >= 0 && y <= aboard->last_row &&
-        x >= 0 && x <= aboard->last_col) {
-        aboard->cells[y][x] = board_code;
+    struct pos position = { y, x };
+
+    setContentAt(aboard, position, board_code);
+    renderItem(aboard, y, x, symbol, color_pair);
+}
+
+// ============================================================================
+//  setContentAt / renderItem – Modell und Darstellung getrennt ansprechen
+// ============================================================================
+
+void setContentAt(struct board* aboard,
+                  struct pos position,
+                  enum BoardCodes board_code)
+{
+    if (position.y >= 0 && position.y <= aboard->last_row &&
+        position.x >= 0 && position.x <= aboard->last_col) {
+        setContentAtIndex(aboard, posToCellIndex(aboard, position), board_code);
+    }
+}
+
+// Menge der freien Zellen nachführen (swap-remove beim Entfernen)
+static inline void updateFreeCells(struct freeCellSet* aset, cellidx_t idx,
+                                   cell_t old_code, cell_t new_code)
+{
+    if (old_code == BC_FREE_CELL && new_code != BC_FREE_CELL) {
+        cellidx_t last = aset->cells[--aset->count];
+        aset->cells[aset->slot[idx]] = last;
+        aset->slot[last] = aset->slot[idx];
+    } else if (old_code != BC_FREE_CELL && new_code == BC_FREE_CELL) {
+        aset->slot[idx] = (cellidx_t)aset->count;
+        aset->cells[aset->count++] = idx;
+    }
+}
+
+void setContentAtIndex(struct board* aboard,
+                       cellidx_t idx,
+                       enum BoardCodes board_code)
+{
+    cell_t old_code = aboard->cells[idx];
+
+    if (aboard->touched != NULL) {
+        logTouchedCell(aboard->touched, idx);
+    }
+    if (aboard->bits != NULL) {
+        updateBitboardIndex(aboard->bits, idx,
+                            (enum BoardCodes)old_code, board_code);
     }
+    aboard->hash ^= zobristCellKey(idx, old_code)
+                  ^ zobristCellKey(idx, (cell_t)board_code);
+    aboard->cells[idx] = (cell_t)board_code;
 
-    move(y, x);
-    attron(COLOR_PAIR(color_pair));
-    addch(symbol);
-    attroff(COLOR_PAIR(color_pair));
+    if (!aboard->free_set.stale) {
+        updateFreeCells(&aboard->free_set, idx, old_code, (cell_t)board_code);
+    }
+    if (aboard->reach != NULL) {
+        updateReachCell(aboard->reach, idx,
+                        (enum BoardCodes)old_code, board_code);
+    }
+}
+
+// Gibt die Dirty-Liste in Reihenfolge an den Renderer weiter. Wurde eine
+// Zelle im selben Frame mehrfach vorgemerkt, gewinnt der letzte Eintrag.
+static void flushDirtyCells(struct board* aboard)
+{
+    struct renderer* r = aboard->renderer;
+
+    for (int i = 0; i < aboard->dirty_len; i++) {
+        struct dirtyCell* c = &aboard->dirty[i];
+        r->drawCell(r, c->y, c->x, c->symbol, c->color_pair);
+    }
+    aboard->dirty_len = 0;
+}
+
+void renderItem(struct board* aboard,
+                int y, int x,
+                chtype symbol,
+                enum ColorPairs color_pair)
+{
+    if (!aboard->renderer->has_output) {
+        return;
+    }
+
+    if (aboard->dirty_len == DIRTY_LIST_SIZE) {
+        flushDirtyCells(aboard);
+    }
+
+    struct dirtyCell* c = &aboard->dirty[aboard->dirty_len++];
+    c->y = y;
+    c->x = x;
+    c->symbol = symbol;
+    c->color_pair = color_pair;
+}
+
+void presentBoard(struct board* aboard)
+{
+    flushDirtyCells(aboard);
+    aboard->renderer->present(aboard->renderer);
+}
+
+// ============================================================================
+//  renderBoard – komplettes Spielfeld aus den BoardCodes neu zeichnen
+// ============================================================================
+
+void renderBoard(struct board* aboard) {
+    int x, y;
+
+    for (y = 0; y <= aboard->last_row; y++) {
+        for (x = 0; x <= aboard->last_col; x++) {
+            chtype sym;
+            enum ColorPairs col;
+
+            switch (*cellAt(aboard, y, x)) {
+                case BC_USED_BY_WORM: sym = SYMBOL_WORM_INNER; col = COLP_USER_WORM; break;
+                case BC_FOOD_1:       sym = SYMBOL_FOOD_1;     col = COLP_FOOD_1;    break;
+                case BC_FOOD_2:       sym = SYMBOL_FOOD_2;     col = COLP_FOOD_2;    break;
+                case BC_FOOD_3:       sym = SYMBOL_FOOD_3;     col = COLP_FOOD_3;    break;
+                case BC_BARRIER:      sym = SYMBOL_BARRIER;    col = COLP_BARRIER;   break;
+                default:              sym = SYMBOL_FREE_CELL;  col = COLP_FREE_CELL; break;
+            }
+            renderItem(aboard, y, x, sym, col);
+        }
+    }
+
+    // Untere Barriere (Trennlinie zur Message Area)
+    y = aboard->last_row + 1;
+    for (x = 0; x <= aboard->last_col; x++) {
+        renderItem(aboard, y, x, SYMBOL_BARRIER, COLP_BARRIER);
+    }
 }
 
 // ============================================================================
 //  initializeLevel – komplettes Level aufbauen
 // ============================================================================
 
-enum ResCodes initializeLevel(struct board* aboard) {
+enum ResCodes initializeLevel(struct board* aboard,
+                              struct renderer* arenderer,
+                              int rows, int cols) {
     int x, y;
 
-    if (initializeBoard(aboard) != RES_OK) {
+    if (initializeBoard(aboard, arenderer, rows, cols) != RES_OK) {
         return RES_FAILED;
     }
 
@@ -107,11 +321,8 @@ enum ResCodes initializeLevel(struct board* aboard) {
     // 2. Untere Barriere (Trennlinie zur Message Area)
     // ------------------------------------------------------------------------
     y = aboard->last_row + 1;
-    for (x = 0; x < MIN_NUMBER_OF_COLS; x++) {
-        move(y, x);
-        attron(COLOR_PAIR(COLP_BARRIER));
-        addch(SYMBOL_BARRIER);
-        attroff(COLOR_PAIR(COLP_BARRIER));
+    for (x = 0; x <= aboard->last_col; x++) {
+        renderItem(aboard, y, x, SYMBOL_BARRIER, COLP_BARRIER);
     }
 
     // ------------------------------------------------------------------------
@@ -179,6 +390,7 @@ enum ResCodes initializeLevel(struct board* aboard) {
     placeItem(aboard,  7, 30, BC_FOOD_3, SYMBOL_FOOD_3, COLP_FOOD_3);
 
     aboard->food_items = 10;
+    setFoodSeed(aboard, FOOD_SEED, 0);
 
     return RES_OK;
 }
@@ -192,11 +404,13 @@ int getNumberOfFoodItems(struct board* aboard) {
 }
 
 enum BoardCodes getContentAt(struct board* aboard, struct pos position) {
-    if (position.y < 0 || position.y > aboard->last_row ||
-        position.x < 0 || position.x > aboard->last_col) {
+    // Der Rand liefert BC_BARRIER von selbst; geprüft wird nur, ob die
+    // Position überhaupt im Speicherblock liegt.
+    if (position.y < -BOARD_BORDER || position.y > aboard->last_row + BOARD_BORDER ||
+        position.x < -BOARD_BORDER || position.x > aboard->last_col + BOARD_BORDER) {
         return BC_BARRIER;
     }
-    return aboard->cells[position.y][position.x];
+    return *cellAt(aboard, position.y, position.x);
 }
 
 int getLastRowOnBoard(struct board* aboard) {
@@ -207,16 +421,144 @@ int getLastColOnBoard(struct board* aboard) {
     return aboard->last_col;
 }
 
+int getNumberOfCells(struct board* aboard) {
+    return (aboard->last_row + 1) * (aboard->last_col + 1);
+}
+
 void decrementNumberOfFoodItems(struct board* aboard) {
     if (aboard->food_items > 0) {
         aboard->food_items--;
     }
+    aboard->food_eaten++;
+    spawnFood(aboard);
 }
 
 void setNumberOfFoodItems(struct board* aboard, int n) {
     aboard->food_items = n;
 }
 
+// ============================================================================
+//  Menge der freien Zellen und neues Futter
+// ============================================================================
+
+// Baut die Menge aus cells auf, falls sie veraltet ist. Die Listen
+// wachsen mit dem Zellblock und werden danach wiederverwendet.
+static enum ResCodes ensureFreeCells(struct board* aboard)
+{
+    struct freeCellSet* aset = &aboard->free_set;
+
+    if (!aset->stale) {
+        return RES_OK;
+    }
+
+    long needed = (long)(aboard->last_row + 1 + 2 * BOARD_BORDER) * aboard->stride;
+    if (needed > aset->capacity) {
+        freeFreeCells(aboard);
+        aset->cells = malloc(needed * sizeof(cellidx_t));
+        aset->slot  = malloc(needed * sizeof(cellidx_t));
+        if (aset->cells == NULL || aset->slot == NULL) {
+            freeFreeCells(aboard);
+            return RES_FAILED;
+        }
+        aset->capacity = needed;
+    }
+
+    aset->count = 0;
+    for (int y = 0; y <= aboard->last_row; y++) {
+        cellidx_t row = (cellidx_t)((y + BOARD_BORDER) * aboard->stride + BOARD_BORDER);
+        for (int x = 0; x <= aboard->last_col; x++) {
+            if (aboard->cells[row + x] == BC_FREE_CELL) {
+                aset->slot[row + x] = (cellidx_t)aset->count;
+                aset->cells[aset->count++] = row + x;
+            }
+        }
+    }
+    aset->stale = false;
+    return RES_OK;
+}
+
+void freeFreeCells(struct board* aboard)
+{
+    free(aboard->free_set.cells);
+    free(aboard->free_set.slot);
+    aboard->free_set.cells    = NULL;
+    aboard->free_set.slot     = NULL;
+    aboard->free_set.capacity = 0;
+    aboard->free_set.count    = 0;
+    aboard->free_set.stale    = true;
+}
+
+void invalidateFreeCells(struct board* aboard)
+{
+    aboard->free_set.stale = true;
+}
+
+void copyCellsToBoard(struct board* aboard,
+                      cellidx_t first,
+                      const cell_t* src,
+                      size_t bytes)
+{
+    cell_t* dst = aboard->cells + first;
+
+    // Blockweise vergleichen; nach einem Zurücksetzen unterscheiden sich
+    // nur wenige Blöcke
+    if (!aboard->free_set.stale) {
+        for (size_t w = 0; w < bytes; w += BOARD_ALIGN) {
+            size_t end = (w + BOARD_ALIGN < bytes) ? w + BOARD_ALIGN : bytes;
+            if (memcmp(dst + w, src + w, end - w) == 0) {
+                continue;
+            }
+            for (size_t k = w; k < end; k++) {
+                if (dst[k] != src[k]) {
+                    updateFreeCells(&aboard->free_set, (cellidx_t)(first + k),
+                                    dst[k], src[k]);
+                }
+            }
+        }
+    }
+    memcpy(dst, src, bytes);
+}
+
+int getNumberOfFreeCells(struct board* aboard)
+{
+    return ensureFreeCells(aboard) == RES_OK ? aboard->free_set.count : 0;
+}
+
+void setFoodSeed(struct board* aboard, uint64_t seed, uint64_t stream)
+{
+    initRngStream(&aboard->food_rng, seed, stream);
+}
+
+bool pickRandomFreeCell(struct board* aboard, cellidx_t* aidx)
+{
+    if (ensureFreeCells(aboard) != RES_OK || aboard->free_set.count == 0) {
+        return false;
+    }
+    *aidx = aboard->free_set.cells[rngBelow(&aboard->food_rng,
+                                            (uint32_t)aboard->free_set.count)];
+    return true;
+}
+
+bool spawnFood(struct board* aboard)
+{
+    static const enum BoardCodes codes[3]   = { BC_FOOD_1, BC_FOOD_2, BC_FOOD_3 };
+    static const chtype symbols[3]          = { SYMBOL_FOOD_1, SYMBOL_FOOD_2, SYMBOL_FOOD_3 };
+    static const enum ColorPairs colors[3]  = { COLP_FOOD_1, COLP_FOOD_2, COLP_FOOD_3 };
+    cellidx_t idx;
+
+    if (!pickRandomFreeCell(aboard, &idx)) {
+        return false;
+    }
+
+    uint32_t kind = rngBelow(&aboard->food_rng, 3);
+    placeItem(aboard,
+              (int)(idx / aboard->stride) - BOARD_BORDER,
+              (int)(idx % aboard->stride) - BOARD_BORDER,
+              codes[kind], symbols[kind], colors[kind]);
+    aboard->food_items++;
+    return true;
+}
+
 
 
 
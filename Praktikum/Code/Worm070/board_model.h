@@ -5,7 +5,15 @@
 #define _BOARD_MODEL_H
 
 #include <curses.h>
+#include <stdint.h>
+#include <stdbool.h>
 #include "worm.h"
+#include "render.h"
+#include "rng.h"
+
+struct bitboard;   // siehe bitboard.h
+struct reachTracker;   // siehe reach.h
+struct touchLog;   // siehe touchlog.h
 
 // ============================================================================
 //  BoardCodes – logische Inhalte einer Spielfeldzelle
@@ -49,6 +57,121 @@ struct pos {
     int x;   // x-Koordinate (Spaltennummer auf dem Spielfeld, von links nach rechts)
 };
 
+// ============================================================================
+//  Kompakte Speicherung – cell_t und cellidx_t
+//
+//  cell_t:
+//    Gespeicherter BoardCode einer Zelle. Alle Codes passen in ein Byte,
+//    daher belegt eine Zelle nur 1 statt 4 Byte (enum als int).
+//    Nach außen (getContentAt, placeItem, ...) wird weiterhin mit
+//    enum BoardCodes gearbeitet.
+//
+//  cellidx_t:
+//    Lineare Zellnummer im aufgefüllten Speicherblock (siehe struct board,
+//    Zelle (y, x) hat die Nummer (y + 1) * stride + (x + 1)). Der Wurm
+//    speichert seine Segmente als solche Nummern statt als struct pos mit
+//    zwei int (4 statt 8 Byte, mit WORM_SMALL_BOARDS sogar 2 Byte pro
+//    Segment). Umrechnung an der API-Grenze mit posToCellIndex() /
+//    cellIndexToPos().
+//
+//  WORM_SMALL_BOARDS:
+//    Beim Übersetzen mit -DWORM_SMALL_BOARDS werden 16-Bit-Zellnummern
+//    verwendet. Dann sind nur Boards mit höchstens 65535 Zellen (inklusive
+//    Rand und Zeilenauffüllung) zulässig; das Standardfeld 26x70 passt.
+// ============================================================================
+
+typedef uint8_t cell_t;
+
+#ifdef WORM_SMALL_BOARDS
+typedef uint16_t cellidx_t;
+#define MAX_CELL_INDEX UINT16_MAX
+#else
+typedef uint32_t cellidx_t;
+#define MAX_CELL_INDEX UINT32_MAX
+#endif
+
+// Markiert eine unbenutzte Zellnummer (z. B. leere Einträge im Ringpuffer)
+#define UNUSED_CELL_INDEX ((cellidx_t)MAX_CELL_INDEX)
+
+// ============================================================================
+//  Speicherlayout mit Rand (Sentinels)
+//
+//  Um das Spielfeld liegt ein Rand von BOARD_BORDER Zellen, die fest auf
+//  BC_BARRIER stehen. Ebenso alle Auffüllzellen am Zeilenende. Jeder der
+//  acht Nachbarn einer gültigen Zelle liegt damit im Speicherblock, und ein
+//  Schritt aus dem Feld heraus landet auf einer Barriere. moveWorm() braucht
+//  so keine Koordinatenprüfung mehr: Nachbarzelle = Zellnummer + Versatz aus
+//  board.dir_offset[] (eine Addition, ein Ladebefehl).
+//
+//  Der Zeilenabstand (stride) ist cols + 2 * BOARD_BORDER, aufgerundet auf
+//  volle BOARD_ALIGN Byte; strideForCols() wird auch vom Bitboard benutzt,
+//  damit Zellnummer und Bitnummer übereinstimmen.
+// ============================================================================
+
+#define BOARD_BORDER 1
+#define BOARD_ALIGN  64
+
+static inline int strideForCols(int cols)
+{
+    int cells_per_line = BOARD_ALIGN / sizeof(cell_t);
+    int width = cols + 2 * BOARD_BORDER;
+    return (width + cells_per_line - 1) / cells_per_line * cells_per_line;
+}
+
+// ============================================================================
+//  Menge der freien Zellen
+//
+//  Neues Futter erscheint auf einer zufälligen freien Zelle (BC_FREE_CELL).
+//  Zufällig ziehen und erneut versuchen, bis eine Zelle frei ist, wird
+//  langsam, wenn der Wurm fast das ganze Feld füllt. Deshalb führt das
+//  Board eine dichte Liste aller freien Zellen:
+//
+//    cells[0 .. count - 1]   Zellnummern der freien Zellen, ohne Lücken
+//    slot[idx]               Position von Zelle idx in cells (nur für
+//                            freie Zellen gültig)
+//
+//  Hinzufügen hängt hinten an, Entfernen setzt den letzten Eintrag auf den
+//  frei gewordenen Platz (swap-remove); beides O(1), ebenso das Ziehen
+//  einer gleichverteilten freien Zelle. setContentAtIndex() hält die Menge
+//  synchron, sie wird also von placeItem() und moveWorm() mitgeführt.
+//
+//  Die Listen werden erst beim ersten Gebrauch angelegt (stale). Wird der
+//  Zellblock direkt beschrieben (Batch-Umgebung), markiert
+//  invalidateFreeCells() die Menge; sie wird dann beim nächsten Gebrauch
+//  aus cells neu aufgebaut. copyCellsToBoard() (Snapshots) vergleicht
+//  dagegen wortweise und führt nur die geänderten Zellen nach; eine Suche,
+//  die tausendfach zurücksetzt, muss so nicht jedes Mal neu aufbauen.
+// ============================================================================
+
+struct freeCellSet {
+    cellidx_t* cells;   // freie Zellen, dicht
+    cellidx_t* slot;    // Zellnummer -> Index in cells
+    long capacity;      // Einträge in slot und cells (Zellblock)
+    int count;          // Anzahl freier Zellen
+    bool stale;         // vor dem nächsten Gebrauch neu aufbauen
+};
+
+// ============================================================================
+//  Dirty-Liste – geänderte Zellen eines Frames
+//
+//  Alle Ausgaben an den Renderer (placeItem, renderItem) werden nicht sofort
+//  gezeichnet, sondern in einer kleinen Liste gesammelt. presentBoard() gibt
+//  die Liste beim Refresh-Schritt in Reihenfolge an den Renderer weiter und
+//  leert sie. Pro Spielschritt fallen nur wenige Zellen an (neuer Kopf,
+//  alter Kopf, neuer Schwanz, freigegebene Zelle), unabhängig von der
+//  Wurmlänge. Läuft die Liste beim Levelaufbau über, wird sie vorzeitig
+//  geleert.
+// ============================================================================
+
+#define DIRTY_LIST_SIZE 64
+
+struct dirtyCell {
+    int y;
+    int x;
+    chtype symbol;
+    enum ColorPairs color_pair;
+};
+
 // ============================================================================
 //  struct board – Repräsentation des Spielfeldes
 //
@@ -57,66 +180,215 @@ struct pos {
 //  last_row / last_col:
 //    - geben den jeweils größten gültigen Index an, der benutzt werden darf
 //      (0 bis last_row beziehungsweise 0 bis last_col)
-//    - orientieren sich an MIN_NUMBER_OF_ROWS und MIN_NUMBER_OF_COLS aus worm.h
+//    - werden zur Laufzeit in initializeBoard() festgelegt, zwischen
+//      MIN_NUMBER_OF_* und MAX_NUMBER_OF_* aus worm.h
 //    - stellen also nicht die Anzahl, sondern den maximalen Index dar
 //
+//  stride:
+//    - Abstand zweier Zeilen in cells (in Zellen), inklusive Rand
+//    - auf volle 64 Byte aufgerundet, damit jede Zeile an einer Cache-Line
+//      beginnt und Vektor-Ladebefehle ausgerichtet zugreifen können
+//    - da eine Zelle 1 Byte groß ist, ist stride immer ein Vielfaches von 64;
+//      Zellnummer und Bitnummer im Bitboard (bitboard.h) stimmen damit überein
+//
+//  dir_offset:
+//    - Versatz der Zellnummer zum Nachbarn in jeder der acht Richtungen
+//      (Index enum WormHeading), also dy * stride + dx
+//
 //  cells:
-//    - zweidimensionales Array mit BoardCodes
+//    - ein zusammenhängender, zeilenweise angelegter Speicherblock auf dem
+//      Heap mit (last_row + 3) Zeilen zu je stride Zellen; Zelle (y, x)
+//      liegt bei cells[(y + 1) * stride + (x + 1)] (siehe cellAt()),
+//      Zeile 0 und Spalte 0 des Blocks sind bereits Rand
+//    - ein Byte (cell_t) pro Zelle
 //    - für jede Zelle wird gespeichert, ob sie frei ist, Futter enthält,
 //      vom Wurm belegt ist oder eine Barriere darstellt
 //    - dient als logische Repräsentation des Spielfeldzustands unabhängig
 //      von der tatsächlichen Ausgabe mit curses
 //
+//  capacity:
+//    - Anzahl der reservierten Zellen; ein erneutes initializeBoard() mit
+//      gleicher oder kleinerer Größe verwendet den Speicher weiter
+//
 //  food_items:
 //    - Anzahl der verbliebenen Futterobjekte im aktuellen Level
 //    - wird zum Beispiel reduziert, wenn der Wurm ein Futterfeld betritt
 //      und dieses Futter „gefressen“ hat
+//
+//  renderer:
+//    - Ausgabeschicht, an die alle sichtbaren Änderungen weitergereicht werden
+//    - im Headless-Betrieb der Null-Renderer (siehe render.h)
+//
+//  dirty / dirty_len:
+//    - seit dem letzten presentBoard() geänderte Zellen (siehe oben)
+//    - steht als größtes Feld (über 1 KB) am Ende der Struktur: ohne
+//      Ausgabe wird es nie gelesen, und die Felder, die cleanWormTail() und
+//      moveWorm() in jedem Schritt brauchen, liegen so auf wenigen
+//      Cache-Lines beieinander (wichtig für die Batch-Umgebung)
+//
+//  bits:
+//    - optionales Bitboard (siehe bitboard.h), das placeItem() und
+//      setContentAt() synchron zu cells halten; NULL, wenn nicht angehängt
+//
+//  hash:
+//    - Zobrist-Hashwert der Zellen (siehe zobrist.h), von
+//      setContentAtIndex() inkrementell geführt; 0 nach initializeBoard()
+//
+//  free_set / food_rng / food_eaten:
+//    - freie Zellen (siehe oben), Zufallsstrom für neues Futter (rng.h,
+//      setFoodSeed(); gleicher Seed und Strom, gleiches Spiel) und Anzahl
+//      der bisher gefressenen Futterstücke
+//
+//  reach:
+//    - optionaler Tracker des vom Wurmkopf erreichbaren Gebiets (siehe
+//      reach.h), dem setContentAtIndex() jede Änderung meldet; NULL, wenn
+//      nicht angehängt
+//
+//  touched:
+//    - optionales Protokoll der seit dem Laden geänderten Zellen (siehe
+//      touchlog.h) für resetLevel(); NULL, wenn nicht angehängt
 // ============================================================================
 
 struct board {
     int last_row; // letzte nutzbare Zeile auf dem Board (gültiger Indexbereich 0 bis last_row)
     int last_col; // letzte nutzbare Spalte auf dem Board (gültiger Indexbereich 0 bis last_col)
+    int stride;   // Zeilenabstand in cells (Anzahl Zellen inklusive Rand und Auffüllung)
+    int dir_offset[WORM_HEADINGS]; // Zellnummer-Versatz zum Nachbarn je Richtung
 
-    enum BoardCodes cells[MIN_NUMBER_OF_ROWS][MIN_NUMBER_OF_COLS];
-    // Logische Inhalte aller Spielfeldzellen in einem festen zweidimensionalen Array
+    cell_t* cells;
+    // Logische Inhalte aller Spielfeldzellen, zeilenweise in einem Block
+    long capacity; // Anzahl der reservierten Zellen in cells
 
     int food_items; // Anzahl der noch vorhandenen Futterstücke im aktuellen Level
+
+    struct renderer* renderer; // Ausgabeschicht (ncurses, null, recorder)
+
+    struct bitboard* bits;   // optionale Bitebenen-Darstellung oder NULL
+
+    uint64_t hash;           // Zobrist-Hashwert der Zellen
+
+    struct freeCellSet free_set; // freie Zellen für neues Futter
+    struct rngStream food_rng;   // Zufallsstrom für neues Futter
+    long food_eaten;             // bisher gefressene Futterstücke
+
+    struct reachTracker* reach; // optionaler Erreichbarkeits-Tracker oder NULL
+    struct touchLog* touched;   // optionales Änderungsprotokoll oder NULL
+    struct dirtyCell dirty[DIRTY_LIST_SIZE]; // geänderte Zellen des Frames
+    int dirty_len;                           // Anzahl der Einträge in dirty
 };
 
+// ============================================================================
+//  Zugriff auf eine Zelle
+// ============================================================================
+
+// Liefert die Adresse der Zelle (y, x) ohne Bereichsprüfung. Auch die
+// Randzellen y, x = -1 und y = last_row + 1, x = last_col + 1 sind gültig.
+static inline cell_t* cellAt(struct board* aboard, int y, int x)
+{
+    return &aboard->cells[(long)(y + BOARD_BORDER) * aboard->stride + x + BOARD_BORDER];
+}
+
+// Umrechnung Position -> Zellnummer (ohne Bereichsprüfung).
+static inline cellidx_t posToCellIndex(struct board* aboard, struct pos position)
+{
+    return (cellidx_t)((position.y + BOARD_BORDER) * aboard->stride
+                       + position.x + BOARD_BORDER);
+}
+
+// Umrechnung Zellnummer -> Position (Randzellen ergeben -1 bzw. last + 1).
+static inline struct pos cellIndexToPos(struct board* aboard, cellidx_t idx)
+{
+    struct pos position = { (int)(idx / aboard->stride) - BOARD_BORDER,
+                            (int)(idx % aboard->stride) - BOARD_BORDER };
+    return position;
+}
+
+// Zellnummer des Nachbarn von idx in Richtung dir (ohne Bereichsprüfung;
+// für jede Zelle des Spielfelds liegt das Ergebnis im Speicherblock).
+static inline cellidx_t neighbourIndex(struct board* aboard, cellidx_t idx,
+                                       enum WormHeading dir)
+{
+    return (cellidx_t)(idx + aboard->dir_offset[dir]);
+}
+
+// true, wenn die Zellnummer zum Rand oder zur Zeilenauffüllung gehört.
+// Nicht für den Spielschritt gedacht (Division), sondern für die seltene
+// Unterscheidung "Barriere im Feld" / "Feld verlassen".
+static inline bool isBorderIndex(struct board* aboard, cellidx_t idx)
+{
+    struct pos position = cellIndexToPos(aboard, idx);
+    return position.y < 0 || position.y > aboard->last_row ||
+           position.x < 0 || position.x > aboard->last_col;
+}
+
+// Liefert den BoardCode einer gültigen Zellnummer.
+static inline enum BoardCodes getContentAtIndex(struct board* aboard, cellidx_t idx)
+{
+    return (enum BoardCodes)aboard->cells[idx];
+}
+
 // ============================================================================
 //  Initialisierung des Boards
 // ============================================================================
 
-// Prüft die Fenstergröße, setzt last_row und last_col und bereitet das Board vor.
-// Es wird überprüft, ob das Terminalfenster groß genug ist, um das Spielfeld
-// und die Message Area darzustellen.
-// Liefert RES_OK bei Erfolg, sonst RES_FAILED.
-extern enum ResCodes initializeBoard(struct board* aboard);
+// Setzt den Renderer, prüft über ihn die Größe der Ausgabefläche, setzt
+// last_row und last_col und reserviert den Speicher für rows x cols Zellen
+// samt Rand. Rand und Auffüllung werden auf BC_BARRIER gesetzt, das
+// Spielfeld selbst füllt initializeLevel().
+// Beim ncurses-Renderer wird überprüft, ob das Terminalfenster groß genug ist,
+// um das Spielfeld und die Message Area darzustellen; der Null-Renderer
+// benötigt kein Terminal.
+//
+// Vor dem ersten Aufruf muss das Board mit Nullen initialisiert sein
+// (z. B. struct board b = {0};), danach wird vorhandener Speicher
+// wiederverwendet. Freigabe mit freeBoard().
+// Liefert RES_OK bei Erfolg, sonst RES_FAILED (auch bei ungültiger Größe
+// oder fehlendem Speicher).
+extern enum ResCodes initializeBoard(struct board* aboard,
+                                     struct renderer* arenderer,
+                                     int rows, int cols);
+
+// Wie initializeBoard(), aber die Zellen kommen mit einem einzigen memcpy()
+// aus einem fertigen Abbild im Speicherlayout von cells, also
+// (rows + 2) * strideForCols(cols) Zellen samt Rand und Auffüllung (siehe
+// level.h). hash und food_items müssen zum Abbild passen; geprüft wird
+// hier nichts. Nichts wird gezeichnet, der Futter-Seed bleibt unverändert.
+extern enum ResCodes initializeBoardFromImage(struct board* aboard,
+                                              struct renderer* arenderer,
+                                              int rows, int cols,
+                                              const cell_t* image,
+                                              uint64_t hash,
+                                              int food_items);
+
+// Gibt den Speicher des Boards frei.
+extern void freeBoard(struct board* aboard);
 
 // Initialisiert ein komplettes Level:
 //  - ruft initializeBoard auf, um Größe und Grenzen des Spielfelds zu prüfen
 //  - füllt das Board mit freien Zellen, Barrieren und Futter an festen Positionen
 //  - setzt die Variable food_items passend zur Anzahl der Futterstellen
-extern enum ResCodes initializeLevel(struct board* aboard);
+//  - setzt den Futter-Seed auf FOOD_SEED (jedes Spiel verläuft gleich)
+extern enum ResCodes initializeLevel(struct board* aboard,
+                                     struct renderer* arenderer,
+                                     int rows, int cols);
 
 // ============================================================================
-//  placeItem – logischen Inhalt setzen und Zeichen ausgeben
+//  placeItem – logischen Inhalt setzen und Zeichen an den Renderer geben
 //
 //  Parameter:
 //    aboard      : Zeiger auf das Spielfeld (Board-Struktur)
 //    y, x        : Zielposition auf dem Spielfeld (Zeile, Spalte)
 //    board_code  : logischer Inhalt (BoardCodes), der im Array cells
 //                  abgelegt wird, zum Beispiel BC_FREE_CELL oder BC_BARRIER
-//    symbol      : sichtbares Zeichen, das mit ncurses an dieser Stelle
+//    symbol      : sichtbares Zeichen, das vom Renderer an dieser Stelle
 //                  gezeichnet wird
 //    color_pair  : Farbnummer für die Darstellung (ncurses-Farbpaar)
 //
 //  Wirkung:
 //    - schreibt board_code an die betreffende Position in die Datenstruktur
-//    - zeichnet symbol in der gewünschten Farbe an die entsprechende Stelle
-//      im Terminalfenster
-//    Dadurch bleiben interne Repräsentation und grafische Ausgabe im
-//    Terminal immer konsistent.
+//    - gibt symbol in der gewünschten Farbe an den Renderer des Boards weiter
+//    Dadurch bleiben interne Repräsentation und grafische Ausgabe immer
+//    konsistent. Im Headless-Betrieb entfällt die Ausgabe.
 // ============================================================================
 
 extern void placeItem(struct board* aboard,
@@ -125,6 +397,37 @@ extern void placeItem(struct board* aboard,
                       chtype symbol,
                       enum ColorPairs color_pair);
 
+// Setzt nur den logischen Inhalt einer Zelle, ohne etwas auszugeben.
+// Wird von der Spiellogik (moveWorm) verwendet; ungültige Positionen werden
+// ignoriert.
+extern void setContentAt(struct board* aboard,
+                         struct pos position,
+                         enum BoardCodes board_code);
+
+// Wie setContentAt(), aber für eine gültige Zellnummer (ohne Bereichsprüfung).
+// Alle Änderungen am Modell laufen über diese Funktion.
+extern void setContentAtIndex(struct board* aboard,
+                              cellidx_t idx,
+                              enum BoardCodes board_code);
+
+// Merkt ein Zeichen für den Renderer vor, ohne das Modell zu verändern.
+// Wird für reine Darstellungen wie den Wurm (Kopf/Körper/Schwanz) oder die
+// Trennlinie unterhalb des Spielfelds verwendet. Gezeichnet wird erst in
+// presentBoard().
+extern void renderItem(struct board* aboard,
+                       int y, int x,
+                       chtype symbol,
+                       enum ColorPairs color_pair);
+
+// Zeichnet das komplette Spielfeld neu, abgeleitet aus den BoardCodes.
+// Vom Wurm belegte Zellen erscheinen als Körpersegmente; Kopf und Schwanz
+// werden anschließend von showWorm() darübergezeichnet.
+extern void renderBoard(struct board* aboard);
+
+// Refresh-Schritt: gibt alle vorgemerkten Zellen an den Renderer weiter,
+// leert die Dirty-Liste und schließt den Frame ab (bei ncurses: refresh()).
+extern void presentBoard(struct board* aboard);
+
 // ============================================================================
 //  Getter-Funktionen für Board-Informationen
 // ============================================================================
@@ -151,6 +454,10 @@ extern int getLastRowOnBoard(struct board* aboard);
 // Auch hier handelt es sich um den maximalen gültigen Spaltenindex.
 extern int getLastColOnBoard(struct board* aboard);
 
+// Liefert die Anzahl aller Zellen des Boards (Zeilen * Spalten).
+// Das ist zugleich die größtmögliche Wurmlänge.
+extern int getNumberOfCells(struct board* aboard);
+
 // ============================================================================
 //  Setter-Funktionen für Board-Informationen
 // ============================================================================
@@ -158,8 +465,46 @@ extern int getLastColOnBoard(struct board* aboard);
 // Verringert die Anzahl der Futterstücke um 1, sofern der Wert größer 0 ist.
 // Wird typischerweise aufgerufen, wenn der Wurm ein Futterfeld betritt.
 // Eine Unterlaufprüfung verhindert, dass der Zähler einen negativen Wert annimmt.
+// Zählt food_eaten hoch und legt mit spawnFood() neues Futter aus.
 extern void decrementNumberOfFoodItems(struct board* aboard);
 
+// ============================================================================
+//  Neues Futter
+// ============================================================================
+
+// Standard-Seed für neues Futter (initializeLevel())
+#define FOOD_SEED 0x466f6f64ULL
+
+// Setzt den Zufallsstrom für neues Futter auf Strom stream zu seed (z. B.
+// eine Nummer je Spiel, siehe rng.h).
+extern void setFoodSeed(struct board* aboard, uint64_t seed, uint64_t stream);
+
+// Legt ein zufälliges Futterstück (BC_FOOD_1 bis BC_FOOD_3) auf eine
+// gleichverteilt gezogene freie Zelle und zählt food_items hoch.
+// false, wenn keine Zelle frei ist (oder kein Speicher für die Menge).
+extern bool spawnFood(struct board* aboard);
+
+// Zieht eine gleichverteilte freie Zelle in O(1). false, wenn keine frei ist.
+extern bool pickRandomFreeCell(struct board* aboard, cellidx_t* aidx);
+
+// Anzahl der freien Zellen (BC_FREE_CELL).
+extern int getNumberOfFreeCells(struct board* aboard);
+
+// Markiert die Menge der freien Zellen als veraltet (nach direktem
+// Schreiben in cells); sie wird beim nächsten Gebrauch neu aufgebaut.
+extern void invalidateFreeCells(struct board* aboard);
+
+// Gibt die Listen der Menge frei (auch in freeBoard()).
+extern void freeFreeCells(struct board* aboard);
+
+// Kopiert bytes Zellen ab Zellnummer first aus src in
+// den Zellblock und hält dabei eine gültige Menge der freien Zellen
+// synchron. Bitboard, Hash und Reach-Tracker werden nicht nachgeführt.
+extern void copyCellsToBoard(struct board* aboard,
+                             cellidx_t first,
+                             const cell_t* src,
+                             size_t bytes);
+
 // Setzt die Anzahl der Futterstücke explizit auf n.
 // Diese Funktion eignet sich zum Beispiel für die Initialisierung oder
 // für Tests, bei denen bestimmte Futterkonstellationen nachgestellt werden.
@@ -0,0 +1,273 @@
+// Worm070 - Aufgabenblatt 8
+// ============================================================================
+//  Modul: headless.c  –  Spielablauf ohne Terminal
+// ============================================================================
+
+#include <stdio.h>
+#include <time.h>
+
+#include "worm.h"
+#include "board_model.h"
+#include "worm_model.h"
+#include "render.h"
+#include "headless.h"
+#include "level.h"
+#include "touchlog.h"
+#include "zobrist.h"
+
+// Level-Datei für startGame() (useLevelFile()) und Nummer des nächsten Levels
+static const struct levelFile* level_source = NULL;
+static int next_level = 0;
+
+// ============================================================================
+//  startGame / startHeadlessGame / restartHeadlessGame / useLevelFile
+// ============================================================================
+
+void useLevelFile(const struct levelFile* alf)
+{
+    level_source = alf;
+    next_level   = 0;
+}
+
+// Baut das nächste Level auf: aus der Level-Datei oder mit initializeLevel().
+static enum ResCodes buildLevel(struct board* aboard, struct renderer* arenderer,
+                                int rows, int cols)
+{
+    if (level_source != NULL) {
+        int index = next_level;
+        next_level = (next_level + 1) % level_source->count;
+        return loadLevel(aboard, arenderer, level_source, index);
+    }
+    return initializeLevel(aboard, arenderer, rows, cols);
+}
+
+// Legt den Wurm an der Startzelle an.
+static enum ResCodes placeStartWorm(struct board* aboard, struct worm* aworm)
+{
+    struct pos headpos;
+    headpos.y = getLastRowOnBoard(aboard);
+    headpos.x = 0;
+
+    return initializeWorm(aboard,
+                          aworm,
+                          getNumberOfCells(aboard),
+                          WORM_INITIAL_LENGTH,
+                          headpos,
+                          WORM_RIGHT,
+                          COLP_USER_WORM);
+}
+
+enum ResCodes startGame(struct board* aboard, struct worm* aworm,
+                        struct renderer* arenderer, int rows, int cols)
+{
+    if (buildLevel(aboard, arenderer, rows, cols) != RES_OK) {
+        return RES_FAILED;
+    }
+    return placeStartWorm(aboard, aworm);
+}
+
+enum ResCodes startHeadlessGame(struct board* aboard, struct worm* aworm,
+                                int rows, int cols)
+{
+    return startGame(aboard, aworm, getNullRenderer(), rows, cols);
+}
+
+enum ResCodes restartHeadlessGame(struct board* aboard, struct worm* aworm,
+                                  struct touchLog* alog, int rows, int cols)
+{
+    if (level_source == NULL && aboard->touched == alog && alog != NULL) {
+        resetLevel(aboard);
+        return placeStartWorm(aboard, aworm);
+    }
+
+    if (buildLevel(aboard, getNullRenderer(), rows, cols) != RES_OK) {
+        return RES_FAILED;
+    }
+    // Level aus einer Datei wechseln reihum, ein Abbild lohnt sich nicht
+    if (level_source == NULL && alog != NULL &&
+        attachTouchLog(aboard, alog, NULL) != RES_OK) {
+        return RES_FAILED;
+    }
+    return placeStartWorm(aboard, aworm);
+}
+
+// ============================================================================
+//  stepHeadlessGame
+// ============================================================================
+
+enum GameStates stepHeadlessGame(struct board* aboard, struct worm* aworm)
+{
+    enum GameStates game_state = WORM_GAME_ONGOING;
+
+    cleanWormTail(aboard, aworm);
+    moveWorm(aboard, aworm, &game_state);
+
+    return game_state;
+}
+
+// ============================================================================
+//  steerAroundObstacles – einfache Ausweichsteuerung
+// ============================================================================
+// Behält die aktuelle Richtung bei, solange die Zielzelle frei ist oder
+// Futter enthält. Sonst wird die erste passende der acht Richtungen gewählt.
+// ============================================================================
+
+static bool isPassable(struct board* aboard, struct worm* aworm,
+                       enum WormHeading dir)
+{
+    cellidx_t head = getWormHeadCell(aworm);
+    enum BoardCodes content = getContentAtIndex(aboard,
+                                                neighbourIndex(aboard, head, dir));
+    return content != BC_BARRIER && content != BC_USED_BY_WORM;
+}
+
+static void steerAroundObstacles(struct board* aboard, struct worm* aworm)
+{
+    if (isPassable(aboard, aworm, aworm->heading)) {
+        return;
+    }
+
+    for (int dir = WORM_UP; dir <= WORM_DOWN_LEFT; dir++) {
+        if (isPassable(aboard, aworm, (enum WormHeading)dir)) {
+            setWormHeading(aworm, (enum WormHeading)dir);
+            return;
+        }
+    }
+}
+
+// ============================================================================
+//  checkHashes
+// ============================================================================
+// board.hash und worm.hash werden inkrementell geführt (zobrist.h). Hier
+// werden sie mit computeBoardHash() bzw. computeWormHash() verglichen;
+// außerdem muss der Spielzustand nach storeTransTable() mit
+// probeTransTable() wiederzufinden sein. Bei einer Abweichung Meldung auf
+// stderr und RES_FAILED.
+// ============================================================================
+
+static enum ResCodes checkHashes(struct board* aboard, struct worm* aworm,
+                                 struct transTable* att, long tick)
+{
+    uint64_t board_hash = computeBoardHash(aboard);
+    uint64_t worm_hash  = computeWormHash(aworm);
+    uint64_t hash = gameHash(aboard, aworm);
+    struct ttData data = {
+        .value = (int32_t)tick,
+        .depth = 1,
+        .move  = (uint8_t)aworm->heading,
+        .bound = TT_BOUND_EXACT,
+    };
+    struct ttData found;
+
+    if (board_hash != aboard->hash || worm_hash != aworm->hash) {
+        fprintf(stderr, "Hashwert falsch nach %ld Schritten: "
+                        "Board %016llx statt %016llx, Wurm %016llx statt %016llx\n",
+                tick,
+                (unsigned long long)aboard->hash, (unsigned long long)board_hash,
+                (unsigned long long)aworm->hash, (unsigned long long)worm_hash);
+        return RES_FAILED;
+    }
+
+    storeTransTable(att, hash, data);
+    if (!probeTransTable(att, hash, &found) || found.value != data.value ||
+        found.move != data.move || found.bound != data.bound) {
+        fprintf(stderr, "Transpositionstabelle liefert den Zustand nach %ld "
+                        "Schritten nicht zurück\n", tick);
+        return RES_FAILED;
+    }
+    return RES_OK;
+}
+
+// ============================================================================
+//  runHeadless
+// ============================================================================
+// Prüfung der Hashwerte (checkHashes()) alle HASH_CHECK_TICKS Schritte,
+// beim ersten Neustart danach (Weg über resetLevel()) und am Ende. Zwei
+// vollständige Durchläufe je Intervall fallen beim Durchsatz nicht ins
+// Gewicht.
+// ============================================================================
+
+#define HASH_CHECK_TICKS   65536
+#define HASH_CHECK_TT_LOG2 10
+
+static double secondsSince(const struct timespec* start)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) * 1e-9;
+}
+
+enum ResCodes runHeadless(long ticks, long game_ticks,
+                          int rows, int cols,
+                          struct headlessStats* astats)
+{
+    struct board theBoard = {0};
+    struct worm  theWorm  = {0};
+    struct touchLog theLog = {0};
+    struct transTable theTable = {0};
+    struct timespec start;
+    long game_start = 0;
+    bool check_restart = true;
+    enum ResCodes res = RES_OK;
+
+    astats->ticks = 0;
+    astats->games = 0;
+    astats->start_seconds = 0.0;
+    astats->step_seconds = 0.0;
+    astats->encode_seconds = 0.0;
+    astats->hash_checks = 0;
+
+    if (initializeTransTable(&theTable, HASH_CHECK_TT_LOG2) != RES_OK ||
+        restartHeadlessGame(&theBoard, &theWorm, &theLog, rows, cols) != RES_OK) {
+        freeBoard(&theBoard);
+        freeWorm(&theWorm);
+        freeTouchLog(&theLog);
+        freeTransTable(&theTable);
+        return RES_FAILED;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    while (res == RES_OK && astats->ticks < ticks) {
+        steerAroundObstacles(&theBoard, &theWorm);
+
+        enum GameStates game_state = stepHeadlessGame(&theBoard, &theWorm);
+        astats->ticks++;
+
+        if (game_state != WORM_GAME_ONGOING ||
+            (game_ticks > 0 && astats->ticks - game_start >= game_ticks)) {
+            struct timespec restart;
+            clock_gettime(CLOCK_MONOTONIC, &restart);
+
+            astats->games++;
+            res = restartHeadlessGame(&theBoard, &theWorm, &theLog, rows, cols);
+            astats->start_seconds += secondsSince(&restart);
+            game_start = astats->ticks;
+
+            if (res == RES_OK && check_restart) {
+                res = checkHashes(&theBoard, &theWorm, &theTable, astats->ticks);
+                astats->hash_checks++;
+                check_restart = false;
+            }
+        }
+
+        if (res == RES_OK && astats->ticks % HASH_CHECK_TICKS == 0) {
+            res = checkHashes(&theBoard, &theWorm, &theTable, astats->ticks);
+            astats->hash_checks++;
+            check_restart = true;
+        }
+    }
+
+    astats->seconds = secondsSince(&start);
+
+    if (res == RES_OK) {
+        res = checkHashes(&theBoard, &theWorm, &theTable, astats->ticks);
+        astats->hash_checks++;
+    }
+
+    freeBoard(&theBoard);
+    freeWorm(&theWorm);
+    freeTouchLog(&theLog);
+    freeTransTable(&theTable);
+    return res;
+}
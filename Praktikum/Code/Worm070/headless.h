@@ -0,0 +1,112 @@
+// Worm070 - Aufgabenblatt 8
+// ============================================================================
+//  headless.h – Spielablauf ohne Terminal
+//
+//  Im Headless-Betrieb laufen Board- und Wurmmodell mit dem Null-Renderer.
+//  Es gibt weder Terminalausgabe noch napms(NAP_TIME): jeder Spielschritt
+//  kostet nur noch die reine Spiellogik. Gedacht für Bots, Benchmarks und
+//  Regressionsläufe.
+// ============================================================================
+
+#ifndef _HEADLESS_H
+#define _HEADLESS_H
+
+#include "worm.h"
+#include "board_model.h"
+#include "worm_model.h"
+
+// ---------------------------------------------------------------------------
+//  struct headlessStats – Ergebnis eines Headless-Laufs
+// ---------------------------------------------------------------------------
+struct headlessStats {
+    long ticks;       // ausgeführte Spielschritte (moveWorm-Aufrufe)
+    long games;       // beendete Spiele (Crash, Selbstkollision, ...)
+    double seconds;   // verstrichene Zeit
+    double start_seconds; // davon für den Aufbau neuer Spiele (nur runHeadless)
+    double step_seconds;  // davon für stepBatchEnv() (nur runBatchHeadless)
+    double encode_seconds; // davon für die Ebenen (nur runBatchHeadless)
+    long hash_checks;     // Vergleiche mit neu berechneten Hashwerten (nur runHeadless)
+};
+
+struct levelFile;   // siehe level.h
+struct touchLog;    // siehe touchlog.h
+
+// ---------------------------------------------------------------------------
+//  startGame
+// ---------------------------------------------------------------------------
+// Baut Level und Wurm mit dem angegebenen Renderer auf (Start unten links,
+// Richtung rechts, Startlänge WORM_INITIAL_LENGTH). Gemeinsamer Startpunkt
+// für das Spiel im Terminal, Headless-Läufe und die Replay-Wiedergabe.
+// Ist mit useLevelFile() eine Level-Datei gesetzt, kommt das Level reihum
+// aus dieser Datei (rows und cols werden dann ignoriert), sonst von
+// initializeLevel().
+// ---------------------------------------------------------------------------
+extern enum ResCodes startGame(struct board* aboard,
+                               struct worm* aworm,
+                               struct renderer* arenderer,
+                               int rows, int cols);
+
+// ---------------------------------------------------------------------------
+//  useLevelFile
+// ---------------------------------------------------------------------------
+// Jedes folgende startGame() lädt das nächste Level aus alf (nach dem
+// letzten wieder das erste). NULL schaltet auf initializeLevel() zurück.
+// Die Datei muss geöffnet bleiben, solange Spiele gestartet werden.
+// ---------------------------------------------------------------------------
+extern void useLevelFile(const struct levelFile* alf);
+
+// ---------------------------------------------------------------------------
+//  startHeadlessGame
+// ---------------------------------------------------------------------------
+// startGame() mit dem Null-Renderer. Die Größe rows x cols
+// ist frei wählbar (MIN_NUMBER_OF_* bis MAX_NUMBER_OF_*). Board und Wurm
+// werden wiederverwendet, wenn sie bereits Speicher besitzen.
+// ---------------------------------------------------------------------------
+extern enum ResCodes startHeadlessGame(struct board* aboard,
+                                       struct worm* aworm,
+                                       int rows, int cols);
+
+// ---------------------------------------------------------------------------
+//  restartHeadlessGame
+// ---------------------------------------------------------------------------
+// Wie startHeadlessGame(), für wiederholte Starts desselben Levels: Ist
+// alog bereits am Board angehängt, setzt resetLevel() nur die seit dem
+// letzten Start geänderten Zellen zurück. Sonst wird das Level aufgebaut
+// und alog angehängt (alog vorher mit Nullen initialisieren, Freigabe mit
+// freeTouchLog()). Mit einer Level-Datei oder alog == NULL genau wie
+// startHeadlessGame().
+// ---------------------------------------------------------------------------
+extern enum ResCodes restartHeadlessGame(struct board* aboard,
+                                         struct worm* aworm,
+                                         struct touchLog* alog,
+                                         int rows, int cols);
+
+// ---------------------------------------------------------------------------
+//  stepHeadlessGame
+// ---------------------------------------------------------------------------
+// Führt genau einen Spielschritt aus: cleanWormTail() und moveWorm().
+// Liefert den neuen Spielzustand.
+// ---------------------------------------------------------------------------
+extern enum GameStates stepHeadlessGame(struct board* aboard,
+                                        struct worm* aworm);
+
+// ---------------------------------------------------------------------------
+//  runHeadless
+// ---------------------------------------------------------------------------
+// Spielt ticks Schritte auf einem rows x cols großen Feld mit einer einfachen
+// Ausweichsteuerung (beibehaltene Richtung, sonst die erste freie der acht
+// Richtungen). Beendete Spiele werden sofort neu gestartet, mit
+// game_ticks > 0 auch jedes Spiel nach spätestens game_ticks Schritten
+// (sonst endet bei nachwachsendem Futter kaum ein Spiel, und eine
+// Level-Datei würde nie reihum gespielt). Neustarts laufen über
+// restartHeadlessGame(). Das Ergebnis landet in astats, mit der Zeit für
+// den Aufbau der Spiele in start_seconds.
+// Nebenbei werden die inkrementellen Hashwerte regelmäßig mit den
+// vollständig berechneten verglichen (zobrist.h); eine Abweichung meldet
+// runHeadless() auf stderr und liefert RES_FAILED.
+// ---------------------------------------------------------------------------
+extern enum ResCodes runHeadless(long ticks, long game_ticks,
+                                 int rows, int cols,
+                                 struct headlessStats* astats);
+
+#endif  // _HEADLESS_H
@@ -0,0 +1,527 @@
+// Worm070 - Aufgabenblatt 8
+// ============================================================================
+//  Modul: level.c  –  Level aus Text- und Binärdateien
+// ============================================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "worm.h"
+#include "board_model.h"
+#include "render.h"
+#include "level.h"
+
+// Die Abbilder beginnen direkt nach dem Kopf auf der nächsten Cache-Line
+#define LEVEL_IMAGE_OFFSET BOARD_ALIGN
+
+_Static_assert(sizeof(struct levelFileHeader) <= LEVEL_IMAGE_OFFSET,
+               "Kopf der Level-Datei passt nicht vor das erste Abbild");
+
+// ============================================================================
+//  Textformat
+// ============================================================================
+
+// BoardCode zu einem Zeichen des Textformats, -1 bei unbekannten Zeichen
+static int codeForChar(char c)
+{
+    switch (c) {
+        case '.': return BC_FREE_CELL;
+        case '#': return BC_BARRIER;
+        case '1': return BC_FOOD_1;
+        case '2': return BC_FOOD_2;
+        case '3': return BC_FOOD_3;
+        default:  return -1;
+    }
+}
+
+// Liest die nächste Zeile ohne Zeilenende; leere Zeilen und Kommentare
+// werden übersprungen. Liefert false am Dateiende.
+static bool nextLine(FILE* f, char** aline, size_t* alen, int* alineno)
+{
+    ssize_t n;
+
+    while ((n = getline(aline, alen, f)) != -1) {
+        (*alineno)++;
+        while (n > 0 && ((*aline)[n - 1] == '\n' || (*aline)[n - 1] == '\r')) {
+            (*aline)[--n] = '\0';
+        }
+        if (n > 0 && (*aline)[0] != ';') {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Liest die rows Zeilen eines Levels nach "size" über setContentAtIndex()
+// in das (mit Barrieren gefüllte) Board; Hashwert und Futteranzahl werden
+// dabei mitgeführt.
+static enum ResCodes readTextGrid(struct board* aboard, FILE* f,
+                                  char** aline, size_t* alen, int* alineno)
+{
+    int cols = aboard->last_col + 1;
+
+    aboard->food_items = 0;
+
+    for (int y = 0; y <= aboard->last_row; y++) {
+        if (!nextLine(f, aline, alen, alineno) || (int)strlen(*aline) != cols) {
+            return RES_FAILED;
+        }
+
+        cellidx_t idx = posToCellIndex(aboard, (struct pos){ y, 0 });
+        for (int x = 0; x < cols; x++, idx++) {
+            int code = codeForChar((*aline)[x]);
+            if (code < 0) {
+                return RES_FAILED;
+            }
+            if (code >= BC_FOOD_1 && code <= BC_FOOD_3) {
+                aboard->food_items++;
+            }
+            setContentAtIndex(aboard, idx, (enum BoardCodes)code);
+        }
+    }
+
+    // Startzelle des Wurms (siehe startGame())
+    struct pos start = { aboard->last_row, 0 };
+    return getContentAt(aboard, start) == BC_FREE_CELL ? RES_OK : RES_FAILED;
+}
+
+// Hängt das Level auf aboard an images / entries an (Kapazität verdoppeln)
+static enum ResCodes appendLevel(struct levelFile* alf, struct board* aboard,
+                                 cell_t** aimages, struct levelEntry** aentries,
+                                 int* acapacity)
+{
+    if (alf->count == *acapacity) {
+        int capacity = (*acapacity > 0) ? 2 * *acapacity : 16;
+        cell_t* images = realloc(*aimages, (size_t)capacity * alf->cells_bytes);
+        if (images == NULL) {
+            return RES_FAILED;
+        }
+        *aimages = images;
+
+        struct levelEntry* entries = realloc(*aentries,
+                                             capacity * sizeof(struct levelEntry));
+        if (entries == NULL) {
+            return RES_FAILED;
+        }
+        *aentries = entries;
+        *acapacity = capacity;
+    }
+
+    memcpy(*aimages + (size_t)alf->count * alf->cells_bytes,
+           aboard->cells, alf->cells_bytes);
+    (*aentries)[alf->count].hash       = aboard->hash;
+    (*aentries)[alf->count].food_items = aboard->food_items;
+    (*aentries)[alf->count].reserved   = 0;
+    alf->count++;
+    return RES_OK;
+}
+
+// ----------------------------------------------------------------------------
+//  readTextLevels
+// ----------------------------------------------------------------------------
+// Vorgehen je Level:
+//    - "size"-Zeile lesen, Board mit dem Null-Renderer anlegen (prüft die
+//      Größe und füllt Rand und Inneres mit Barrieren)
+//    - Zeilen über setContentAtIndex() eintragen
+//    - Zellblock und Hashwert an die Heap-Darstellung anhängen
+// ----------------------------------------------------------------------------
+static enum ResCodes readTextLevels(struct levelFile* alf, FILE* f)
+{
+    struct board level = {0};
+    cell_t* images = NULL;
+    struct levelEntry* entries = NULL;
+    int capacity = 0;
+    char* line = NULL;
+    size_t len = 0;
+    int lineno = 0;
+    enum ResCodes res = RES_OK;
+
+    while (res == RES_OK && nextLine(f, &line, &len, &lineno)) {
+        int rows, cols;
+
+        if (sscanf(line, "size %d %d", &rows, &cols) != 2 ||
+            (alf->count > 0 && (rows != alf->rows || cols != alf->cols)) ||
+            initializeBoard(&level, getNullRenderer(), rows, cols) != RES_OK) {
+            res = RES_FAILED;
+            break;
+        }
+
+        alf->rows        = rows;
+        alf->cols        = cols;
+        alf->cells_bytes = (long)(rows + 2 * BOARD_BORDER) * level.stride;
+
+        res = readTextGrid(&level, f, &line, &len, &lineno);
+        if (res == RES_OK) {
+            res = appendLevel(alf, &level, &images, &entries, &capacity);
+        }
+    }
+
+    if (res == RES_OK && alf->count == 0) {
+        res = RES_FAILED;
+    }
+
+    free(line);
+    freeBoard(&level);
+
+    alf->images  = images;
+    alf->entries = entries;
+    alf->mapped  = false;
+
+    if (res != RES_OK) {
+        alf->error_line = lineno;
+        closeLevelFile(alf);
+    }
+    return res;
+}
+
+// ============================================================================
+//  Binärformat
+// ============================================================================
+
+// Prüft den Kopf einer eingeblendeten Datei gegen ihre Länge. Die Abbilder
+// selbst werden erst in loadLevel() angesehen.
+static bool headerIsValid(const struct levelFileHeader* h, size_t size)
+{
+    if (size < sizeof(*h) || h->version != LEVEL_FILE_VERSION ||
+        h->rows < MIN_NUMBER_OF_ROWS || h->rows > MAX_NUMBER_OF_ROWS ||
+        h->cols < MIN_NUMBER_OF_COLS || h->cols > MAX_NUMBER_OF_COLS ||
+        h->stride != strideForCols(h->cols) || h->count <= 0) {
+        return false;
+    }
+
+    uint64_t images = (uint64_t)h->count * h->cells_bytes;
+    uint64_t entries = (uint64_t)h->count * sizeof(struct levelEntry);
+
+    return h->cells_bytes == (uint64_t)(h->rows + 2 * BOARD_BORDER) * h->stride &&
+           h->image_offset >= sizeof(*h) &&
+           h->image_offset % BOARD_ALIGN == 0 &&
+           h->image_offset <= size && images <= size - h->image_offset &&
+           h->entry_offset >= h->image_offset + images &&
+           h->entry_offset % sizeof(uint64_t) == 0 &&
+           h->entry_offset <= size && entries <= size - h->entry_offset;
+}
+
+static enum ResCodes mapLevelFile(struct levelFile* alf, int fd)
+{
+    struct stat st;
+
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(struct levelFileHeader)) {
+        return RES_FAILED;
+    }
+
+    void* map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map == MAP_FAILED) {
+        return RES_FAILED;
+    }
+
+    const struct levelFileHeader* h = map;
+    if (!headerIsValid(h, st.st_size)) {
+        munmap(map, st.st_size);
+        return RES_FAILED;
+    }
+
+    alf->rows        = h->rows;
+    alf->cols        = h->cols;
+    alf->count       = h->count;
+    alf->cells_bytes = (long)h->cells_bytes;
+    alf->images      = (const cell_t*)((const char*)map + h->image_offset);
+    alf->entries     = (const struct levelEntry*)((const char*)map + h->entry_offset);
+    alf->mapped      = true;
+    alf->map         = map;
+    alf->map_size    = st.st_size;
+    return RES_OK;
+}
+
+// ============================================================================
+//  openLevelFile / closeLevelFile
+// ============================================================================
+
+enum ResCodes openLevelFile(struct levelFile* alf, const char* path)
+{
+    char magic[4] = {0};
+    enum ResCodes res;
+
+    alf->count      = 0;
+    alf->error_line = 0;
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return RES_FAILED;
+    }
+
+    if (pread(fd, magic, sizeof(magic), 0) == (ssize_t)sizeof(magic) &&
+        memcmp(magic, LEVEL_FILE_MAGIC, sizeof(magic)) == 0) {
+        // Die Einblendung bleibt auch nach close() bestehen
+        res = mapLevelFile(alf, fd);
+        close(fd);
+        return res;
+    }
+
+    FILE* f = fdopen(fd, "r");
+    if (f == NULL) {
+        close(fd);
+        return RES_FAILED;
+    }
+    res = readTextLevels(alf, f);
+    fclose(f);
+    return res;
+}
+
+void closeLevelFile(struct levelFile* alf)
+{
+    if (alf->mapped) {
+        munmap(alf->map, alf->map_size);
+    } else {
+        free((void*)alf->images);
+        free((void*)alf->entries);
+    }
+
+    alf->images   = NULL;
+    alf->entries  = NULL;
+    alf->mapped   = false;
+    alf->map      = NULL;
+    alf->map_size = 0;
+    alf->count    = 0;
+}
+
+// ============================================================================
+//  loadLevel
+// ============================================================================
+
+// Eine Cache-Line voller Barrieren als Vergleichsmuster für den Rand
+static const cell_t barrier_line[BOARD_ALIGN] = {
+    [0 ... BOARD_ALIGN - 1] = BC_BARRIER
+};
+
+#define BYTES_01 0x0101010101010101ULL
+#define BYTES_7F 0x7f7f7f7f7f7f7f7fULL
+#define BYTES_80 0x8080808080808080ULL
+
+// true, wenn eines der 8 Bytes von word kein Code des Spielfelds ist:
+// größer als BC_BARRIER (Überlauf in Bit 7 nach Addition) oder
+// BC_USED_BY_WORM (Null-Byte nach XOR)
+static inline bool hasInvalidCode(uint64_t word)
+{
+    uint64_t above  = ((word & BYTES_7F) + (0x80 - BC_BARRIER - 1) * BYTES_01) | word;
+    uint64_t worm   = word ^ (BC_USED_BY_WORM * BYTES_01);
+    uint64_t isworm = (worm - BYTES_01) & ~worm;
+    return ((above | isworm) & BYTES_80) != 0;
+}
+
+// Prüft den kopierten Zellblock, bevor der Wurm darauf läuft: Rand und
+// Auffüllung nur Barrieren (memcmp() je Zeile gegen barrier_line; die
+// Auffüllung einer Zeile ist höchstens BOARD_ALIGN lang), im Feld nur
+// freie Zellen, Futter und Barrieren (8 Zellen je Vergleich), Startzelle
+// frei. Hashwert und Futteranzahl werden nicht nachgerechnet.
+static bool imageIsPlayable(struct board* aboard)
+{
+    const cell_t* cells = aboard->cells;
+    long stride = aboard->stride;
+    int rows = aboard->last_row + 1;
+    int cols = aboard->last_col + 1;
+    long tail = stride - cols - BOARD_BORDER;
+
+    for (long x = 0; x < stride; x += BOARD_ALIGN) {
+        if (memcmp(cells + x, barrier_line, BOARD_ALIGN) != 0 ||
+            memcmp(cells + (rows + BOARD_BORDER) * stride + x,
+                   barrier_line, BOARD_ALIGN) != 0) {
+            return false;
+        }
+    }
+
+    for (int y = BOARD_BORDER; y <= rows; y++) {
+        const cell_t* row = cells + y * stride;
+        int x = BOARD_BORDER;
+
+        if (row[0] != BC_BARRIER ||
+            memcmp(row + cols + BOARD_BORDER, barrier_line, tail) != 0) {
+            return false;
+        }
+
+        for (; x + 8 <= cols + BOARD_BORDER; x += 8) {
+            uint64_t word;
+            memcpy(&word, row + x, sizeof(word));
+            if (hasInvalidCode(word)) {
+                return false;
+            }
+        }
+        for (; x <= cols; x++) {
+            if (row[x] > BC_BARRIER || row[x] == BC_USED_BY_WORM) {
+                return false;
+            }
+        }
+    }
+
+    struct pos start = { aboard->last_row, 0 };
+    return getContentAt(aboard, start) == BC_FREE_CELL;
+}
+
+enum ResCodes loadLevel(struct board* aboard,
+                        struct renderer* arenderer,
+                        const struct levelFile* alf,
+                        int index)
+{
+    if (index < 0 || index >= alf->count) {
+        return RES_FAILED;
+    }
+
+    const struct levelEntry* entry = &alf->entries[index];
+
+    if (initializeBoardFromImage(aboard, arenderer, alf->rows, alf->cols,
+                                 alf->images + (size_t)index * alf->cells_bytes,
+                                 entry->hash, entry->food_items) != RES_OK ||
+        !imageIsPlayable(aboard)) {
+        return RES_FAILED;
+    }
+
+    setFoodSeed(aboard, FOOD_SEED, (uint64_t)index);
+
+    if (arenderer->has_output) {
+        renderBoard(aboard);
+    }
+    return RES_OK;
+}
+
+// ============================================================================
+//  writeLevelFile / compileLevels
+// ============================================================================
+
+// Kopf für count Level der Größe rows x cols: Abbilder ab
+// LEVEL_IMAGE_OFFSET, Tabelle direkt dahinter
+static void fillHeader(struct levelFileHeader* h, int rows, int cols,
+                       long cells_bytes, int count)
+{
+    memset(h, 0, sizeof(*h));
+    memcpy(h->magic, LEVEL_FILE_MAGIC, sizeof(h->magic));
+    h->version      = LEVEL_FILE_VERSION;
+    h->rows         = rows;
+    h->cols         = cols;
+    h->stride       = strideForCols(cols);
+    h->count        = count;
+    h->cells_bytes  = (uint64_t)cells_bytes;
+    h->image_offset = LEVEL_IMAGE_OFFSET;
+    h->entry_offset = LEVEL_IMAGE_OFFSET + (uint64_t)count * cells_bytes;
+}
+
+enum ResCodes writeLevelFile(const char* path, const struct levelFile* alf)
+{
+    uint8_t head[LEVEL_IMAGE_OFFSET] = {0};
+    struct levelFileHeader header;
+
+    FILE* out = fopen(path, "wb");
+    if (out == NULL) {
+        return RES_FAILED;
+    }
+
+    fillHeader(&header, alf->rows, alf->cols, alf->cells_bytes, alf->count);
+    memcpy(head, &header, sizeof(header));
+
+    fwrite(head, 1, sizeof(head), out);
+    fwrite(alf->images, alf->cells_bytes, alf->count, out);
+    fwrite(alf->entries, sizeof(struct levelEntry), alf->count, out);
+
+    bool failed = ferror(out) != 0;
+    if (fclose(out) != 0 || failed) {
+        remove(path);
+        return RES_FAILED;
+    }
+    return RES_OK;
+}
+
+// Vorgehen:
+//    - Platz für den Kopf schreiben (Nullen bis LEVEL_IMAGE_OFFSET)
+//    - jede Eingabe mit openLevelFile() lesen (Text oder auch ein anderes
+//      Paket), ihre Abbilder direkt anhängen, die Tabelle im Speicher sammeln
+//    - Tabelle anhängen, dann den fertigen Kopf an den Anfang schreiben
+//    Bei einem Fehler wird die halb geschriebene Ausgabe gelöscht.
+// ============================================================================
+
+enum ResCodes compileLevels(const char* out_path,
+                            char* const inputs[], int n,
+                            int* acount,
+                            const char** afailed,
+                            int* aline)
+{
+    static const uint8_t padding[LEVEL_IMAGE_OFFSET] = {0};
+    struct levelFileHeader header = {0};
+    struct levelEntry* entries = NULL;
+    int count = 0;
+    enum ResCodes res = RES_OK;
+
+    *acount  = 0;
+    *afailed = NULL;
+    *aline   = 0;
+
+    FILE* out = fopen(out_path, "wb");
+    if (out == NULL) {
+        *afailed = out_path;
+        return RES_FAILED;
+    }
+    fwrite(padding, 1, sizeof(padding), out);
+
+    for (int i = 0; i < n && res == RES_OK; i++) {
+        struct levelFile in = {0};
+
+        if (openLevelFile(&in, inputs[i]) != RES_OK) {
+            *afailed = inputs[i];
+            *aline   = in.error_line;
+            res = RES_FAILED;
+            break;
+        }
+
+        if (count > 0 && (in.rows != header.rows || in.cols != header.cols)) {
+            *afailed = inputs[i];
+            res = RES_FAILED;
+        } else {
+            header.rows        = in.rows;
+            header.cols        = in.cols;
+            header.cells_bytes = (uint64_t)in.cells_bytes;
+
+            struct levelEntry* grown = realloc(entries,
+                                               (size_t)(count + in.count) * sizeof(*entries));
+            if (grown == NULL) {
+                res = RES_FAILED;
+            } else {
+                entries = grown;
+                memcpy(entries + count, in.entries, in.count * sizeof(*entries));
+                fwrite(in.images, in.cells_bytes, in.count, out);
+                count += in.count;
+            }
+        }
+        closeLevelFile(&in);
+    }
+
+    if (res == RES_OK && count == 0) {
+        res = RES_FAILED;
+    }
+
+    if (res == RES_OK) {
+        fillHeader(&header, header.rows, header.cols,
+                   (long)header.cells_bytes, count);
+
+        fwrite(entries, sizeof(*entries), count, out);
+        rewind(out);
+        fwrite(&header, sizeof(header), 1, out);
+        if (ferror(out)) {
+            *afailed = out_path;
+            res = RES_FAILED;
+        }
+    }
+
+    if (fclose(out) != 0 && res == RES_OK) {
+        *afailed = out_path;
+        res = RES_FAILED;
+    }
+    if (res != RES_OK) {
+        remove(out_path);
+    }
+
+    free(entries);
+    *acount = (res == RES_OK) ? count : 0;
+    return res;
+}
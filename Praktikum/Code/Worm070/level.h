@@ -0,0 +1,161 @@
+// Worm070 - Aufgabenblatt 8
+// ============================================================================
+//  level.h – Level aus Dateien: Textformat und gemapptes Binärformat
+//
+//  Bisher baut initializeLevel() ein einziges Level aus festem Code auf.
+//  Dieses Modul liest Level aus Dateien, in zwei Formaten:
+//
+//  Textformat (von Hand editierbar):
+//
+//      ; Kommentarzeilen beginnen mit einem Semikolon
+//      size 26 70
+//      ......................................................................
+//      ...1..................#...............................................
+//      ...
+//
+//    Auf "size <rows> <cols>" folgen genau rows Zeilen mit je cols Zeichen:
+//
+//      .   freie Zelle        #   Barriere
+//      1   Futter Typ 1       2   Futter Typ 2       3   Futter Typ 3
+//
+//    Eine Datei darf mehrere Level hintereinander enthalten, alle in
+//    derselben Größe. Die Startzelle des Wurms (unten links) muss frei sein.
+//
+//  Binärformat (Level-Paket, erzeugt mit compileLevels() oder
+//  writeLevelFile()):
+//
+//      struct levelFileHeader         am Dateianfang
+//      Abbild 0, Abbild 1, ...        ab image_offset, je cells_bytes Bytes
+//      struct levelEntry[count]       ab entry_offset
+//
+//    Ein Abbild ist der Zellblock eines Boards im Speicherlayout von
+//    struct board (Rand, Zeilenabstand strideForCols(cols)). Die Datei wird
+//    mit mmap() eingeblendet; loadLevel() kopiert ein Abbild mit einem
+//    memcpy() nach cells und übernimmt Hashwert und Futteranzahl aus der
+//    Tabelle. Es wird nichts geparst, und nur die gespielten Level werden
+//    tatsächlich von der Platte gelesen. Headless-Läufe können so
+//    zehntausende Level reihum spielen, ohne dass der Levelaufbau zählt.
+//
+//    Die Abbilder beginnen auf vollen BOARD_ALIGN Bytes und sind ein
+//    Vielfaches davon lang, jedes liegt also wie cells auf Cache-Lines.
+//    Zahlen stehen in der Bytereihenfolge des Rechners; eine Datei von
+//    einem Rechner mit anderer Reihenfolge scheitert an der Versionsprüfung.
+//
+//  Vor dem Einsatz prüft loadLevel() das kopierte Abbild in einem Durchlauf
+//  (Rand aus Barrieren, nur gültige Codes, freie Startzelle), damit eine
+//  beschädigte Datei den Wurm nicht aus dem Speicherblock führt.
+// ============================================================================
+
+#ifndef _LEVEL_H
+#define _LEVEL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "worm.h"
+#include "board_model.h"
+#include "render.h"
+
+#define LEVEL_FILE_MAGIC   "WLVL"
+#define LEVEL_FILE_VERSION 1
+
+// ---------------------------------------------------------------------------
+//  Dateiformat
+// ---------------------------------------------------------------------------
+struct levelFileHeader {
+    char     magic[4];       // LEVEL_FILE_MAGIC
+    uint32_t version;        // LEVEL_FILE_VERSION
+    int32_t  rows;           // Größe aller Level der Datei
+    int32_t  cols;
+    int32_t  stride;         // strideForCols(cols)
+    int32_t  count;          // Anzahl der Level
+    uint64_t cells_bytes;    // Bytes je Abbild: (rows + 2) * stride
+    uint64_t image_offset;   // erstes Abbild, Vielfaches von BOARD_ALIGN
+    uint64_t entry_offset;   // Tabelle struct levelEntry[count]
+};
+
+struct levelEntry {
+    uint64_t hash;           // Zobrist-Hashwert des Abbilds (zobrist.h)
+    int32_t  food_items;     // Futterstücke im Abbild
+    int32_t  reserved;       // 0
+};
+
+// ---------------------------------------------------------------------------
+//  struct levelFile – geöffnete Level-Datei
+// ---------------------------------------------------------------------------
+// Binärdateien sind eingeblendet (mapped = true, map/map_size), die Zeiger
+// images und entries zeigen in die Einblendung. Textdateien werden beim
+// Öffnen in dieselbe Darstellung übersetzt; images und entries liegen dann
+// auf dem Heap. error_line nennt nach einem Fehler beim Lesen einer
+// Textdatei die Zeile (sonst 0).
+// ---------------------------------------------------------------------------
+struct levelFile {
+    int rows;
+    int cols;
+    int count;
+    long cells_bytes;
+
+    const cell_t* images;
+    const struct levelEntry* entries;
+
+    bool mapped;
+    void* map;
+    size_t map_size;
+
+    int error_line;
+};
+
+// ---------------------------------------------------------------------------
+//  openLevelFile / closeLevelFile
+// ---------------------------------------------------------------------------
+// Öffnet eine Level-Datei. Beginnt sie mit LEVEL_FILE_MAGIC, wird sie als
+// Level-Paket eingeblendet und nur der Kopf geprüft (Größen, Versätze,
+// Dateilänge); sonst wird sie als Textformat gelesen.
+// alf muss mit Nullen initialisiert sein. Liefert RES_OK oder RES_FAILED.
+// ---------------------------------------------------------------------------
+extern enum ResCodes openLevelFile(struct levelFile* alf, const char* path);
+
+extern void closeLevelFile(struct levelFile* alf);
+
+// ---------------------------------------------------------------------------
+//  loadLevel
+// ---------------------------------------------------------------------------
+// Baut Level index der Datei auf dem Board auf: initializeBoardFromImage()
+// mit dem Abbild (eine Kopie), Prüfung des Abbilds, Futter-Seed FOOD_SEED
+// mit Strom index (jedes Level hat seine eigene, feste Futterfolge). Ein
+// Renderer mit Ausgabe bekommt das ganze Feld über renderBoard().
+// Bitboard und Reach-Tracker hängt der Aufrufer danach an, wie nach
+// initializeLevel().
+// ---------------------------------------------------------------------------
+extern enum ResCodes loadLevel(struct board* aboard,
+                               struct renderer* arenderer,
+                               const struct levelFile* alf,
+                               int index);
+
+// ---------------------------------------------------------------------------
+//  writeLevelFile
+// ---------------------------------------------------------------------------
+// Schreibt alle Level von alf als Level-Paket nach path (z. B. vom
+// Generator erzeugte, siehe levelgen.h). Liefert RES_OK oder RES_FAILED;
+// eine halb geschriebene Datei wird gelöscht.
+// ---------------------------------------------------------------------------
+extern enum ResCodes writeLevelFile(const char* path, const struct levelFile* alf);
+
+// ---------------------------------------------------------------------------
+//  compileLevels
+// ---------------------------------------------------------------------------
+// Übersetzt die Textdateien inputs[0 .. n - 1] (beliebig viele Level je
+// Datei, alle gleich groß) in ein Level-Paket out_path. Die Abbilder
+// werden direkt geschrieben; im Speicher liegt jeweils nur eine
+// Eingabedatei. *acount erhält die Anzahl der Level. Bei einem Fehler
+// nennen *afailed die Eingabedatei und *aline die Zeile (0, wenn es nicht
+// an einer Zeile liegt).
+// ---------------------------------------------------------------------------
+extern enum ResCodes compileLevels(const char* out_path,
+                                   char* const inputs[], int n,
+                                   int* acount,
+                                   const char** afailed,
+                                   int* aline);
+
+#endif  // _LEVEL_H
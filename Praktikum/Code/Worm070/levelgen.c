@@ -0,0 +1,322 @@
+// Worm070 - Aufgabenblatt 8
+// ============================================================================
+//  Modul: levelgen.c  –  Zufällige Level auf allen Kernen
+// ============================================================================
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+
+#include "worm.h"
+#include "board_model.h"
+#include "render.h"
+#include "bitboard.h"
+#include "workpool.h"
+#include "rng.h"
+#include "timing.h"
+#include "level.h"
+#include "levelgen.h"
+
+// Freie Zellen am Start (unterste Zeile ab Spalte 0), damit der Wurm nach
+// rechts losfahren kann
+#define LEVELGEN_START_CLEAR 3
+
+// Versuche je Level, bevor es ohne Wände ausgeliefert wird
+#define LEVELGEN_MAX_TRIES 64
+
+// ============================================================================
+//  Generator eines Workers
+// ============================================================================
+
+struct levelGenerator {
+    struct board board;        // Arbeitsboard mit angehängtem Bitboard
+    struct bitboard bits;
+    cell_t* empty_cells;       // Vorlage: Feld frei, Rand aus Barrieren
+    uint64_t* empty_planes;    // Bitboard der Vorlage
+    uint64_t empty_hash;
+    uint64_t* reach;           // Ergebnis des Flood Fill
+    long cells_bytes;
+    long plane_bytes;
+    long retries;
+};
+
+// Gemeinsamer Auftrag für alle Worker; Pakete werden über next_chunk
+// vergeben.
+struct levelGenJob {
+    const struct levelGenParams* params;
+    struct rngStream base;
+    struct levelGenerator* gens;
+    cell_t* images;                // NULL: Level verwerfen
+    struct levelEntry* entries;
+    int count;
+    int chunks;
+    atomic_int next_chunk;
+};
+
+static void freeGenerator(struct levelGenerator* g)
+{
+    freeBoard(&g->board);
+    freeBitboard(&g->bits);
+    free(g->empty_cells);
+    free(g->empty_planes);
+    free(g->reach);
+    g->empty_cells  = NULL;
+    g->empty_planes = NULL;
+    g->reach        = NULL;
+}
+
+// Legt Board und Bitboard an und hält den leeren Zustand als Vorlage fest.
+static enum ResCodes initializeGenerator(struct levelGenerator* g,
+                                         int rows, int cols)
+{
+    if (initializeBoard(&g->board, getNullRenderer(), rows, cols) != RES_OK ||
+        initializeBitboard(&g->bits, rows, cols) != RES_OK) {
+        return RES_FAILED;
+    }
+
+    for (int y = 0; y < rows; y++) {
+        for (int x = 0; x < cols; x++) {
+            setContentAt(&g->board, (struct pos){ y, x }, BC_FREE_CELL);
+        }
+    }
+    if (attachBitboard(&g->board, &g->bits) != RES_OK) {
+        return RES_FAILED;
+    }
+
+    int words = bitboardPlaneWords(&g->bits);
+    g->cells_bytes = (long)(rows + 2 * BOARD_BORDER) * g->board.stride;
+    g->plane_bytes = (long)BP_COUNT * words * sizeof(uint64_t);
+
+    g->empty_cells  = malloc(g->cells_bytes);
+    g->empty_planes = malloc(g->plane_bytes);
+    g->reach        = malloc(words * sizeof(uint64_t));
+    if (g->empty_cells == NULL || g->empty_planes == NULL || g->reach == NULL) {
+        return RES_FAILED;
+    }
+
+    memcpy(g->empty_cells, g->board.cells, g->cells_bytes);
+    memcpy(g->empty_planes, g->bits.planes, g->plane_bytes);
+    g->empty_hash = g->board.hash;
+    g->retries = 0;
+    return RES_OK;
+}
+
+// ============================================================================
+//  Ein Level
+// ============================================================================
+
+static inline bool inStartZone(struct board* aboard, int y, int x)
+{
+    return y == aboard->last_row && x < LEVELGEN_START_CLEAR;
+}
+
+// Waagrechte oder senkrechte Wandstücke, am Feldrand abgeschnitten; die
+// Startzone bleibt frei.
+static void placeWalls(struct board* aboard, int walls, struct rngStream* arng)
+{
+    int rows = aboard->last_row + 1;
+    int cols = aboard->last_col + 1;
+
+    for (int i = 0; i < walls; i++) {
+        bool across = rngBelow(arng, 2) == 0;
+        int len = across ? 3 + (int)rngBelow(arng, cols / 3)
+                         : 3 + (int)rngBelow(arng, rows / 2);
+        int y = (int)rngBelow(arng, rows);
+        int x = (int)rngBelow(arng, cols);
+
+        for (int k = 0; k < len && y < rows && x < cols; k++) {
+            if (!inStartZone(aboard, y, x)) {
+                setContentAtIndex(aboard, posToCellIndex(aboard, (struct pos){ y, x }),
+                                  BC_BARRIER);
+            }
+            if (across) {
+                x++;
+            } else {
+                y++;
+            }
+        }
+    }
+}
+
+// Futter auf zufällige freie Zellen, die der Flood Fill erreicht hat.
+// Verwerfen statt Liste: mindestens die Hälfte der Zellen ist erreichbar.
+static int placeFood(struct levelGenerator* g, int food, struct rngStream* arng)
+{
+    struct board* b = &g->board;
+    int placed = 0;
+
+    for (int tries = 0; placed < food && tries < 64 * food; tries++) {
+        struct pos p = { (int)rngBelow(arng, b->last_row + 1),
+                         (int)rngBelow(arng, b->last_col + 1) };
+        cellidx_t idx = posToCellIndex(b, p);
+
+        if (((g->reach[idx >> 6] >> (idx & 63)) & 1) == 0 ||
+            b->cells[idx] != BC_FREE_CELL || inStartZone(b, p.y, p.x)) {
+            continue;
+        }
+        setContentAtIndex(b, idx, (enum BoardCodes)(BC_FOOD_1 + rngBelow(arng, 3)));
+        placed++;
+    }
+    return placed;
+}
+
+// ----------------------------------------------------------------------------
+//  generateOne
+// ----------------------------------------------------------------------------
+// Vorgehen:
+//    - Vorlage kopieren, Wände setzen, Flood Fill ab der Startzelle
+//    - weniger als die Hälfte der Zellen erreichbar: neue Wände (nach
+//      LEVELGEN_MAX_TRIES Versuchen ein Level ohne Wände)
+//    - Futter auf erreichbare Zellen, Abbild und Tabelleneintrag schreiben
+// ----------------------------------------------------------------------------
+static void generateOne(struct levelGenerator* g,
+                        const struct levelGenParams* aparams,
+                        struct rngStream* arng,
+                        cell_t* image,
+                        struct levelEntry* entry)
+{
+    struct board* b = &g->board;
+    struct pos start = { b->last_row, 0 };
+    int cells = (b->last_row + 1) * (b->last_col + 1);
+
+    for (int tries = 0; ; tries++) {
+        memcpy(b->cells, g->empty_cells, g->cells_bytes);
+        memcpy(g->bits.planes, g->empty_planes, g->plane_bytes);
+        b->hash = g->empty_hash;
+
+        if (tries < LEVELGEN_MAX_TRIES) {
+            placeWalls(b, aparams->walls, arng);
+        }
+        if (2 * floodFillFromPos(&g->bits, start, g->reach) >= cells) {
+            break;
+        }
+        g->retries++;
+    }
+
+    b->food_items = placeFood(g, aparams->food, arng);
+
+    if (image != NULL) {
+        memcpy(image, b->cells, g->cells_bytes);
+        entry->hash       = b->hash;
+        entry->food_items = b->food_items;
+        entry->reserved   = 0;
+    }
+}
+
+// Aufgabe im Thread-Pool: Pakete holen, bis alle vergeben sind. Level k
+// benutzt immer Strom k, egal welcher Worker es erzeugt.
+static void generateChunks(void* arg, int worker)
+{
+    struct levelGenJob* job = arg;
+    struct levelGenerator* g = &job->gens[worker];
+    int chunk;
+
+    while ((chunk = atomic_fetch_add(&job->next_chunk, 1)) < job->chunks) {
+        int first = chunk * LEVELGEN_CHUNK;
+        int last  = first + LEVELGEN_CHUNK < job->count ? first + LEVELGEN_CHUNK
+                                                        : job->count;
+
+        for (int k = first; k < last; k++) {
+            struct rngStream rng = splitRngStream(&job->base, (uint64_t)k);
+            generateOne(g, job->params, &rng,
+                        job->images != NULL ? job->images + (size_t)k * g->cells_bytes : NULL,
+                        job->entries != NULL ? &job->entries[k] : NULL);
+        }
+    }
+}
+
+// ============================================================================
+//  defaultLevelGenParams / generateLevels
+// ============================================================================
+
+void defaultLevelGenParams(struct levelGenParams* aparams, int rows, int cols)
+{
+    aparams->rows  = rows;
+    aparams->cols  = cols;
+    aparams->walls = rows * cols / 300;
+    aparams->food  = 10;
+    aparams->seed  = LEVELGEN_SEED;
+}
+
+enum ResCodes generateLevels(const struct levelGenParams* aparams,
+                             int count, int workers,
+                             struct levelFile* alf,
+                             struct levelGenStats* astats)
+{
+    struct levelGenJob job = {0};
+    struct workPool pool = {0};
+    long long start_ns;
+    enum ResCodes res = RES_OK;
+
+    if (count <= 0 || aparams->walls < 0 || aparams->food < 0) {
+        return RES_FAILED;
+    }
+    if (workers <= 0) {
+        workers = availableCores();
+    }
+
+    job.params = aparams;
+    job.count  = count;
+    job.chunks = (count + LEVELGEN_CHUNK - 1) / LEVELGEN_CHUNK;
+    job.gens   = calloc(workers, sizeof(struct levelGenerator));
+    atomic_init(&job.next_chunk, 0);
+    initRngStream(&job.base, aparams->seed, 0);
+
+    if (job.gens == NULL) {
+        return RES_FAILED;
+    }
+    for (int i = 0; i < workers && res == RES_OK; i++) {
+        res = initializeGenerator(&job.gens[i], aparams->rows, aparams->cols);
+    }
+
+    long cells_bytes = job.gens[0].cells_bytes;
+    if (res == RES_OK && alf != NULL) {
+        job.images  = malloc((size_t)count * cells_bytes);
+        job.entries = malloc((size_t)count * sizeof(struct levelEntry));
+        if (job.images == NULL || job.entries == NULL) {
+            res = RES_FAILED;
+        }
+    }
+
+    if (res == RES_OK && initializeWorkPool(&pool, workers) == RES_OK) {
+        start_ns = monotonicNowNs();
+        for (int i = 0; i < workers; i++) {
+            submitWorkTo(&pool, i, generateChunks, &job);
+        }
+        waitWorkPool(&pool);
+
+        astats->seconds = (monotonicNowNs() - start_ns) * 1e-9;
+        astats->levels  = count;
+        astats->workers = workers;
+        astats->retries = 0;
+        for (int i = 0; i < workers; i++) {
+            astats->retries += job.gens[i].retries;
+        }
+        freeWorkPool(&pool);
+    } else {
+        res = RES_FAILED;
+    }
+
+    for (int i = 0; i < workers; i++) {
+        freeGenerator(&job.gens[i]);
+    }
+    free(job.gens);
+
+    if (res != RES_OK) {
+        free(job.images);
+        free(job.entries);
+        return RES_FAILED;
+    }
+
+    if (alf != NULL) {
+        alf->rows        = aparams->rows;
+        alf->cols        = aparams->cols;
+        alf->count       = count;
+        alf->cells_bytes = cells_bytes;
+        alf->images      = job.images;
+        alf->entries     = job.entries;
+        alf->mapped      = false;
+        alf->error_line  = 0;
+    }
+    return RES_OK;
+}
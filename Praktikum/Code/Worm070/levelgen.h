@@ -0,0 +1,88 @@
+// Worm070 - Aufgabenblatt 8
+// ============================================================================
+//  levelgen.h – Zufällige Level in großer Zahl
+//
+//  Idee:
+//    Jedes Level besteht aus zufälligen waagrechten und senkrechten
+//    Wandstücken und Futter auf zufälligen freien Zellen, für jede
+//    Spielfeldgröße. Garantiert ist: Startzelle des Wurms (unten links,
+//    siehe startGame()) und jedes Futterstück sind gegenseitig erreichbar,
+//    mit der Bewegung in 8 Richtungen (setWormHeading()).
+//
+//  Vorgehen je Level:
+//    - Zellen und Bitboard aus einer leeren Vorlage kopieren (memcpy statt
+//      Aufbau Zelle für Zelle), Wände über setContentAtIndex() eintragen;
+//      Hashwert und Bitboard laufen dabei mit
+//    - Flood Fill auf dem Bitboard ab der Startzelle (floodFillFromPos(),
+//      64 Zellen je Wortoperation)
+//    - erreicht er weniger als die Hälfte der Zellen, wird das Level mit
+//      neuen Wänden wiederholt (Start eingesperrt, Feld zerschnitten)
+//    - Futter nur auf Zellen setzen, die der Flood Fill erreicht hat. Die
+//      8er-Nachbarschaft ist symmetrisch, alle diese Zellen liegen also in
+//      einer Zusammenhangskomponente mit dem Start; Futter ist betretbar
+//      und trennt nichts
+//
+//  Parallelität:
+//    Die Level werden in Pakete zu LEVELGEN_CHUNK aufgeteilt und vom
+//    Thread-Pool (workpool.h) auf alle Kerne verteilt. Jeder Worker hat
+//    eigenes Board, Bitboard und Vorlage. Level k zieht seine Zufallszahlen
+//    aus dem Strom splitRngStream(seed, k) (rng.h): das Ergebnis hängt
+//    weder von der Threadanzahl noch von der Reihenfolge ab.
+//
+//  Die Level landen im selben Format wie eine gelesene Level-Datei
+//  (struct levelFile, level.h), können also direkt gespielt oder mit
+//  writeLevelFile() als Level-Paket gespeichert werden.
+// ============================================================================
+
+#ifndef _LEVELGEN_H
+#define _LEVELGEN_H
+
+#include <stdint.h>
+
+#include "worm.h"
+#include "level.h"
+
+#define LEVELGEN_SEED  0x4c76476eULL
+#define LEVELGEN_CHUNK 256          // Level je Aufgabe im Thread-Pool
+
+// ---------------------------------------------------------------------------
+//  struct levelGenParams – Größe und Inhalt der Level
+// ---------------------------------------------------------------------------
+struct levelGenParams {
+    int rows;
+    int cols;
+    int walls;          // Wandstücke je Level
+    int food;           // Futterstücke je Level
+    uint64_t seed;      // Level k kommt aus Strom k zu seed
+};
+
+// ---------------------------------------------------------------------------
+//  struct levelGenStats – Ergebnis eines Laufs
+// ---------------------------------------------------------------------------
+struct levelGenStats {
+    long levels;        // erzeugte Level
+    long retries;       // verworfene Wandanordnungen
+    int workers;        // Threads
+    double seconds;     // Zeit für die Erzeugung (ohne Aufbau des Pools)
+};
+
+// Standardwerte für rows x cols: eine Wand je 300 Zellen, 10 Futterstücke,
+// Seed LEVELGEN_SEED.
+extern void defaultLevelGenParams(struct levelGenParams* aparams,
+                                  int rows, int cols);
+
+// ---------------------------------------------------------------------------
+//  generateLevels
+// ---------------------------------------------------------------------------
+// Erzeugt count Level auf workers Threads (workers <= 0: alle Prozessoren).
+// Ist alf nicht NULL, muss es mit Nullen initialisiert sein und enthält
+// danach die Level (freigeben mit closeLevelFile()); mit NULL werden die
+// Level nur erzeugt und verworfen (Durchsatzmessung).
+// RES_FAILED bei ungültiger Größe oder fehlendem Speicher.
+// ---------------------------------------------------------------------------
+extern enum ResCodes generateLevels(const struct levelGenParams* aparams,
+                                    int count, int workers,
+                                    struct levelFile* alf,
+                                    struct levelGenStats* astats);
+
+#endif  // _LEVELGEN_H
@@ -0,0 +1,513 @@
+// Worm070 - Aufgabenblatt 8
+// ============================================================================
+//  Modul: mcts.c  –  parallele Monte-Carlo-Baumsuche
+// ============================================================================
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "worm.h"
+#include "board_model.h"
+#include "worm_model.h"
+#include "render.h"
+#include "headless.h"
+#include "timing.h"
+#include "zobrist.h"
+#include "mcts.h"
+
+#define MCTS_SEED 0x6d637473ULL
+
+// ============================================================================
+//  Hilfsfunktionen
+// ============================================================================
+
+static inline bool isFood(cell_t code)
+{
+    return code >= BC_FOOD_1 && code <= BC_FOOD_3;
+}
+
+static inline bool isFree(cell_t code)
+{
+    return code != BC_BARRIER && code != BC_USED_BY_WORM;
+}
+
+static void resetNode(struct mctsNode* node)
+{
+    atomic_store_explicit(&node->visits, 0, memory_order_relaxed);
+    atomic_store_explicit(&node->children, MCTS_UNEXPANDED, memory_order_relaxed);
+    atomic_store_explicit(&node->value, 0, memory_order_relaxed);
+}
+
+// ============================================================================
+//  initializeMctsBot / freeMctsBot
+// ============================================================================
+
+enum ResCodes initializeMctsBot(struct mctsBot* abot,
+                                struct board* aboard,
+                                int workers)
+{
+    if (workers <= 0) {
+        workers = availableCores();
+    }
+
+    abot->nodes   = malloc(MCTS_MAX_NODES * sizeof(struct mctsNode));
+    abot->workers = calloc(workers, sizeof(struct mctsWorker));
+    if (abot->nodes == NULL || abot->workers == NULL) {
+        freeMctsBot(abot);
+        return RES_FAILED;
+    }
+    abot->worker_count = workers;
+    atomic_init(&abot->node_count, 0);
+
+    for (int i = 0; i < workers; i++) {
+        struct mctsWorker* w = &abot->workers[i];
+        if (initializeBoard(&w->board, getNullRenderer(),
+                            getLastRowOnBoard(aboard) + 1,
+                            getLastColOnBoard(aboard) + 1) != RES_OK) {
+            freeMctsBot(abot);
+            return RES_FAILED;
+        }
+    }
+
+    if (initializeWorkPool(&abot->pool, workers) != RES_OK) {
+        freeMctsBot(abot);
+        return RES_FAILED;
+    }
+    return RES_OK;
+}
+
+void freeMctsBot(struct mctsBot* abot)
+{
+    freeWorkPool(&abot->pool);
+
+    if (abot->workers != NULL) {
+        for (int i = 0; i < abot->worker_count; i++) {
+            freeWorm(&abot->workers[i].worm);
+            freeBoard(&abot->workers[i].board);
+        }
+    }
+    free(abot->workers);
+    free(abot->nodes);
+    free(abot->root);
+    free(abot->food);
+
+    abot->workers       = NULL;
+    abot->nodes         = NULL;
+    abot->root          = NULL;
+    abot->food          = NULL;
+    abot->food_capacity = 0;
+    abot->worker_count  = 0;
+    abot->root_capacity = 0;
+}
+
+// Sammelt die Futterzellen des Boards. Ohne Speicher bleibt die Liste
+// leer, der Bot bewertet dann nur Überleben und Wachstum.
+static void collectFood(struct mctsBot* abot, struct board* aboard)
+{
+    int count = getNumberOfFoodItems(aboard);
+
+    abot->food_count = 0;
+    if (count > abot->food_capacity) {
+        free(abot->food);
+        abot->food = malloc(count * sizeof(cellidx_t));
+        abot->food_capacity = (abot->food != NULL) ? count : 0;
+    }
+
+    const cell_t* cells = aboard->cells;
+    for (int y = 0; y <= aboard->last_row; y++) {
+        cellidx_t row = (cellidx_t)((y + BOARD_BORDER) * aboard->stride + BOARD_BORDER);
+        for (int x = 0; x <= aboard->last_col; x++) {
+            if (isFood(cells[row + x]) && abot->food_count < abot->food_capacity) {
+                abot->food[abot->food_count++] = row + x;
+            }
+        }
+    }
+}
+
+// Schachbrett-Abstand zweier Zellen (Züge ohne Hindernisse)
+static inline int cellDistance(struct board* aboard, cellidx_t a, cellidx_t b)
+{
+    int dy = abs((int)(a / aboard->stride) - (int)(b / aboard->stride));
+    int dx = abs((int)(a % aboard->stride) - (int)(b % aboard->stride));
+    return dy > dx ? dy : dx;
+}
+
+// Nächstes noch vorhandenes Futter der Wurzel und sein Abstand; ohne
+// Futter UNUSED_CELL_INDEX und eine Feldbreite
+static cellidx_t nearestFood(struct mctsBot* abot, struct board* aboard,
+                             cellidx_t head, int* adist)
+{
+    cellidx_t best = UNUSED_CELL_INDEX;
+    int best_dist = abot->span;
+
+    for (int k = 0; k < abot->food_count; k++) {
+        int d = cellDistance(aboard, head, abot->food[k]);
+        if (d < best_dist && isFood(aboard->cells[abot->food[k]])) {
+            best_dist = d;
+            best = abot->food[k];
+        }
+    }
+    *adist = best_dist;
+    return best;
+}
+
+// ============================================================================
+//  Eine Iteration: Auswahl, Expansion, Rollout, Rückgabe
+// ============================================================================
+
+// Legt die acht Kinder von node an. Nur der Worker, dessen compare-and-swap
+// gelingt, expandiert; die anderen rechnen ab diesem Knoten mit einem
+// Rollout weiter. Liefert das erste Kind oder -1.
+static int expandNode(struct mctsBot* abot, struct mctsNode* node)
+{
+    int expected = MCTS_UNEXPANDED;
+
+    if (atomic_load_explicit(&abot->node_count, memory_order_relaxed)
+            + WORM_HEADINGS > MCTS_MAX_NODES ||
+        !atomic_compare_exchange_strong(&node->children, &expected,
+                                        MCTS_EXPANDING)) {
+        return -1;
+    }
+
+    long first = atomic_fetch_add(&abot->node_count, WORM_HEADINGS);
+    if (first + WORM_HEADINGS > MCTS_MAX_NODES) {
+        // Block voll: Knoten bleibt ein Blatt
+        atomic_store(&node->children, MCTS_UNEXPANDED);
+        return -1;
+    }
+
+    for (int dir = 0; dir < WORM_HEADINGS; dir++) {
+        resetNode(&abot->nodes[first + dir]);
+    }
+    atomic_store_explicit(&node->children, (int)first, memory_order_release);
+    return (int)first;
+}
+
+// UCT: mittlere Bewertung plus Erkundungsterm. Unbesuchte Kinder zuerst;
+// bei Gleichstand entscheidet der zufällige Startpunkt.
+static int selectChild(struct mctsBot* abot, struct mctsNode* node,
+                       int first, struct rngStream* rng)
+{
+    int parent_visits = atomic_load_explicit(&node->visits, memory_order_relaxed);
+    double log_n = log(parent_visits > 1 ? parent_visits : 1);
+    unsigned int start = rngBelow(rng, WORM_HEADINGS);
+    int best = (int)start;
+    double best_score = -1.0;
+
+    for (unsigned int k = 0; k < WORM_HEADINGS; k++) {
+        int dir = (int)((start + k) % WORM_HEADINGS);
+        struct mctsNode* child = &abot->nodes[first + dir];
+        int n = atomic_load_explicit(&child->visits, memory_order_relaxed);
+
+        if (n <= 0) {
+            return dir;
+        }
+
+        double q = atomic_load_explicit(&child->value, memory_order_relaxed)
+                 / ((double)MCTS_VALUE_SCALE * n);
+        double score = q + MCTS_EXPLORATION * sqrt(log_n / n);
+        if (score > best_score) {
+            best_score = score;
+            best = dir;
+        }
+    }
+    return best;
+}
+
+// Zug für den Rollout: Futter direkt daneben wird gefressen; sonst meist
+// die freie Richtung, die dem Ziel (nächstes Futter beim Start des
+// Rollouts) am nächsten kommt, ab und zu geradeaus oder eine zufällige
+// freie Richtung.
+static enum WormHeading rolloutMove(struct mctsWorker* w, cellidx_t target)
+{
+    const cell_t* cells = w->board.cells;
+    cellidx_t head = getWormHeadCell(&w->worm);
+    enum WormHeading free_dirs[WORM_HEADINGS];
+    int count = 0;
+
+    for (int dir = 0; dir < WORM_HEADINGS; dir++) {
+        cell_t code = cells[head + w->board.dir_offset[dir]];
+        if (isFood(code)) {
+            return (enum WormHeading)dir;
+        }
+        if (isFree(code)) {
+            free_dirs[count++] = (enum WormHeading)dir;
+        }
+    }
+
+    if (count == 0) {
+        return w->worm.heading;
+    }
+    if (target != UNUSED_CELL_INDEX && rngBelow(&w->rng, 4) != 0) {
+        enum WormHeading best = free_dirs[0];
+        int best_dist = cellDistance(&w->board, head + w->board.dir_offset[best], target);
+        for (int k = 1; k < count; k++) {
+            int d = cellDistance(&w->board,
+                                 head + w->board.dir_offset[free_dirs[k]], target);
+            if (d < best_dist) {
+                best_dist = d;
+                best = free_dirs[k];
+            }
+        }
+        return best;
+    }
+    if (isFree(cells[head + w->board.dir_offset[w->worm.heading]]) &&
+        rngBelow(&w->rng, 4) != 0) {
+        return w->worm.heading;
+    }
+    return free_dirs[rngBelow(&w->rng, (uint32_t)count)];
+}
+
+// ----------------------------------------------------------------------------
+// Vorgehen:
+//    - Spielkopie auf den Wurzelzustand setzen
+//    - absteigen: Virtual Loss auf jeden gewählten Knoten, Zug ausführen;
+//      Schluss bei Spielende, an einem frisch expandierten Knoten (ein
+//      Zug in eines seiner Kinder) oder an einem Blatt
+//    - Rollout bis MCTS_ROLLOUT_DEPTH Züge ab der Wurzel
+//    - Bewertung auf dem Pfad addieren, Virtual Loss zurücknehmen
+// ----------------------------------------------------------------------------
+static void runIteration(struct mctsBot* abot, struct mctsWorker* w)
+{
+    enum GameStates state;
+    int path[MCTS_MAX_TREE_DEPTH + 1];
+    int depth = 0;
+    int steps = 0;
+    int fed_at = MCTS_ROLLOUT_DEPTH;    // Schritt des ersten Futters
+
+    if (restoreGame(&w->board, &w->worm, &state, abot->root, NULL) != RES_OK) {
+        return;
+    }
+
+    path[0] = 0;
+    atomic_fetch_add_explicit(&abot->nodes[0].visits, MCTS_VIRTUAL_LOSS,
+                              memory_order_relaxed);
+
+    while (depth < MCTS_MAX_TREE_DEPTH) {
+        struct mctsNode* node = &abot->nodes[path[depth]];
+        int first = atomic_load_explicit(&node->children, memory_order_acquire);
+        bool leaf = false;
+
+        if (first < 0) {
+            if (first != MCTS_UNEXPANDED ||
+                (first = expandNode(abot, node)) < 0) {
+                break;
+            }
+            leaf = true;
+        }
+
+        int dir = selectChild(abot, node, first, &w->rng);
+        path[++depth] = first + dir;
+        atomic_fetch_add_explicit(&abot->nodes[first + dir].visits,
+                                  MCTS_VIRTUAL_LOSS, memory_order_relaxed);
+
+        setWormHeading(&w->worm, (enum WormHeading)dir);
+        state = stepHeadlessGame(&w->board, &w->worm);
+        steps++;
+        if (fed_at == MCTS_ROLLOUT_DEPTH && w->board.food_eaten != abot->root->food_eaten) {
+            fed_at = steps;
+        }
+
+        if (state != WORM_GAME_ONGOING || leaf) {
+            break;
+        }
+    }
+
+    int dist;
+    cellidx_t target = nearestFood(abot, &w->board,
+                                   getWormHeadCell(&w->worm), &dist);
+
+    while (state == WORM_GAME_ONGOING && steps < MCTS_ROLLOUT_DEPTH) {
+        setWormHeading(&w->worm, rolloutMove(w, target));
+        state = stepHeadlessGame(&w->board, &w->worm);
+        steps++;
+        if (fed_at == MCTS_ROLLOUT_DEPTH && w->board.food_eaten != abot->root->food_eaten) {
+            fed_at = steps;
+        }
+    }
+
+    double reward;
+    if (state != WORM_GAME_ONGOING) {
+        int survived = steps - 1 < MCTS_ROLLOUT_DEPTH ? steps - 1 : MCTS_ROLLOUT_DEPTH;
+        reward = MCTS_DEATH_VALUE * survived / MCTS_ROLLOUT_DEPTH;
+    } else {
+        double growth = (double)(getWormLength(&w->worm) - abot->root_size)
+                      / MCTS_GROWTH_SCALE;
+        double early = 1.0 - MCTS_FEED_DECAY * fed_at / MCTS_ROLLOUT_DEPTH;
+        reward = 0.5 + MCTS_GROWTH_WEIGHT * (growth < 1.0 ? growth : 1.0) * early;
+        // Wer gefressen hat, war am Futter; neues Futter liegt zufällig
+        double closeness = 1.0;
+        if (fed_at == MCTS_ROLLOUT_DEPTH) {
+            nearestFood(abot, &w->board, getWormHeadCell(&w->worm), &dist);
+            closeness = 1.0 - (double)dist / abot->span;
+        }
+        reward += (0.5 - MCTS_GROWTH_WEIGHT) * closeness;
+    }
+
+    long long value = (long long)(reward * MCTS_VALUE_SCALE);
+    for (int k = 0; k <= depth; k++) {
+        struct mctsNode* node = &abot->nodes[path[k]];
+        atomic_fetch_add_explicit(&node->value, value, memory_order_relaxed);
+        atomic_fetch_add_explicit(&node->visits, 1 - MCTS_VIRTUAL_LOSS,
+                                  memory_order_relaxed);
+    }
+}
+
+// Aufgabe im Pool: MCTS_CHUNK Iterationen, danach neu einstellen, solange
+// das Zeitbudget reicht. Die Fortsetzung landet in der eigenen Schlange,
+// kann aber von einem untätigen Worker gestohlen werden.
+static void mctsChunk(void* arg, int worker)
+{
+    struct mctsBot* abot = arg;
+    struct mctsWorker* w = &abot->workers[worker];
+
+    // Eigener Strom pro Paket, nummeriert in der Reihenfolge der Vergabe
+    w->rng = splitRngStream(&abot->rng,
+                            (uint64_t)atomic_fetch_add_explicit(&abot->chunks, 1,
+                                                                memory_order_relaxed));
+    for (int k = 0; k < MCTS_CHUNK; k++) {
+        runIteration(abot, w);
+    }
+    w->rollouts += MCTS_CHUNK;
+
+    if (monotonicNowNs() < abot->deadline_ns) {
+        submitWorkTo(&abot->pool, worker, mctsChunk, abot);
+    }
+}
+
+// ============================================================================
+//  planMcts
+// ============================================================================
+
+enum WormHeading planMcts(struct mctsBot* abot,
+                          struct board* aboard,
+                          struct worm* aworm,
+                          long long budget_ns,
+                          struct mctsStats* astats)
+{
+    long long t0 = monotonicNowNs();
+    size_t need = snapshotSize(aboard, aworm);
+
+    if (need > abot->root_capacity) {
+        free(abot->root);
+        abot->root = malloc(need);
+        abot->root_capacity = (abot->root != NULL) ? need : 0;
+    }
+    if (abot->root == NULL ||
+        snapshotGame(aboard, aworm, WORM_GAME_ONGOING, NULL,
+                     abot->root, abot->root_capacity) != RES_OK) {
+        return aworm->heading;
+    }
+
+    abot->root_size = getWormLength(aworm);
+    abot->span = aboard->last_row > aboard->last_col
+               ? aboard->last_row + 1 : aboard->last_col + 1;
+    collectFood(abot, aboard);
+    resetNode(&abot->nodes[0]);
+    atomic_store(&abot->node_count, 1);
+    atomic_store(&abot->chunks, 0);
+    initRngStream(&abot->rng, MCTS_SEED, gameHash(aboard, aworm));
+    abot->deadline_ns = t0 + budget_ns;
+
+    for (int i = 0; i < abot->worker_count; i++) {
+        abot->workers[i].rollouts = 0;
+    }
+    for (int i = 0; i < abot->worker_count; i++) {
+        submitWorkTo(&abot->pool, i, mctsChunk, abot);
+    }
+    waitWorkPool(&abot->pool);
+
+    // Meistbesuchtes Wurzelkind; ohne Kinder bleibt die Richtung
+    enum WormHeading best = aworm->heading;
+    int best_visits = 0;
+    long long best_value = 0;
+    int first = atomic_load(&abot->nodes[0].children);
+
+    if (first >= 0) {
+        for (int dir = 0; dir < WORM_HEADINGS; dir++) {
+            struct mctsNode* child = &abot->nodes[first + dir];
+            int n = atomic_load(&child->visits);
+            if (n > best_visits) {
+                best_visits = n;
+                best_value  = atomic_load(&child->value);
+                best        = (enum WormHeading)dir;
+            }
+        }
+    }
+
+    if (astats != NULL) {
+        astats->rollouts = 0;
+        for (int i = 0; i < abot->worker_count; i++) {
+            astats->rollouts += abot->workers[i].rollouts;
+        }
+        astats->nodes       = atomic_load(&abot->node_count);
+        astats->workers     = abot->worker_count;
+        astats->seconds     = (monotonicNowNs() - t0) * 1e-9;
+        astats->best_visits = best_visits;
+        astats->best_value  = best_visits > 0
+                            ? (double)best_value / MCTS_VALUE_SCALE / best_visits
+                            : 0.0;
+    }
+    return best;
+}
+
+// ============================================================================
+//  runMctsBenchmark
+// ============================================================================
+
+// Spielschleife des Benchmarks; Board, Wurm und Bot sind angelegt.
+static enum ResCodes benchmarkLoop(long ticks, int rows, int cols,
+                                   struct board* aboard,
+                                   struct worm* aworm,
+                                   struct mctsBot* abot,
+                                   struct mctsBench* abench)
+{
+    while (abench->ticks < ticks) {
+        struct mctsStats stats;
+
+        setWormHeading(aworm, planMcts(abot, aboard, aworm,
+                                       mctsBudgetNs(), &stats));
+        abench->rollouts     += stats.rollouts;
+        abench->plan_seconds += stats.seconds;
+        if (stats.seconds > abench->max_plan_seconds) {
+            abench->max_plan_seconds = stats.seconds;
+        }
+
+        long food_before = aboard->food_eaten;
+        enum GameStates game_state = stepHeadlessGame(aboard, aworm);
+        abench->food += aboard->food_eaten - food_before;
+        abench->ticks++;
+
+        if (game_state != WORM_GAME_ONGOING) {
+            abench->games++;
+            if (startHeadlessGame(aboard, aworm, rows, cols) != RES_OK) {
+                return RES_FAILED;
+            }
+        }
+    }
+    return RES_OK;
+}
+
+enum ResCodes runMctsBenchmark(long ticks, int rows, int cols,
+                               int workers,
+                               struct mctsBench* abench)
+{
+    struct board theBoard = {0};
+    struct worm  theWorm  = {0};
+    struct mctsBot bot    = {0};
+    enum ResCodes res = RES_FAILED;
+
+    memset(abench, 0, sizeof(*abench));
+
+    if (startHeadlessGame(&theBoard, &theWorm, rows, cols) == RES_OK &&
+        initializeMctsBot(&bot, &theBoard, workers) == RES_OK) {
+        abench->workers = bot.worker_count;
+        res = benchmarkLoop(ticks, rows, cols, &theBoard, &theWorm, &bot, abench);
+    }
+
+    freeMctsBot(&bot);
+    freeWorm(&theWorm);
+    freeBoard(&theBoard);
+    return res;
+}
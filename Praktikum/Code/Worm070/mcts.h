@@ -0,0 +1,187 @@
+// Worm070 - Aufgabenblatt 8
+// ============================================================================
+//  mcts.h – Planungs-Bot mit paralleler Monte-Carlo-Baumsuche (MCTS)
+//
+//  Ablauf einer Planung (planMcts):
+//    - Der aktuelle Spielzustand wird als Snapshot (snapshot.h) gesichert.
+//    - Alle Worker des Thread-Pools (workpool.h) arbeiten am selben Baum.
+//      Jeder Worker besitzt eine eigene Kopie von Board und Wurm und setzt
+//      sie vor jeder Iteration mit restoreGame() auf den Wurzelzustand.
+//    - Eine Iteration:
+//        Auswahl     ab der Wurzel per UCT ein Kind wählen und den Zug
+//                    (eine der acht Richtungen) auf der Kopie ausführen
+//        Expansion   am ersten nicht expandierten Knoten die acht Kinder
+//                    anlegen (nur ein Worker gewinnt, siehe unten)
+//        Rollout     bis zu MCTS_ROLLOUT_DEPTH Züge ab der Wurzel mit den
+//                    normalen Spielregeln (moveWorm(), Futterboni
+//                    BONUS_1..3, Spielende aus enum GameStates); die Züge
+//                    sind zufällig, meist aber auf das nächste Futter zu
+//        Rückgabe    Bewertung entlang des Pfades aufsummieren
+//    - Nach Ablauf des Zeitbudgets wird die Richtung des meistbesuchten
+//      Wurzelkinds gewählt.
+//
+//  Bewertung (0 .. 1):
+//    Spielende         0 .. MCTS_DEATH_VALUE, je länger überlebt desto höher
+//    überlebt          0.5 + MCTS_GROWTH_WEIGHT * min(1, Wachstum / MCTS_GROWTH_SCALE)
+//                              * (1 - MCTS_FEED_DECAY * Schritt des ersten
+//                                     Futters / MCTS_ROLLOUT_DEPTH)
+//                          + (0.5 - MCTS_GROWTH_WEIGHT) * Nähe zum Futter
+//    Der Abschlag für spätes Fressen verhindert, dass der Wurm neben dem
+//    Futter kreist: Fressen im nächsten Zug zählt mehr als ein paar Züge
+//    später. Die Nähe (1 am Futter, 0 eine Feldbreite entfernt) lenkt den
+//    Wurm zu Futter, das weiter entfernt liegt, als ein Rollout reicht.
+//    Gemessen wird zum nächsten Futter, das an der Wurzel auf dem Board
+//    lag; hat der Rollout gefressen, ist die Nähe 1 (neues Futter
+//    erscheint zufällig und ist nicht in der Liste).
+//
+//  Parallelität:
+//    - Besuche, Wertsumme und Kinderindex der Knoten sind Atomics, es gibt
+//      keine Sperren im Baum.
+//    - Virtual Loss: Ein Worker, der einen Knoten auswählt, zählt sofort
+//      MCTS_VIRTUAL_LOSS Besuche ohne Wert dazu. Der Knoten sieht für die
+//      anderen Worker vorübergehend schlechter aus, sie verteilen sich auf
+//      andere Zweige. Bei der Rückgabe wird der Verlust wieder abgezogen.
+//    - Expansion per compare-and-swap von MCTS_UNEXPANDED auf
+//      MCTS_EXPANDING; die acht Kinder kommen aus einem vorab angelegten
+//      Knotenblock (atomarer Zähler, kein malloc während der Suche).
+//    - Die Iterationen laufen in Paketen zu MCTS_CHUNK als Aufgaben im
+//      Work-Stealing-Pool; jedes Paket stellt sich selbst neu ein, solange
+//      das Zeitbudget reicht.
+//    - Zufall (rng.h): Die Planung leitet ihren Strom aus dem Hashwert des
+//      Wurzelzustands ab, jedes Paket zieht aus einem eigenen Kinderstrom
+//      (Nummer = Reihenfolge der Vergabe). Die Rollouts eines Pakets sind
+//      damit reproduzierbar; welcher Baum entsteht, hängt bei Zeitbudget
+//      und mehreren Workern trotzdem von der Verteilung der Pakete ab.
+//
+//  Zeitbudget:
+//    MCTS_BUDGET_PERCENT Prozent von NAP_TIME pro Spieltakt; der Rest
+//    bleibt für Spielschritt und Ausgabe. Überzogen wird höchstens um die
+//    Dauer eines Pakets.
+//
+//  Die Spielkopien werden vor jeder Iteration komplett zurückgesetzt; der
+//  Aufwand wächst also mit der Feldgröße. Gedacht ist der Bot für die
+//  üblichen Spielfelder (bis einige hundert Zellen Kantenlänge).
+// ============================================================================
+
+#ifndef _MCTS_H
+#define _MCTS_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include "worm.h"
+#include "board_model.h"
+#include "worm_model.h"
+#include "snapshot.h"
+#include "workpool.h"
+#include "rng.h"
+
+#define MCTS_BUDGET_PERCENT 70
+#define MCTS_MAX_NODES      (1 << 21)
+#define MCTS_CHUNK          16
+#define MCTS_ROLLOUT_DEPTH  32
+#define MCTS_MAX_TREE_DEPTH 64
+#define MCTS_VIRTUAL_LOSS   3
+#define MCTS_VALUE_SCALE    1000000     // Werte als Festkomma
+#define MCTS_DEATH_VALUE    0.4
+#define MCTS_GROWTH_SCALE   (2 * BONUS_3)
+#define MCTS_GROWTH_WEIGHT  0.35
+#define MCTS_FEED_DECAY     0.5         // Abschlag für spätes Fressen
+#define MCTS_EXPLORATION    1.0
+
+// Besondere Werte für mctsNode.children
+#define MCTS_UNEXPANDED (-1)
+#define MCTS_EXPANDING  (-2)
+
+// ---------------------------------------------------------------------------
+//  Knoten des Suchbaums (16 Byte). Das Kind für Richtung dir eines Knotens
+//  mit children = c ist nodes[c + dir].
+// ---------------------------------------------------------------------------
+struct mctsNode {
+    atomic_int visits;          // Besuche inklusive Virtual Loss
+    atomic_int children;        // erstes Kind oder MCTS_UNEXPANDED/_EXPANDING
+    atomic_llong value;         // Summe der Bewertungen * MCTS_VALUE_SCALE
+};
+
+// Daten eines Workers: eigene Spielkopie und Zufallsstrom des Pakets
+struct mctsWorker {
+    struct board board;
+    struct worm worm;
+    struct rngStream rng;
+    long rollouts;              // in der laufenden Planung
+    char pad[64];               // getrennte Cache-Lines für die Zähler
+};
+
+struct mctsStats {
+    long rollouts;              // Iterationen aller Worker
+    long nodes;                 // angelegte Knoten
+    int workers;
+    double seconds;             // Dauer der Planung
+    int best_visits;            // Besuche des gewählten Wurzelkinds
+    double best_value;          // mittlere Bewertung des gewählten Kinds
+};
+
+struct mctsBot {
+    struct workPool pool;
+    struct mctsWorker* workers;
+    int worker_count;
+
+    struct mctsNode* nodes;     // Knotenblock, nodes[0] ist die Wurzel
+    atomic_long node_count;
+
+    struct rngStream rng;       // Strom der Planung (aus dem Wurzelzustand)
+    atomic_long chunks;         // vergebene Pakete (Nummer des Kinderstroms)
+
+    struct gameSnapshot* root;  // Wurzelzustand der laufenden Planung
+    size_t root_capacity;
+    int root_size;              // Länge + ausstehendes Wachstum an der Wurzel
+    cellidx_t* food;            // Futterzellen an der Wurzel
+    int food_count;
+    int food_capacity;
+    int span;                   // längere Feldseite (Abstand ohne Futter)
+
+    long long deadline_ns;      // Ende des Zeitbudgets (monotone Uhr)
+};
+
+// Startet workers Threads (<= 0: alle Prozessoren) und legt Spielkopien in
+// der Größe von aboard an. Vor dem ersten Aufruf mit Nullen initialisieren.
+// RES_FAILED ohne Speicher oder Threads.
+extern enum ResCodes initializeMctsBot(struct mctsBot* abot,
+                                       struct board* aboard,
+                                       int workers);
+
+extern void freeMctsBot(struct mctsBot* abot);
+
+// Plant einen Zug für den aktuellen Zustand innerhalb von budget_ns
+// Nanosekunden (z. B. mctsBudgetNs()). Board und Wurm werden nicht
+// verändert. Liefert die gewählte Richtung; astats darf NULL sein.
+extern enum WormHeading planMcts(struct mctsBot* abot,
+                                 struct board* aboard,
+                                 struct worm* aworm,
+                                 long long budget_ns,
+                                 struct mctsStats* astats);
+
+// Zeitbudget pro Spieltakt: MCTS_BUDGET_PERCENT von NAP_TIME.
+static inline long long mctsBudgetNs(void)
+{
+    return (long long)NAP_TIME * 1000000LL * MCTS_BUDGET_PERCENT / 100;
+}
+
+// ---------------------------------------------------------------------------
+//  Durchsatzmessung: ticks Spielschritte headless mit dem Bot, je Schritt
+//  ein volles Zeitbudget. Beendete Spiele werden neu gestartet.
+// ---------------------------------------------------------------------------
+struct mctsBench {
+    long ticks;
+    long games;
+    long food;
+    long rollouts;
+    int workers;
+    double plan_seconds;        // Summe der Planungszeit
+    double max_plan_seconds;    // längste Planung (Budget eingehalten?)
+};
+
+extern enum ResCodes runMctsBenchmark(long ticks, int rows, int cols,
+                                      int workers,
+                                      struct mctsBench* abench);
+
+#endif  // _MCTS_H
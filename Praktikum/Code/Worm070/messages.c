@@ -1,12 +1,66 @@
 // Worm070 - Aufgabenblatt 8
 // =======================================================================
 #include <curses.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
 
 #include "worm.h"
 #include "board_model.h"
 #include "worm_model.h"
 #include "messages.h"
 
+// ---------------------------------------------------------------------------
+// Zwischenspeicher der Statuszeilen
+//
+// text ist der Stand der Zeile auf dem Bildschirm, values die Zahlen darin.
+// line < 0 heißt: der Stand ist unbekannt (noch nie gezeichnet, Zeile
+// gelöscht), die Zeile wird beim nächsten Mal vollständig ausgegeben.
+// Die Felder der Vorlage sind die Folgen von '_'; ihre Breite ist die
+// Feldbreite, die Zahlen stehen rechtsbündig darin. Ein Punkt innerhalb
+// eines Felds ("__.__") ist das Komma: der Wert zählt dann in Einheiten
+// der letzten Stelle (hier Hundertstel).
+// ---------------------------------------------------------------------------
+#define STATUS_TEMPLATE \
+    "Position des Wurms: y = ___   x = ___   Segmente: ____   Futterbrocken: ___"
+
+#define TIMING_TEMPLATE \
+    "Jitter ms: __.__/__.__/___.__  Overruns: _____ (verw. ____)  Frameskip: _____"
+
+#define LINE_FIELDS 8
+#define LINE_TEXT   96
+
+enum StatusFields {
+    SF_HEAD_Y,
+    SF_HEAD_X,
+    SF_LENGTH,
+    SF_FOOD,
+    SF_COUNT
+};
+
+enum TimingFields {
+    TF_JITTER_LAST,
+    TF_JITTER_AVG,
+    TF_JITTER_MAX,
+    TF_OVERRUNS,
+    TF_DROPPED,
+    TF_FRAMESKIP,
+    TF_COUNT
+};
+
+struct cachedLine {
+    const char* tmpl;
+    int line;
+    long values[LINE_FIELDS];
+    int offset[LINE_FIELDS];
+    int width[LINE_FIELDS];
+    int decimals[LINE_FIELDS];
+    char text[LINE_TEXT];
+};
+
+static struct cachedLine status = { .tmpl = STATUS_TEMPLATE, .line = -1 };
+static struct cachedLine timing = { .tmpl = TIMING_TEMPLATE, .line = -1 };
+
 // ---------------------------------------------------------------------------
 // Eine komplette Zeile im Nachrichtenbereich löschen
 // ---------------------------------------------------------------------------
@@ -15,6 +69,12 @@ void clearLineInMessageArea(int row) {
     for (int i = 0; i < COLS; i++) {
         addch(' ');
     }
+    if (row == status.line) {
+        status.line = -1;
+    }
+    if (row == timing.line) {
+        timing.line = -1;
+    }
 }
 
 // ---------------------------------------------------------------------------
@@ -37,30 +97,211 @@ void showBorderLine(void) {
 // Problem vorher:
 //  - Wenn sich die Anzahl der Futterbrocken oder die Länge des Wurms
 //    von zweistellig auf einstellig ändert, bleiben alte Zeichen stehen.
+//    Deshalb wurde die Zeile in jedem Frame gelöscht (COLS Aufrufe von
+//    addch) und mit mvprintw komplett neu ausgegeben.
 // Lösung:
-//  - Zeile vor der Ausgabe komplett löschen.
+//  - feste Feldbreiten in einer Vorlage, Zahlen von Hand rechtsbündig
+//    eingesetzt (kein Auswerten eines Formatstrings)
+//  - nur geänderte Felder werden formatiert und davon nur die Zeichen
+//    ausgegeben, die sich vom Stand auf dem Bildschirm unterscheiden
 // ---------------------------------------------------------------------------
-void showStatus(struct board* aboard, struct worm* aworm) {
 
-    int line = LINES - ROWS_RESERVED + 2;
+// Schreibt value rechtsbündig in width Zeichen, mit decimals Stellen
+// hinter dem Punkt; passt die Zahl nicht, wird das Feld mit '*' gefüllt.
+static void formatField(char* field, int width, int decimals, long value)
+{
+    int i = width;
+    bool negative = value < 0;
+    unsigned long v = negative ? -(unsigned long)value : (unsigned long)value;
+    int digits = 0;
+
+    do {
+        field[--i] = (char)('0' + v % 10);
+        v /= 10;
+        if (++digits == decimals && i > 0) {
+            field[--i] = '.';
+        }
+    } while ((v > 0 || digits <= decimals) && i > 0);
+
+    if (negative && i > 0) {
+        field[--i] = '-';
+    } else if (negative || v > 0 || digits <= decimals) {
+        memset(field, '*', width);
+        return;
+    }
+    memset(field, ' ', i);
+}
+
+// Vorlage übernehmen und die Felder darin suchen
+static void resetLineText(struct cachedLine* acl)
+{
+    int f = 0;
+
+    strncpy(acl->text, acl->tmpl, LINE_TEXT - 1);
+    acl->text[LINE_TEXT - 1] = '\0';
+    for (int i = 0; acl->text[i] != '\0' && f < LINE_FIELDS; i++) {
+        if (acl->text[i] == '_' && (i == 0 || acl->text[i - 1] != '_')) {
+            int width = (int)strspn(acl->text + i, "_.");
+            const char* point = memchr(acl->text + i, '.', width);
+
+            acl->offset[f]   = i;
+            acl->width[f]    = width;
+            acl->decimals[f] = point != NULL
+                             ? width - (int)(point - (acl->text + i)) - 1 : 0;
+            i += width - 1;
+            f++;
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// showCachedLine
+//
+// Gibt values[0 .. n - 1] in der Zeile line aus: ist der Stand unbekannt,
+// wird die Zeile gelöscht und vollständig ausgegeben; sonst werden nur
+// geänderte Felder formatiert und davon nur die Zeichen ausgegeben, die
+// sich vom Stand auf dem Bildschirm unterscheiden.
+// ---------------------------------------------------------------------------
+static void showCachedLine(struct cachedLine* acl, int line,
+                           const long* values, int n)
+{
+    // Stand unbekannt: Zeile löschen und vollständig ausgeben
+    if (acl->line != line) {
+        resetLineText(acl);
+        for (int f = 0; f < n; f++) {
+            formatField(acl->text + acl->offset[f], acl->width[f],
+                        acl->decimals[f], values[f]);
+            acl->values[f] = values[f];
+        }
+        clearLineInMessageArea(line);
+        mvaddstr(line, 1, acl->text);
+        acl->line = line;
+        return;
+    }
+
+    for (int f = 0; f < n; f++) {
+        char field[LINE_TEXT];
+        char* old = acl->text + acl->offset[f];
+        int width = acl->width[f];
+        int first = 0;
+        int last = width - 1;
+
+        if (values[f] == acl->values[f]) {
+            continue;
+        }
+        acl->values[f] = values[f];
+        formatField(field, width, acl->decimals[f], values[f]);
+
+        // Nur den Bereich ausgeben, in dem sich Zeichen unterscheiden
+        while (first < width && field[first] == old[first]) {
+            first++;
+        }
+        while (last > first && field[last] == old[last]) {
+            last--;
+        }
+        if (first < width) {
+            mvaddnstr(line, 1 + acl->offset[f] + first, field + first,
+                      last - first + 1);
+            memcpy(old + first, field + first, last - first + 1);
+        }
+    }
+}
+
+void invalidateStatusLine(void) {
+    status.line = -1;
+    timing.line = -1;
+}
+
+void showStatus(struct board* aboard, struct worm* aworm) {
 
     struct pos head = getWormHeadPos(aworm);
-    int len        = getWormLength(aworm);
-    int food_left  = getNumberOfFoodItems(aboard);
+    long values[SF_COUNT] = {
+        [SF_HEAD_Y] = head.y,
+        [SF_HEAD_X] = head.x,
+        [SF_LENGTH] = getWormLength(aworm),
+        [SF_FOOD]   = getNumberOfFoodItems(aboard),
+    };
+
+    showCachedLine(&status, LINES - ROWS_RESERVED + 2, values, SF_COUNT);
+}
+
+// ---------------------------------------------------------------------------
+// Messwerte des Taktgebers in der letzten Zeile des Message-Bereichs
+//
+// Wie die Statuszeile über eine Vorlage mit festen Feldern: pro Frame
+// ändern sich meist nur die Ziffern des letzten Jitters. Jitter in
+// Hundertstel Millisekunden (10 us).
+// ---------------------------------------------------------------------------
+void showTimingStatus(struct tickScheduler* asched) {
+
+    long long jitter_avg = asched->jitter_samples > 0
+                         ? asched->jitter_sum_ns / asched->jitter_samples
+                         : 0;
+    long values[TF_COUNT] = {
+        [TF_JITTER_LAST] = (long)(asched->jitter_last_ns / 10000),
+        [TF_JITTER_AVG]  = (long)(jitter_avg / 10000),
+        [TF_JITTER_MAX]  = (long)(asched->jitter_max_ns / 10000),
+        [TF_OVERRUNS]    = asched->overruns,
+        [TF_DROPPED]     = asched->dropped_ticks,
+        [TF_FRAMESKIP]   = asched->frames_skipped,
+    };
+
+    showCachedLine(&timing, LINES - ROWS_RESERVED + 3, values, TF_COUNT);
+}
+
+// ---------------------------------------------------------------------------
+// Zeitprofil der Spielschleife (Taste t)
+//
+// Sieben Phasen passen nicht in eine Zeile: die Einblendung belegt die
+// freie erste Zeile und die Zeile des Taktgebers. Werte unter 10 us mit
+// einer Nachkommastelle. Am Ende der zweiten Zeile die Zeit von der
+// Richtungstaste bis zum Schritt in ms (p50/p99).
+// ---------------------------------------------------------------------------
+static int formatMicros(char* buf, long long ns)
+{
+    double us = ns / 1e3;
+    return sprintf(buf, us < 10.0 ? "%.1f" : "%.0f", us);
+}
+
+static void showProfileLine(int line, const struct tickProfile* aprof,
+                            const char* prefix, int first, int last,
+                            bool keys)
+{
+    char buf[256];
+    int len = sprintf(buf, "%s", prefix);
+
+    for (int p = first; p < last; p++) {
+        const struct latencyHistogram* h = &aprof->all[p];
+
+        len += sprintf(buf + len, "  %.3s ", tickPhaseName(p));
+        len += formatMicros(buf + len, latencyPercentile(h, 0.50));
+        buf[len++] = '/';
+        len += formatMicros(buf + len, latencyPercentile(h, 0.99));
+        buf[len++] = '/';
+        len += formatMicros(buf + len, h->max_ns);
+    }
+    if (keys && aprof->key_to_move.count > 0) {
+        len += sprintf(buf + len, "  Taste ms %.0f/%.0f",
+                       latencyPercentile(&aprof->key_to_move, 0.50) / 1e6,
+                       latencyPercentile(&aprof->key_to_move, 0.99) / 1e6);
+    }
 
-    // Zeile zuerst vollständig löschen, damit keine alten Zeichen übrig bleiben
     clearLineInMessageArea(line);
+    mvaddnstr(line, 1, buf, COLS - 2);
+}
+
+void showProfileStatus(const struct tickProfile* aprof, bool visible) {
+
+    int l1 = LINES - ROWS_RESERVED + 1;
+    int l3 = LINES - ROWS_RESERVED + 3;
+
+    if (!visible) {
+        clearLineInMessageArea(l1);
+        return;
+    }
 
-    // Status neu ausgeben
-    mvprintw(
-        line,
-        1,
-        "Position des Wurms: y = %3d   x = %3d   Segmente: %3d   Futterbrocken: %2d   ",
-        head.y,
-        head.x,
-        len,
-        food_left
-    );
+    showProfileLine(l1, aprof, "us p50/p99/max", PHASE_INPUT, PHASE_SHOW, false);
+    showProfileLine(l3, aprof, "              ", PHASE_SHOW, PHASE_COUNT, true);
 }
 
 // ---------------------------------------------------------------------------
@@ -7,6 +7,8 @@
 #include "worm.h"
 #include "worm_model.h"
 #include "board_model.h"
+#include "timing.h"
+#include "tickprof.h"
 
 // ============================================================================
 //
@@ -77,11 +79,67 @@ extern void showBorderLine(void);
 //     aworm  – Zeiger auf das Wurmmodell
 //
 //  Hinweis:
-//     Die Funktion wird regelmäßig während des Spiels aufgerufen.
+//     Die Funktion wird regelmäßig während des Spiels aufgerufen. Sie merkt
+//     sich den Stand der Zeile und gibt nur die Zeichen geänderter Felder
+//     aus. Löscht clearLineInMessageArea() die Zeile (z. B. ein Dialog),
+//     wird sie beim nächsten Aufruf wieder vollständig gezeichnet.
 // ---------------------------------------------------------------------------
 extern void showStatus(struct board* aboard, struct worm* aworm);
 
 
+// ---------------------------------------------------------------------------
+//  invalidateStatusLine()
+//  ----------------------
+//
+//  Zweck:
+//     Vergisst den gemerkten Stand der Statuszeile und der Zeile des
+//     Taktgebers, so dass showStatus() und showTimingStatus() sie beim
+//     nächsten Aufruf vollständig zeichnen.
+//
+//  Einsatz:
+//     nach clear(), das den ganzen Bildschirm löscht (Startbildschirm)
+// ---------------------------------------------------------------------------
+extern void invalidateStatusLine(void);
+
+
+// ---------------------------------------------------------------------------
+//  showTimingStatus(asched)
+//  ------------------------
+//
+//  Zweck:
+//     Gibt eine zweite Statuszeile mit den Messwerten des Taktgebers aus:
+//
+//        - Jitter (letzter, mittlerer und größter Wert in Millisekunden)
+//        - Overruns (verspätete Schritte) und verworfene Schritte
+//        - übersprungene Frames
+//
+//  Parameter:
+//     asched – Zeiger auf den Scheduler der Spielschleife
+//
+//  Hinweis:
+//     Wie showStatus(): feste Felder, ausgegeben werden nur die Zeichen
+//     geänderter Werte.
+// ---------------------------------------------------------------------------
+extern void showTimingStatus(struct tickScheduler* asched);
+
+
+// ---------------------------------------------------------------------------
+//  showProfileStatus(aprof, visible)
+//  ---------------------------------
+//
+//  Zweck:
+//     Blendet das Zeitprofil der Spielschleife (siehe tickprof.h) in der
+//     ersten Zeile des Nachrichtenbereichs ein: je Phase p50/p99/max in
+//     Mikrosekunden. Passt die Zeile nicht ins Fenster, wird sie
+//     abgeschnitten.
+//
+//  Parameter:
+//     aprof   – Zeiger auf das Zeitprofil
+//     visible – false löscht die Zeile (Einblendung ausgeschaltet)
+// ---------------------------------------------------------------------------
+extern void showProfileStatus(const struct tickProfile* aprof, bool visible);
+
+
 // ---------------------------------------------------------------------------
 //  showDialog(prompt1, prompt2)
 //  ----------------------------
@@ -0,0 +1,223 @@
+// Worm070 - Aufgabenblatt 8
+// ============================================================================
+//  Modul: obs_encoder.c  –  Spielzustand als One-Hot-Ebenen
+// ============================================================================
+
+#include <string.h>
+
+#include "worm.h"
+#include "board_model.h"
+#include "worm_model.h"
+#include "obs_encoder.h"
+
+// Elementtyp des Ausgabepuffers
+enum ObsFormat {
+    OBS_FORMAT_U8,
+    OBS_FORMAT_F32
+};
+
+// BoardCode jeder Code-Ebene (OBS_FREE bis OBS_BODY)
+static const cell_t plane_code[OBS_HEAD] = {
+    BC_FREE_CELL,
+    BC_BARRIER,
+    BC_FOOD_1,
+    BC_FOOD_2,
+    BC_FOOD_3,
+    BC_USED_BY_WORM
+};
+
+// ============================================================================
+//  Hilfsfunktionen
+// ============================================================================
+
+// Schreibt eine Zeile von BoardCodes in alle Code-Ebenen: je Ebene ein
+// Vergleich pro Zelle, ohne Verzweigung in der inneren Schleife.
+static void encodeRow(const cell_t* line, int width,
+                      void* out, long offset, long plane_elems,
+                      enum ObsFormat fmt)
+{
+    for (int p = 0; p < OBS_HEAD; p++) {
+        cell_t code = plane_code[p];
+        long base = offset + p * plane_elems;
+
+        if (fmt == OBS_FORMAT_U8) {
+            uint8_t* o = (uint8_t*)out + base;
+            for (int x = 0; x < width; x++) {
+                o[x] = (line[x] == code);
+            }
+        } else {
+            float* o = (float*)out + base;
+            for (int x = 0; x < width; x++) {
+                o[x] = (line[x] == code) ? 1.0f : 0.0f;
+            }
+        }
+    }
+}
+
+static void fillElems(void* out, long start, long count, int value,
+                      enum ObsFormat fmt)
+{
+    if (fmt == OBS_FORMAT_U8) {
+        memset((uint8_t*)out + start, value, count);
+    } else {
+        float* o = (float*)out + start;
+        for (long i = 0; i < count; i++) {
+            o[i] = (float)value;
+        }
+    }
+}
+
+static void setElem(void* out, long idx, int value, enum ObsFormat fmt)
+{
+    if (fmt == OBS_FORMAT_U8) {
+        ((uint8_t*)out)[idx] = (uint8_t)value;
+    } else {
+        ((float*)out)[idx] = (float)value;
+    }
+}
+
+// Kopf- und Richtungsebenen eines Boards; head_off ist die Lage des Kopfes
+// innerhalb einer Ebene. Die Kopfzelle wird aus der Körperebene entfernt.
+static void encodeWormPlanes(struct worm* aworm,
+                             void* out, long base, long plane_elems,
+                             long head_off, enum ObsFormat fmt)
+{
+    setElem(out, base + OBS_BODY * plane_elems + head_off, 0, fmt);
+
+    fillElems(out, base + OBS_HEAD * plane_elems, plane_elems, 0, fmt);
+    setElem(out, base + OBS_HEAD * plane_elems + head_off, 1, fmt);
+
+    for (int dir = 0; dir < WORM_HEADINGS; dir++) {
+        fillElems(out, base + (OBS_HEADING_0 + dir) * plane_elems, plane_elems,
+                  dir == (int)aworm->heading, fmt);
+    }
+}
+
+// ============================================================================
+//  Ganzes Spielfeld
+// ============================================================================
+
+long obsBoardElements(struct board* aboard)
+{
+    return (long)OBS_PLANE_COUNT * (aboard->last_row + 1) * (aboard->last_col + 1);
+}
+
+static enum ResCodes encodeBoards(struct board** boards, struct worm** worms,
+                                  int count, void* out, enum ObsFormat fmt)
+{
+    if (count <= 0) {
+        return RES_OK;
+    }
+
+    int rows = boards[0]->last_row + 1;
+    int cols = boards[0]->last_col + 1;
+    for (int i = 1; i < count; i++) {
+        if (boards[i]->last_row + 1 != rows || boards[i]->last_col + 1 != cols) {
+            return RES_FAILED;
+        }
+    }
+
+    long plane_elems = (long)rows * cols;
+    long per_board   = OBS_PLANE_COUNT * plane_elems;
+
+    for (int i = 0; i < count; i++) {
+        struct board* b = boards[i];
+        long base = i * per_board;
+
+        // Zeilen direkt aus dem Zellblock, der Rand wird übersprungen
+        for (int y = 0; y < rows; y++) {
+            encodeRow(cellAt(b, y, 0), cols, out, base + (long)y * cols,
+                      plane_elems, fmt);
+        }
+
+        struct pos head = getWormHeadPos(worms[i]);
+        encodeWormPlanes(worms[i], out, base, plane_elems,
+                         (long)head.y * cols + head.x, fmt);
+    }
+    return RES_OK;
+}
+
+enum ResCodes encodeBoardsU8(struct board** boards, struct worm** worms,
+                             int count, uint8_t* out)
+{
+    return encodeBoards(boards, worms, count, out, OBS_FORMAT_U8);
+}
+
+enum ResCodes encodeBoardsF32(struct board** boards, struct worm** worms,
+                              int count, float* out)
+{
+    return encodeBoards(boards, worms, count, out, OBS_FORMAT_F32);
+}
+
+// ============================================================================
+//  Ausschnitt um den Kopf
+// ============================================================================
+// Jede Zeile des Ausschnitts wird in einen kleinen Puffer auf dem Stack
+// kopiert: links und rechts außerhalb des Spielfelds BC_BARRIER, dazwischen
+// ein memcpy aus dem Zellblock. Danach wie beim ganzen Spielfeld.
+// ============================================================================
+
+long obsCropElements(int radius)
+{
+    long size = 2L * radius + 1;
+    return OBS_PLANE_COUNT * size * size;
+}
+
+static enum ResCodes encodeCrops(struct board** boards, struct worm** worms,
+                                 int count, int radius,
+                                 void* out, enum ObsFormat fmt)
+{
+    cell_t line[2 * OBS_MAX_CROP_RADIUS + 1];
+
+    if (radius < 0 || radius > OBS_MAX_CROP_RADIUS) {
+        return RES_FAILED;
+    }
+
+    int size = 2 * radius + 1;
+    long plane_elems = (long)size * size;
+    long per_board   = OBS_PLANE_COUNT * plane_elems;
+
+    for (int i = 0; i < count; i++) {
+        struct board* b = boards[i];
+        struct pos head = getWormHeadPos(worms[i]);
+        long base = i * per_board;
+
+        // Spaltenbereich des Ausschnitts, der im Spielfeld liegt
+        int x_first = head.x - radius;
+        int lo = x_first < 0 ? -x_first : 0;
+        int hi = b->last_col - x_first;            // letzte Spalte im Feld
+        if (hi > size - 1) {
+            hi = size - 1;
+        }
+
+        for (int j = 0; j < size; j++) {
+            int wy = head.y - radius + j;
+
+            if (wy < 0 || wy > b->last_row || hi < lo) {
+                memset(line, BC_BARRIER, size);
+            } else {
+                memset(line, BC_BARRIER, lo);
+                memcpy(line + lo, cellAt(b, wy, x_first + lo), hi - lo + 1);
+                memset(line + hi + 1, BC_BARRIER, size - hi - 1);
+            }
+
+            encodeRow(line, size, out, base + (long)j * size, plane_elems, fmt);
+        }
+
+        encodeWormPlanes(worms[i], out, base, plane_elems,
+                         (long)radius * size + radius, fmt);
+    }
+    return RES_OK;
+}
+
+enum ResCodes encodeCropsU8(struct board** boards, struct worm** worms,
+                            int count, int radius, uint8_t* out)
+{
+    return encodeCrops(boards, worms, count, radius, out, OBS_FORMAT_U8);
+}
+
+enum ResCodes encodeCropsF32(struct board** boards, struct worm** worms,
+                             int count, int radius, float* out)
+{
+    return encodeCrops(boards, worms, count, radius, out, OBS_FORMAT_F32);
+}
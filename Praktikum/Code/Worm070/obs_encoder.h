@@ -0,0 +1,79 @@
+// Worm070 - Aufgabenblatt 8
+// ============================================================================
+//  obs_encoder.h – Spielzustand als One-Hot-Ebenen für neuronale Netze
+//
+//  Kodiert struct board und struct worm in dichte Ebenen (Kanäle) und
+//  schreibt sie direkt in einen Puffer des Aufrufers, als uint8_t (0/1)
+//  oder float (0.0/1.0). Es gibt keine Zwischenpuffer auf dem Heap.
+//
+//  Layout pro Board: Ebene, Zeile, Spalte (CHW), also
+//     out[(plane * rows + y) * cols + x]
+//  Ein Batch aus count Boards liegt direkt hintereinander; alle Boards
+//  eines Aufrufs müssen gleich groß sein.
+//
+//  Für die BoardCode-Ebenen wird jede Zeile einmal pro Ebene mit einem
+//  Vergleich durchlaufen (Zelle == Code). Diese Schleifen über Bytes
+//  vektorisiert der Compiler.
+//
+//  Variante mit Ausschnitt: ein (2 * radius + 1)-Quadrat, zentriert auf
+//  getWormHeadPos(). Zellen außerhalb des Spielfelds gelten als Barriere.
+// ============================================================================
+
+#ifndef _OBS_ENCODER_H
+#define _OBS_ENCODER_H
+
+#include <stdint.h>
+#include "worm.h"
+#include "board_model.h"
+#include "worm_model.h"
+
+// ---------------------------------------------------------------------------
+//  Ebenen
+// ---------------------------------------------------------------------------
+//  OBS_HEADING_0 + dir ist für die aktuelle Richtung dir überall 1, die
+//  anderen Richtungsebenen sind 0.
+// ---------------------------------------------------------------------------
+enum ObsPlanes {
+    OBS_FREE,        // BC_FREE_CELL
+    OBS_BARRIER,     // BC_BARRIER (auch außerhalb des Spielfelds)
+    OBS_FOOD_1,      // BC_FOOD_1
+    OBS_FOOD_2,      // BC_FOOD_2
+    OBS_FOOD_3,      // BC_FOOD_3
+    OBS_BODY,        // vom Wurm belegt, ohne Kopf
+    OBS_HEAD,        // Kopf des Wurms
+    OBS_HEADING_0,   // erste der WORM_HEADINGS Richtungsebenen
+    OBS_PLANE_COUNT = OBS_HEADING_0 + WORM_HEADINGS
+};
+
+// Größter zulässiger Radius für den Ausschnitt
+#define OBS_MAX_CROP_RADIUS 64
+
+// Anzahl der Elemente pro Board (ganzes Spielfeld bzw. Ausschnitt).
+extern long obsBoardElements(struct board* aboard);
+extern long obsCropElements(int radius);
+
+// Ganzes Spielfeld, count Boards mit den zugehörigen Würmern.
+// Liefert RES_FAILED, wenn die Boards nicht gleich groß sind.
+extern enum ResCodes encodeBoardsU8(struct board** boards,
+                                    struct worm** worms,
+                                    int count,
+                                    uint8_t* out);
+extern enum ResCodes encodeBoardsF32(struct board** boards,
+                                     struct worm** worms,
+                                     int count,
+                                     float* out);
+
+// Ausschnitt um den Kopf, count Boards (Größen dürfen verschieden sein).
+// Liefert RES_FAILED bei radius < 0 oder radius > OBS_MAX_CROP_RADIUS.
+extern enum ResCodes encodeCropsU8(struct board** boards,
+                                   struct worm** worms,
+                                   int count,
+                                   int radius,
+                                   uint8_t* out);
+extern enum ResCodes encodeCropsF32(struct board** boards,
+                                    struct worm** worms,
+                                    int count,
+                                    int radius,
+                                    float* out);
+
+#endif  // _OBS_ENCODER_H
@@ -0,0 +1,327 @@
+// Worm070 - Aufgabenblatt 8
+// ============================================================================
+//  Modul: reach.c  –  erreichbares Gebiet mit Ringtest und Flood Fill
+// ============================================================================
+
+#include <stdlib.h>
+
+#include "worm.h"
+#include "board_model.h"
+#include "worm_model.h"
+#include "bitboard.h"
+#include "reach.h"
+
+// Richtungen in Ringreihenfolge (im Uhrzeigersinn ab oben). Gerade
+// Positionen sind orthogonale Nachbarn, ungerade diagonale.
+static const enum WormHeading ring_dirs[8] = {
+    WORM_UP,   WORM_UP_RIGHT,  WORM_RIGHT, WORM_DOWN_RIGHT,
+    WORM_DOWN, WORM_DOWN_LEFT, WORM_LEFT,  WORM_UP_LEFT
+};
+
+// Gruppen betretbarer Nachbarn je Ringmaske (siehe reach.h)
+static uint8_t ring_groups[256];
+static bool ring_ready = false;
+
+// ============================================================================
+//  Ringtabelle
+// ============================================================================
+// Vorgehen:
+//    Zwei Ringpositionen sind benachbart (ohne die Mitte), wenn sie im Ring
+//    aufeinander folgen oder beide orthogonal sind und eine Position
+//    dazwischen liegt (z. B. oben und rechts berühren sich diagonal).
+//    Gruppen werden per Union-Find über die acht Positionen gezählt.
+// ----------------------------------------------------------------------------
+
+static int findRoot(int* parent, int i)
+{
+    while (parent[i] != i) {
+        i = parent[i];
+    }
+    return i;
+}
+
+static void joinIfSet(int* parent, int mask, int a, int b)
+{
+    if ((mask >> a & 1) && (mask >> b & 1)) {
+        parent[findRoot(parent, a)] = findRoot(parent, b);
+    }
+}
+
+static void buildRingTable(void)
+{
+    for (int mask = 0; mask < 256; mask++) {
+        int parent[8];
+        int groups = 0;
+
+        for (int i = 0; i < 8; i++) {
+            parent[i] = i;
+        }
+        for (int i = 0; i < 8; i++) {
+            joinIfSet(parent, mask, i, (i + 1) % 8);
+            if (i % 2 == 0) {
+                joinIfSet(parent, mask, i, (i + 2) % 8);
+            }
+        }
+        for (int i = 0; i < 8; i++) {
+            if ((mask >> i & 1) && findRoot(parent, i) == i) {
+                groups++;
+            }
+        }
+        ring_groups[mask] = (uint8_t)groups;
+    }
+    ring_ready = true;
+}
+
+// ============================================================================
+//  Hilfsfunktionen
+// ============================================================================
+
+static inline bool isPassableCode(cell_t code)
+{
+    return code != BC_BARRIER && code != BC_USED_BY_WORM;
+}
+
+static inline bool testBit(const uint64_t* plane, cellidx_t idx)
+{
+    return (plane[idx >> 6] >> (idx & 63)) & 1;
+}
+
+static inline void setBit(uint64_t* plane, cellidx_t idx)
+{
+    plane[idx >> 6] |= (uint64_t)1 << (idx & 63);
+}
+
+static inline void clearBit(uint64_t* plane, cellidx_t idx)
+{
+    plane[idx >> 6] &= ~((uint64_t)1 << (idx & 63));
+}
+
+// Maske der betretbaren Nachbarn von idx in Ringreihenfolge
+static inline int ringMask(struct board* aboard, cellidx_t idx)
+{
+    int mask = 0;
+    for (int i = 0; i < 8; i++) {
+        if (isPassableCode(aboard->cells[idx + aboard->dir_offset[ring_dirs[i]]])) {
+            mask |= 1 << i;
+        }
+    }
+    return mask;
+}
+
+// true, wenn das Belegen von idx kein Gebiet zerteilen kann
+static inline bool ringIsConnected(struct board* aboard, cellidx_t idx)
+{
+    return ring_groups[ringMask(aboard, idx)] <= 1;
+}
+
+static inline struct pos cellPos(struct board* aboard, cellidx_t idx)
+{
+    struct pos p;
+    p.y = (int)(idx / aboard->stride) - BOARD_BORDER;
+    p.x = (int)(idx % aboard->stride) - BOARD_BORDER;
+    return p;
+}
+
+// Neuberechnung per Flood Fill vom Kopf aus
+static void refreshReach(struct reachTracker* areach)
+{
+    struct board* aboard = areach->board;
+
+    areach->size   = floodFillFromPos(aboard->bits,
+                                      cellPos(aboard, areach->head),
+                                      areach->region);
+    areach->single = ringIsConnected(aboard, areach->head);
+    areach->stale  = false;
+    areach->fills++;
+}
+
+// ============================================================================
+//  attachReachTracker / freeReachTracker
+// ============================================================================
+
+enum ResCodes attachReachTracker(struct board* aboard,
+                                 struct reachTracker* areach,
+                                 struct worm* aworm)
+{
+    if (areach == NULL) {
+        aboard->reach = NULL;
+        return RES_OK;
+    }
+    if (aboard->bits == NULL) {
+        return RES_FAILED;
+    }
+    if (!ring_ready) {
+        buildRingTable();
+    }
+
+    int words = bitboardPlaneWords(aboard->bits);
+    if (words > areach->words) {
+        free(areach->region);
+        areach->region = malloc(words * sizeof(uint64_t));
+        areach->words  = (areach->region != NULL) ? words : 0;
+        if (areach->region == NULL) {
+            return RES_FAILED;
+        }
+    }
+
+    areach->board = aboard;
+    areach->head  = getWormHeadCell(aworm);
+    areach->stale = true;
+    aboard->reach = areach;
+    return RES_OK;
+}
+
+void freeReachTracker(struct reachTracker* areach)
+{
+    free(areach->region);
+    areach->region = NULL;
+    areach->words  = 0;
+}
+
+// ============================================================================
+//  updateReachCell
+// ============================================================================
+// Vorgehen (siehe reach.h):
+//    - betretbar -> betretbar und belegt -> belegt ändern nichts
+//    - betretbar -> Wurm: der Kopf rückt auf idx vor
+//    - betretbar -> Barriere: idx fällt aus dem Gebiet
+//    - belegt -> betretbar: idx kommt hinzu, wenn es an Gebiet oder Kopf
+//      grenzt; verbindet es dabei mit einem fremden Gebiet, neu rechnen
+// ----------------------------------------------------------------------------
+
+static void blockCell(struct reachTracker* areach, cellidx_t idx, bool is_head)
+{
+    struct board* aboard = areach->board;
+    bool inside = testBit(areach->region, idx);
+
+    if (is_head) {
+        areach->head = idx;
+    }
+    if (areach->stale || (!inside && !is_head)) {
+        return;
+    }
+
+    // Der neue Kopf muss im zusammenhängenden Gebiet liegen; sonst ist das
+    // Gebiet vom neuen Kopf aus ein anderes.
+    if (inside && ringIsConnected(aboard, idx) && (areach->single || !is_head)) {
+        clearBit(areach->region, idx);
+        areach->size--;
+        areach->incremental++;
+    } else {
+        areach->stale = true;
+    }
+}
+
+static void freeCell(struct reachTracker* areach, cellidx_t idx)
+{
+    struct board* aboard = areach->board;
+    bool touches_region = false;
+    bool touches_head = false;
+    bool touches_other = false;
+
+    if (areach->stale) {
+        return;
+    }
+
+    for (int dir = 0; dir < WORM_HEADINGS; dir++) {
+        cellidx_t n = (cellidx_t)(idx + aboard->dir_offset[dir]);
+        if (n == areach->head) {
+            touches_head = true;
+        } else if (isPassableCode(aboard->cells[n])) {
+            if (testBit(areach->region, n)) {
+                touches_region = true;
+            } else {
+                touches_other = true;
+            }
+        }
+    }
+
+    if (!touches_region && !touches_head) {
+        return;                         // abgeschlossene Tasche
+    }
+    if (touches_other) {
+        areach->stale = true;           // verbindet mit fremdem Gebiet
+        return;
+    }
+
+    // Grenzt idx nur an den Kopf, entsteht ein zweites Teilgebiet
+    if (!touches_region && areach->size > 0) {
+        areach->single = false;
+    }
+    setBit(areach->region, idx);
+    areach->size++;
+    areach->incremental++;
+}
+
+void updateReachCell(struct reachTracker* areach,
+                     cellidx_t idx,
+                     enum BoardCodes old_code,
+                     enum BoardCodes new_code)
+{
+    bool was_open = isPassableCode((cell_t)old_code);
+    bool is_open  = isPassableCode((cell_t)new_code);
+
+    if (was_open && !is_open) {
+        blockCell(areach, idx, new_code == BC_USED_BY_WORM);
+    } else if (!was_open && is_open) {
+        freeCell(areach, idx);
+    }
+}
+
+void invalidateReach(struct reachTracker* areach, cellidx_t head)
+{
+    areach->head  = head;
+    areach->stale = true;
+}
+
+// ============================================================================
+//  Abfragen
+// ============================================================================
+
+int reachableArea(struct reachTracker* areach)
+{
+    if (areach->stale) {
+        refreshReach(areach);
+    }
+    return areach->size;
+}
+
+bool isReachableCell(struct reachTracker* areach, cellidx_t idx)
+{
+    if (areach->stale) {
+        refreshReach(areach);
+    }
+    return testBit(areach->region, idx);
+}
+
+// ----------------------------------------------------------------------------
+// Vorgehen:
+//    - Zielzelle nicht betretbar: 0
+//    - Gebiet zusammenhängend und Ringtest an der Zielzelle bestanden: das
+//      Gebiet bleibt ganz, nur die Zielzelle fällt weg (kein Flood Fill)
+//    - sonst Zielzelle im Bitboard kurz als Wurm eintragen und von ihr aus
+//      füllen
+// ----------------------------------------------------------------------------
+int reachAfterMove(struct reachTracker* areach, enum WormHeading dir)
+{
+    struct board* aboard = areach->board;
+    cellidx_t target = neighbourIndex(aboard, areach->head, dir);
+    enum BoardCodes code = (enum BoardCodes)aboard->cells[target];
+
+    if (!isPassableCode((cell_t)code)) {
+        return 0;
+    }
+    if (areach->stale) {
+        refreshReach(areach);
+    }
+    if (areach->single && ringIsConnected(aboard, target)) {
+        areach->incremental++;
+        return areach->size - 1;
+    }
+
+    updateBitboardIndex(aboard->bits, target, code, BC_USED_BY_WORM);
+    int area = floodFillFromPos(aboard->bits, cellPos(aboard, target), NULL);
+    updateBitboardIndex(aboard->bits, target, BC_USED_BY_WORM, code);
+    areach->fills++;
+    return area;
+}
@@ -0,0 +1,116 @@
+// Worm070 - Aufgabenblatt 8
+// ============================================================================
+//  reach.h – Größe des vom Wurmkopf erreichbaren Gebiets, inkrementell
+//
+//  Idee:
+//    Ein Bot, der vor jedem Zug prüft, ob er sich einsperrt, braucht die
+//    Größe des freien Gebiets, das vom Kopf aus erreichbar ist (8er-
+//    Nachbarschaft wie die Bewegung des Wurms, betretbar sind freie Zellen
+//    und Futter). Ein Flood Fill pro Kandidatenzug kostet auf großen
+//    Feldern mehr als die ganze übrige Planung.
+//
+//    Der Tracker hält das Gebiet als Bitebene (gleiches Layout wie das
+//    Bitboard, Bitnummer = Zellnummer) und seine Größe. Er hängt wie das
+//    Bitboard am Board; setContentAtIndex() meldet ihm jede Änderung einer
+//    Zelle. Die meisten Änderungen sind lokal zu entscheiden:
+//
+//    Ringtest:
+//      Die acht Nachbarn einer Zelle bilden einen Ring. ring_groups[mask]
+//      (256 Einträge, einmal berechnet) gibt an, in wie viele Gruppen die
+//      betretbaren Nachbarn (Bitmaske mask) innerhalb des Rings zerfallen.
+//      Ist es höchstens eine, kann jeder Weg durch die Zelle außen um sie
+//      herum geführt werden: Wird sie belegt, zerfällt kein Gebiet.
+//
+//    Kopf rückt vor (betretbar -> Wurm):
+//      Ist das Gebiet zusammenhängend (single) und besteht der Ringtest,
+//      verliert es nur die neue Kopfzelle: Größe - 1, ein Bit löschen.
+//    Schwanz wird frei (Wurm -> frei):
+//      Grenzt die Zelle an das Gebiet oder den Kopf und liegen alle ihre
+//      betretbaren Nachbarn schon im Gebiet, kommt sie einfach hinzu.
+//    Sonst (ein Gebiet könnte zerfallen oder sich mit einem anderen
+//    verbinden) wird der Tracker als veraltet markiert. Erst die nächste
+//    Abfrage rechnet dann einen Flood Fill auf dem Bitboard
+//    (floodFillFromPos(), 64 Zellen pro Wortoperation).
+//
+//    single ist eine sichere Aussage: true nur, wenn die betretbaren
+//    Nachbarn des Kopfes nachweislich zu einem Gebiet gehören (nach einem
+//    Flood Fill: Ringtest am Kopf). Im Zweifel wird neu gerechnet.
+//
+//  Verwendung:
+//    - Bitboard anhängen (attachBitboard()), dann attachReachTracker()
+//    - reachableArea() liefert die Größe des Gebiets
+//    - reachAfterMove() die Größe nach einem Zug in eine Richtung; der Zug
+//      sperrt den Wurm ein, wenn sie kleiner als seine Länge ist (der
+//      Schwanz, der in dieser Zeit frei wird, ist nicht mitgerechnet)
+//    - restoreGame() (snapshot.h) markiert den Tracker als veraltet
+// ============================================================================
+
+#ifndef _REACH_H
+#define _REACH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "worm.h"
+#include "board_model.h"
+#include "worm_model.h"
+
+// ============================================================================
+//  struct reachTracker
+// ============================================================================
+//
+//  board:        Board, an dem der Tracker hängt
+//  region:       erreichbare Zellen als Bitebene (bitboardPlaneWords() Wörter)
+//  head:         Zellnummer des Wurmkopfes (Ausgangspunkt)
+//  size:         Anzahl der Bits in region (gültig, wenn !stale)
+//  stale:        region/size veraltet, nächste Abfrage rechnet neu
+//  single:       region ist ohne den Kopf zusammenhängend
+//  incremental:  Statistik: lokal erledigte Änderungen
+//  fills:        Statistik: Flood Fills (Neuberechnung und Zugprüfung)
+// ============================================================================
+
+struct reachTracker {
+    struct board* board;
+    uint64_t* region;
+    int words;
+    cellidx_t head;
+    int size;
+    bool stale;
+    bool single;
+    long incremental;
+    long fills;
+};
+
+// Hängt den Tracker an das Board (Speicher wird beim ersten Aufruf
+// angelegt, vorher mit Nullen initialisieren). Am Board muss ein Bitboard
+// hängen; Ausgangspunkt ist der Kopf von aworm. NULL hängt ab.
+// Aufruf wie bei attachBitboard() nach initializeLevel().
+// RES_FAILED ohne Bitboard oder Speicher.
+extern enum ResCodes attachReachTracker(struct board* aboard,
+                                        struct reachTracker* areach,
+                                        struct worm* aworm);
+
+extern void freeReachTracker(struct reachTracker* areach);
+
+// Von setContentAtIndex() aufgerufen, nachdem Zelle idx von old_code auf
+// new_code gesetzt wurde.
+extern void updateReachCell(struct reachTracker* areach,
+                            cellidx_t idx,
+                            enum BoardCodes old_code,
+                            enum BoardCodes new_code);
+
+// Markiert den Tracker als veraltet, z. B. nach dem Zurückspielen eines
+// Snapshots; head ist der neue Kopf.
+extern void invalidateReach(struct reachTracker* areach, cellidx_t head);
+
+// Anzahl der vom Kopf erreichbaren betretbaren Zellen.
+extern int reachableArea(struct reachTracker* areach);
+
+// true, wenn Zelle idx zum erreichbaren Gebiet gehört.
+extern bool isReachableCell(struct reachTracker* areach, cellidx_t idx);
+
+// Größe des Gebiets, das nach einem Zug in Richtung dir vom neuen Kopf aus
+// erreichbar ist; 0, wenn die Zielzelle nicht betretbar ist. Der Zug wird
+// nicht ausgeführt.
+extern int reachAfterMove(struct reachTracker* areach, enum WormHeading dir);
+
+#endif  // _REACH_H
@@ -0,0 +1,411 @@
+// Worm070 - Aufgabenblatt 8
+// ============================================================================
+//  Modul: render.c  –  Renderer für ncurses, Framebuffer, Headless-Betrieb
+//                      und Mitschnitt
+// ============================================================================
+
+#include <curses.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+
+#include "worm.h"
+#include "render.h"
+#include "messages.h"
+
+// ============================================================================
+//  ncurses-Renderer
+// ============================================================================
+
+static void cursesDrawCell(struct renderer* self,
+                           int y, int x,
+                           chtype symbol,
+                           enum ColorPairs color_pair)
+{
+    move(y, x);
+    attron(COLOR_PAIR(color_pair));
+    addch(symbol);
+    attroff(COLOR_PAIR(color_pair));
+}
+
+static void cursesPresent(struct renderer* self)
+{
+    refresh();
+}
+
+// Prüft die Fenstergröße. Die Message Area (ROWS_RESERVED) kommt hinzu.
+static enum ResCodes cursesCheckSize(struct renderer* self, int rows, int cols)
+{
+    if (COLS < cols || LINES < rows + ROWS_RESERVED) {
+        char buf[100];
+        sprintf(
+            buf,
+            "Das Fenster ist zu klein: wir brauchen %dx%d",
+            cols,
+            rows + ROWS_RESERVED
+        );
+
+        showDialog(buf, "Bitte eine Taste druecken");
+        return RES_FAILED;
+    }
+    return RES_OK;
+}
+
+static struct renderer cursesRenderer = {
+    .drawCell    = cursesDrawCell,
+    .present     = cursesPresent,
+    .checkSize   = cursesCheckSize,
+    .is_terminal = true,
+    .has_output  = true,
+};
+
+struct renderer* getCursesRenderer(void)
+{
+    return &cursesRenderer;
+}
+
+// ============================================================================
+//  Null-Renderer (headless)
+// ============================================================================
+
+static void nullDrawCell(struct renderer* self,
+                         int y, int x,
+                         chtype symbol,
+                         enum ColorPairs color_pair)
+{
+}
+
+static void nullPresent(struct renderer* self)
+{
+}
+
+static enum ResCodes nullCheckSize(struct renderer* self, int rows, int cols)
+{
+    return RES_OK;
+}
+
+static struct renderer nullRenderer = {
+    .drawCell    = nullDrawCell,
+    .present     = nullPresent,
+    .checkSize   = nullCheckSize,
+    .is_terminal = false,
+    .has_output  = false,
+};
+
+struct renderer* getNullRenderer(void)
+{
+    return &nullRenderer;
+}
+
+// ============================================================================
+//  Recorder
+// ============================================================================
+
+static void recorderDrawCell(struct renderer* self,
+                             int y, int x,
+                             chtype symbol,
+                             enum ColorPairs color_pair)
+{
+    struct renderRecorder* rec = (struct renderRecorder*)self;
+
+    rec->cells_drawn++;
+    if (rec->len >= rec->capacity) {
+        rec->dropped++;
+        return;
+    }
+
+    struct renderedCell* c = &rec->cells[rec->len++];
+    c->y = y;
+    c->x = x;
+    c->symbol = symbol;
+    c->color_pair = color_pair;
+}
+
+static void recorderPresent(struct renderer* self)
+{
+    ((struct renderRecorder*)self)->frames++;
+}
+
+void initializeRecorderRenderer(struct renderRecorder* arec,
+                                struct renderedCell* cells,
+                                int capacity)
+{
+    arec->base.drawCell    = recorderDrawCell;
+    arec->base.present     = recorderPresent;
+    arec->base.checkSize   = nullCheckSize;
+    arec->base.is_terminal = false;
+    arec->base.has_output  = true;
+
+    arec->cells       = cells;
+    arec->capacity    = capacity;
+    arec->len         = 0;
+    arec->cells_drawn = 0;
+    arec->dropped     = 0;
+    arec->frames      = 0;
+}
+
+// ============================================================================
+//  Framebuffer
+// ============================================================================
+
+// Obergrenze der Bytes je Zelle: Cursor setzen (ESC [ zzzz ; ssss H),
+// Farbe (ESC [ 3f ; 4h m) und das Zeichen selbst
+#define FRAME_CELL_BYTES 24
+
+// Reserve für das Frame-Ende (Attribute zurücksetzen, Cursor zurück)
+#define FRAME_TAIL_BYTES 32
+
+// Längste Lücke aus unveränderten Zellen, die statt eines Cursorsprungs
+// noch einmal gesendet wird (ein Sprung kostet mindestens 4 Bytes)
+#define FRAME_MAX_GAP 3
+
+// Schreibt value dezimal nach p und liefert das Ende.
+static char* appendInt(char* p, int value)
+{
+    char digits[12];
+    int n = 0;
+
+    do {
+        digits[n++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value > 0);
+
+    while (n > 0) {
+        *p++ = digits[--n];
+    }
+    return p;
+}
+
+// ESC [ y ; x H mit 1-basierten Koordinaten
+static char* appendCursorTo(char* p, int y, int x)
+{
+    *p++ = '\033';
+    *p++ = '[';
+    p = appendInt(p, y + 1);
+    *p++ = ';';
+    p = appendInt(p, x + 1);
+    *p++ = 'H';
+    return p;
+}
+
+// ESC [ n C: Cursor n Spalten nach rechts (innerhalb einer Zeile)
+static char* appendCursorForward(char* p, int n)
+{
+    *p++ = '\033';
+    *p++ = '[';
+    p = appendInt(p, n);
+    *p++ = 'C';
+    return p;
+}
+
+static inline bool sameCell(struct frameCell a, struct frameCell b)
+{
+    return a.symbol == b.symbol && a.color_pair == b.color_pair;
+}
+
+// Ist die Lücke front[from .. to - 1] bekannt und in Farbpaar pair, kann sie
+// mit den alten Zeichen überschrieben werden.
+static bool gapIsReusable(const struct frameCell* front, int from, int to, int pair)
+{
+    for (int x = from; x < to; x++) {
+        if (front[x].symbol == 0 || front[x].color_pair != pair) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Sequenzen je Farbpaar aus den ncurses-Farben (COLOR_BLACK .. COLOR_WHITE
+// entsprechen den ANSI-Farben 0 .. 7); ohne Farben nur Attribute zurück.
+static void buildColorTable(struct frameRenderer* fb)
+{
+    for (int pair = 0; pair < FRAME_PAIRS; pair++) {
+        short fg = -1;
+        short bg = -1;
+        char* p = fb->sgr[pair];
+
+        if (has_colors()) {
+            pair_content(pair, &fg, &bg);
+        }
+
+        *p++ = '\033';
+        *p++ = '[';
+        *p++ = '0';
+        if (fg >= 0 && fg < 8) {
+            *p++ = ';';
+            p = appendInt(p, 30 + fg);
+        }
+        if (bg >= 0 && bg < 8) {
+            *p++ = ';';
+            p = appendInt(p, 40 + bg);
+        }
+        *p++ = 'm';
+        fb->sgr_len[pair] = (uint8_t)(p - fb->sgr[pair]);
+    }
+}
+
+static void frameDrawCell(struct renderer* self,
+                          int y, int x,
+                          chtype symbol,
+                          enum ColorPairs color_pair)
+{
+    struct frameRenderer* fb = (struct frameRenderer*)self;
+
+    if (y < 0 || y >= fb->rows || x < 0 || x >= fb->cols ||
+        color_pair < 0 || color_pair >= FRAME_PAIRS) {
+        return;
+    }
+
+    struct frameCell* c = &fb->back[(long)y * fb->cols + x];
+    c->symbol = (uint8_t)(symbol & A_CHARTEXT);
+    c->color_pair = (uint8_t)color_pair;
+}
+
+// ----------------------------------------------------------------------------
+//  buildFrame
+// ----------------------------------------------------------------------------
+// Vorgehen:
+//    - Zeile für Zelle back mit front vergleichen, gleiche Zellen überspringen
+//    - vor einer geänderten Zelle den Cursor nur bewegen, wenn er nicht schon
+//      dort steht: kurze Lücke gleicher Farbe überschreiben, sonst in der
+//      Zeile vorrücken (CUF) oder springen (CUP)
+//    - Farbe nur beim Wechsel des Farbpaars senden
+//    - front nachziehen
+// Liefert die Anzahl der Bytes in fb->out.
+// ----------------------------------------------------------------------------
+static long buildFrame(struct frameRenderer* fb)
+{
+    char* p = fb->out;
+    int cur_y = -1;             // Cursor unbekannt
+    int cur_x = -1;
+    int cur_pair = -1;          // Farbe unbekannt
+
+    for (int y = 0; y < fb->rows; y++) {
+        struct frameCell* back  = &fb->back[(long)y * fb->cols];
+        struct frameCell* front = &fb->front[(long)y * fb->cols];
+
+        for (int x = 0; x < fb->cols; x++) {
+            if (sameCell(back[x], front[x])) {
+                continue;
+            }
+
+            if (y != cur_y || x < cur_x) {
+                p = appendCursorTo(p, y, x);
+            } else if (x > cur_x) {
+                if (x - cur_x <= FRAME_MAX_GAP &&
+                    gapIsReusable(front, cur_x, x, cur_pair)) {
+                    for (int g = cur_x; g < x; g++) {
+                        *p++ = (char)front[g].symbol;
+                    }
+                } else {
+                    p = appendCursorForward(p, x - cur_x);
+                }
+            }
+
+            if (back[x].color_pair != cur_pair) {
+                cur_pair = back[x].color_pair;
+                memcpy(p, fb->sgr[cur_pair], fb->sgr_len[cur_pair]);
+                p += fb->sgr_len[cur_pair];
+            }
+
+            *p++ = (char)back[x].symbol;
+            front[x] = back[x];
+            cur_y = y;
+            cur_x = x + 1;
+            fb->cells++;
+        }
+    }
+
+    if (p != fb->out) {
+        int y, x;
+
+        // ncurses erwartet normale Attribute und seinen eigenen Cursor
+        memcpy(p, "\033[0m", 4);
+        p += 4;
+        getyx(curscr, y, x);
+        p = appendCursorTo(p, y, x);
+    }
+    return p - fb->out;
+}
+
+// Schreibt den Frame; mehr als ein write() nur, wenn das Terminal nicht
+// alles auf einmal annimmt.
+static void writeFrame(struct frameRenderer* fb, long len)
+{
+    const char* p = fb->out;
+
+    while (len > 0) {
+        ssize_t n = write(fb->fd, p, len);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;
+        }
+        p += n;
+        len -= n;
+    }
+}
+
+static void framePresent(struct renderer* self)
+{
+    struct frameRenderer* fb = (struct frameRenderer*)self;
+
+    // Ein ausstehendes clear() löscht gleich den ganzen Bildschirm
+    if (is_cleared(stdscr) || is_cleared(curscr)) {
+        memset(fb->front, 0, (size_t)fb->rows * fb->cols * sizeof(struct frameCell));
+        fb->full_redraws++;
+    }
+    refresh();
+
+    long len = buildFrame(fb);
+
+    fb->frames++;
+    if (len > 0) {
+        writeFrame(fb, len);
+        fb->frames_sent++;
+        fb->bytes += len;
+        if (len > fb->max_bytes) {
+            fb->max_bytes = len;
+        }
+    }
+}
+
+enum ResCodes initializeFrameRenderer(struct frameRenderer* afb, int fd)
+{
+    size_t cells = (size_t)LINES * COLS;
+
+    afb->base.drawCell    = frameDrawCell;
+    afb->base.present     = framePresent;
+    afb->base.checkSize   = cursesCheckSize;
+    afb->base.is_terminal = true;
+    afb->base.has_output  = true;
+
+    afb->rows = LINES;
+    afb->cols = COLS;
+    afb->fd   = fd;
+    afb->out_capacity = (long)cells * FRAME_CELL_BYTES + FRAME_TAIL_BYTES;
+
+    afb->front = calloc(cells, sizeof(struct frameCell));
+    afb->back  = calloc(cells, sizeof(struct frameCell));
+    afb->out   = malloc(afb->out_capacity);
+    if (afb->front == NULL || afb->back == NULL || afb->out == NULL) {
+        freeFrameRenderer(afb);
+        return RES_FAILED;
+    }
+
+    buildColorTable(afb);
+    return RES_OK;
+}
+
+void freeFrameRenderer(struct frameRenderer* afb)
+{
+    free(afb->front);
+    free(afb->back);
+    free(afb->out);
+    afb->front = NULL;
+    afb->back  = NULL;
+    afb->out   = NULL;
+}
@@ -0,0 +1,167 @@
+// Worm070 - Aufgabenblatt 8
+// ============================================================================
+//  render.h – Austauschbare Ausgabeschicht für Spielfeld und Wurm
+//
+//  Idee:
+//    Die Modelle (board_model.c, worm_model.c) verändern nur noch den
+//    logischen Zustand des Spielfelds. Die sichtbare Ausgabe wird über einen
+//    Renderer erledigt, der über Funktionszeiger angesprochen wird.
+//    Dadurch kann dieselbe Spiellogik
+//
+//      - mit ncurses im Terminal             (getCursesRenderer)
+//      - mit eigenem Bildpuffer im Terminal  (initializeFrameRenderer)
+//      - ganz ohne Ausgabe ("headless")      (getNullRenderer)
+//      - mit Mitschnitt aller Zeichenbefehle (initializeRecorderRenderer)
+//
+//    betrieben werden. Im Headless-Betrieb kostet eine Zellausgabe nur noch
+//    einen leeren Funktionsaufruf statt move/attron/addch/attroff.
+// ============================================================================
+
+#ifndef _RENDER_H
+#define _RENDER_H
+
+#include <curses.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "worm.h"
+
+// ============================================================================
+//  struct renderer – Schnittstelle eines Renderers
+//
+//  drawCell:
+//    Zeichnet symbol mit dem Farbpaar color_pair an Position (y, x).
+//
+//  present:
+//    Schließt einen Frame ab und macht die Änderungen sichtbar
+//    (bei ncurses: refresh()).
+//
+//  checkSize:
+//    Prüft, ob die Ausgabefläche rows x cols Zellen darstellen kann.
+//    Liefert RES_OK oder RES_FAILED. Renderer ohne echte Ausgabefläche
+//    liefern immer RES_OK.
+//
+//  is_terminal:
+//    true, wenn der Renderer in ein Terminal schreibt.
+//
+//  has_output:
+//    false beim Null-Renderer. Dann sammelt das Board gar keine geänderten
+//    Zellen, sondern verwirft Ausgaben sofort.
+// ============================================================================
+
+struct renderer {
+    void (*drawCell)(struct renderer* self,
+                     int y, int x,
+                     chtype symbol,
+                     enum ColorPairs color_pair);
+    void (*present)(struct renderer* self);
+    enum ResCodes (*checkSize)(struct renderer* self, int rows, int cols);
+    bool is_terminal;
+    bool has_output;
+};
+
+// ============================================================================
+//  Recorder – zeichnet alle Ausgaben in einen Puffer des Aufrufers auf
+//
+//  Gedacht für Regressionsläufe: Die aufgezeichneten Zellen können mit einer
+//  Referenz verglichen werden, ohne dass ein Terminal benötigt wird.
+//  Ist der Puffer voll, wird nur noch gezählt (dropped).
+// ============================================================================
+
+struct renderedCell {
+    int y;
+    int x;
+    chtype symbol;
+    enum ColorPairs color_pair;
+};
+
+struct renderRecorder {
+    struct renderer base;        // muss das erste Element sein
+
+    struct renderedCell* cells;  // Puffer des Aufrufers
+    int capacity;                // Größe des Puffers
+    int len;                     // Anzahl der aufgezeichneten Zellen
+
+    long cells_drawn;            // alle drawCell-Aufrufe
+    long dropped;                // wegen vollem Puffer nicht aufgezeichnet
+    long frames;                 // Anzahl present-Aufrufe
+};
+
+// ============================================================================
+//  Framebuffer – eigener Bildpuffer mit einem write() pro Frame
+//
+//  Idee:
+//    Der ncurses-Renderer ruft für jede Zelle move/attron/addch/attroff auf.
+//    Dieser Renderer schreibt drawCell() nur in den hinteren Puffer (back).
+//    present() vergleicht back mit dem vorderen Puffer (front, der Stand auf
+//    dem Bildschirm) und baut für alle geänderten Zellen eine Byte-Folge:
+//
+//      - Cursor nur positionieren, wenn er nicht schon an der Zelle steht;
+//        kurze Lücken in derselben Farbe werden mit den alten Zeichen
+//        überschrieben (billiger als eine Escape-Sequenz)
+//      - Farbe (SGR) nur senden, wenn sich das Farbpaar ändert, so dass
+//        ein Lauf gleicher Farbe eine einzige Sequenz bekommt
+//
+//    Der ganze Frame geht mit einem write() an das Terminal.
+//
+//  Zusammenspiel mit ncurses:
+//    Statuszeilen und Dialoge zeichnet weiterhin ncurses (messages.c). Die
+//    Zellen des Spielfelds berührt ncurses nie, sein refresh() gibt dort also
+//    nichts aus. present() ruft zuerst refresh() und setzt den Cursor am Ende
+//    dorthin zurück, wo ncurses ihn erwartet. Ein clear() (Startbildschirm)
+//    löscht den ganzen Bildschirm; dann wird front verworfen und das Feld
+//    beim nächsten present() vollständig gesendet.
+//
+//  Gezählt werden Frames, gesendete Bytes und Zellen: die Ausgabemenge je
+//  Frame ist bei langsamen SSH-Verbindungen und Multiplexern das Nadelöhr.
+// ============================================================================
+
+#define FRAME_PAIRS (COLP_WORM_HEAD + 1)   // Farbpaare 0 .. COLP_WORM_HEAD
+
+struct frameCell {
+    uint8_t symbol;             // 0: nie gezeichnet bzw. unbekannt
+    uint8_t color_pair;
+};
+
+struct frameRenderer {
+    struct renderer base;       // muss das erste Element sein
+
+    int rows;                   // Bildschirmgröße beim Anlegen
+    int cols;
+    struct frameCell* front;    // Stand auf dem Bildschirm
+    struct frameCell* back;     // Stand nach den drawCell-Aufrufen
+
+    char* out;                  // Byte-Folge des aktuellen Frames
+    long out_capacity;
+    int fd;                     // Ausgabe, meist STDOUT_FILENO
+
+    char sgr[FRAME_PAIRS][16];  // Escape-Sequenz je Farbpaar
+    uint8_t sgr_len[FRAME_PAIRS];
+
+    long frames;                // present-Aufrufe
+    long frames_sent;           // davon mit Ausgabe
+    long bytes;                 // gesendete Bytes insgesamt
+    long max_bytes;             // größter Frame
+    long cells;                 // gesendete (geänderte) Zellen
+    long full_redraws;          // verworfene front-Puffer (clear())
+};
+
+// Liefert den (einzigen) ncurses-Renderer.
+extern struct renderer* getCursesRenderer(void);
+
+// Liefert einen Renderer, der nichts ausgibt.
+extern struct renderer* getNullRenderer(void);
+
+// Initialisiert einen Recorder mit einem Puffer für capacity Zellen.
+// Der Renderer steht danach über &arec->base zur Verfügung.
+extern void initializeRecorderRenderer(struct renderRecorder* arec,
+                                       struct renderedCell* cells,
+                                       int capacity);
+
+// Legt die Puffer für den ganzen Bildschirm (LINES x COLS) an; ncurses und
+// die Farben müssen bereits initialisiert sein. Ausgegeben wird auf fd.
+// afb muss mit Nullen initialisiert sein. Liefert RES_OK oder RES_FAILED.
+extern enum ResCodes initializeFrameRenderer(struct frameRenderer* afb, int fd);
+
+extern void freeFrameRenderer(struct frameRenderer* afb);
+
+#endif  // _RENDER_H
@@ -0,0 +1,334 @@
+// Worm070 - Aufgabenblatt 8
+// ============================================================================
+//  Modul: replay.c  –  Aufzeichnung und Wiedergabe von Spielen
+// ============================================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "worm.h"
+#include "board_model.h"
+#include "worm_model.h"
+#include "render.h"
+#include "headless.h"
+#include "replay.h"
+
+#define REPLAY_MAGIC       "WRPL"
+#define REPLAY_HEADER_SIZE 20
+
+// ============================================================================
+//  Hilfsfunktionen für das Dateiformat
+// ============================================================================
+
+static void putLE(uint8_t* buf, uint64_t value, int bytes)
+{
+    for (int i = 0; i < bytes; i++) {
+        buf[i] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+static uint64_t getLE(const uint8_t* buf, int bytes)
+{
+    uint64_t value = 0;
+    for (int i = 0; i < bytes; i++) {
+        value |= (uint64_t)buf[i] << (8 * i);
+    }
+    return value;
+}
+
+// LEB128: 7 Bit pro Byte, höchstes Bit = es folgt noch ein Byte
+static void writeVarint(FILE* f, unsigned long value)
+{
+    while (value >= 0x80) {
+        fputc((int)(value & 0x7f) | 0x80, f);
+        value >>= 7;
+    }
+    fputc((int)value, f);
+}
+
+static bool readVarint(struct replay* areplay, long* apos, unsigned long* avalue)
+{
+    unsigned long value = 0;
+    int shift = 0;
+
+    while (*apos < areplay->size && shift < 64) {
+        uint8_t byte = areplay->data[(*apos)++];
+        value |= (unsigned long)(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) {
+            *avalue = value;
+            return true;
+        }
+        shift += 7;
+    }
+    return false;
+}
+
+// ============================================================================
+//  Aufzeichnung
+// ============================================================================
+
+enum ResCodes openReplayWriter(struct replayWriter* awriter,
+                               const char* path,
+                               uint64_t seed,
+                               int rows, int cols)
+{
+    uint8_t header[REPLAY_HEADER_SIZE] = {0};
+
+    awriter->file = fopen(path, "wb");
+    if (awriter->file == NULL) {
+        return RES_FAILED;
+    }
+
+    memcpy(header, REPLAY_MAGIC, 4);
+    header[4] = REPLAY_VERSION;
+    putLE(header + 8, seed, 8);
+    putLE(header + 16, (uint64_t)rows, 2);
+    putLE(header + 18, (uint64_t)cols, 2);
+    fwrite(header, 1, sizeof(header), awriter->file);
+
+    awriter->tick      = 0;
+    awriter->last_tick = 0;
+    awriter->events    = 0;
+    return RES_OK;
+}
+
+void recordReplayEvent(struct replayWriter* awriter, enum ReplayEvents event)
+{
+    writeVarint(awriter->file, awriter->tick - awriter->last_tick);
+    fputc((int)event, awriter->file);
+
+    awriter->last_tick = awriter->tick;
+    awriter->events++;
+}
+
+void endReplayTick(struct replayWriter* awriter)
+{
+    awriter->tick++;
+}
+
+enum ResCodes closeReplayWriter(struct replayWriter* awriter,
+                                enum GameStates final_state,
+                                int worm_length)
+{
+    recordReplayEvent(awriter, REPLAY_EV_END);
+    fputc((int)final_state, awriter->file);
+    writeVarint(awriter->file, (unsigned long)worm_length);
+
+    bool failed = ferror(awriter->file) != 0;
+    if (fclose(awriter->file) != 0) {
+        failed = true;
+    }
+    awriter->file = NULL;
+    return failed ? RES_FAILED : RES_OK;
+}
+
+// ============================================================================
+//  Einlesen
+// ============================================================================
+
+enum ResCodes loadReplay(struct replay* areplay, const char* path)
+{
+    FILE* f = fopen(path, "rb");
+    if (f == NULL) {
+        return RES_FAILED;
+    }
+
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+
+    areplay->data = (size > 0) ? malloc(size) : NULL;
+    areplay->size = size;
+
+    bool ok = areplay->data != NULL &&
+              fread(areplay->data, 1, size, f) == (size_t)size;
+    fclose(f);
+
+    ok = ok && size >= REPLAY_HEADER_SIZE &&
+         memcmp(areplay->data, REPLAY_MAGIC, 4) == 0 &&
+         areplay->data[4] == REPLAY_VERSION;
+
+    if (!ok) {
+        freeReplay(areplay);
+        return RES_FAILED;
+    }
+
+    areplay->seed = getLE(areplay->data + 8, 8);
+    areplay->rows = (int)getLE(areplay->data + 16, 2);
+    areplay->cols = (int)getLE(areplay->data + 18, 2);
+    return RES_OK;
+}
+
+void freeReplay(struct replay* areplay)
+{
+    free(areplay->data);
+    areplay->data = NULL;
+    areplay->size = 0;
+}
+
+// ============================================================================
+//  Wiedergabe
+// ============================================================================
+
+// Cursor über die Ereignisse einer Replay-Datei
+struct replayCursor {
+    long pos;                   // Leseposition in data
+    unsigned long tick;         // Takt des aktuellen Ereignisses
+    enum ReplayEvents event;    // aktuelles Ereignis
+    bool valid;                 // false: Daten zu Ende oder beschädigt
+};
+
+static void nextReplayEvent(struct replay* areplay, struct replayCursor* acur)
+{
+    unsigned long delta;
+
+    acur->valid = readVarint(areplay, &acur->pos, &delta) &&
+                  acur->pos < areplay->size &&
+                  areplay->data[acur->pos] <= REPLAY_EV_END;
+    if (acur->valid) {
+        acur->tick += delta;
+        acur->event = (enum ReplayEvents)areplay->data[acur->pos++];
+    }
+}
+
+// ----------------------------------------------------------------------------
+//  playReplay
+// ----------------------------------------------------------------------------
+// Ablauf pro Takt (wie die Schrittschleife in doLevel()):
+//    - alle Ereignisse dieses Takts anwenden
+//    - Schritt ausführen, außer pausiert ohne Richtungstaste oder beendet
+//    - bei Ausgabe: Wurm vormerken, jeden frame_every-ten Takt darstellen
+// Endet mit REPLAY_EV_END oder wenn das Spiel vorher endet (dann stimmt die
+// Wiedergabe nicht mit der Aufzeichnung überein).
+// ----------------------------------------------------------------------------
+enum ResCodes playReplay(struct replay* areplay,
+                         struct renderer* arenderer,
+                         int frame_every,
+                         struct replayResult* aresult)
+{
+    struct board theBoard = {0};
+    struct worm  theWorm  = {0};
+    struct replayCursor cur = { REPLAY_HEADER_SIZE, 0, REPLAY_EV_END, false };
+    struct timespec start, end;
+    enum GameStates game_state = WORM_GAME_ONGOING;
+    bool paused = false;
+    bool output = arenderer->has_output;
+    enum ResCodes res = RES_OK;
+
+    if (frame_every < 1) {
+        frame_every = 1;
+    }
+
+    if (startGame(&theBoard, &theWorm, arenderer,
+                  areplay->rows, areplay->cols) != RES_OK) {
+        freeBoard(&theBoard);
+        freeWorm(&theWorm);
+        return RES_FAILED;
+    }
+
+    if (output) {
+        renderBoard(&theBoard);
+        showWholeWorm(&theBoard, &theWorm);
+        presentBoard(&theBoard);
+    }
+
+    aresult->ticks = 0;
+    aresult->moves = 0;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    nextReplayEvent(areplay, &cur);
+
+    for (;;) {
+        bool step = false;
+
+        if (!cur.valid) {
+            res = RES_FAILED;       // Datei endet ohne Abschluss
+            break;
+        }
+        if (cur.event == REPLAY_EV_END && cur.tick == aresult->ticks) {
+            break;
+        }
+
+        while (cur.valid && cur.tick == aresult->ticks &&
+               cur.event != REPLAY_EV_END) {
+            switch (cur.event) {
+                case REPLAY_EV_GROW:
+                    growWorm(&theWorm, BONUS_MANUAL);
+                    break;
+                case REPLAY_EV_PAUSE:
+                    paused = true;
+                    break;
+                case REPLAY_EV_UNPAUSE:
+                    paused = false;
+                    break;
+                case REPLAY_EV_QUIT:
+                    game_state = WORM_GAME_QUIT;
+                    break;
+                default:
+                    setWormHeading(&theWorm,
+                                   (enum WormHeading)(cur.event - REPLAY_EV_HEADING_0));
+                    step = true;
+                    break;
+            }
+            nextReplayEvent(areplay, &cur);
+        }
+
+        if (game_state == WORM_GAME_ONGOING && (!paused || step)) {
+            cleanWormTail(&theBoard, &theWorm);
+            moveWorm(&theBoard, &theWorm, &game_state);
+            aresult->moves++;
+
+            if (output && game_state == WORM_GAME_ONGOING) {
+                showWorm(&theBoard, &theWorm);
+            }
+        }
+        aresult->ticks++;
+
+        if (output && aresult->ticks % frame_every == 0) {
+            presentBoard(&theBoard);
+        }
+
+        if (game_state != WORM_GAME_ONGOING) {
+            break;
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    aresult->seconds = (end.tv_sec - start.tv_sec)
+                     + (end.tv_nsec - start.tv_nsec) * 1e-9;
+
+    if (output) {
+        presentBoard(&theBoard);
+    }
+
+    aresult->state  = game_state;
+    aresult->length = getWormLength(&theWorm);
+
+    // Der Abschluss steht erst nach dem Ende des Spiels; ggf. bis dorthin
+    // weiterlesen
+    while (cur.valid && cur.event != REPLAY_EV_END) {
+        nextReplayEvent(areplay, &cur);
+    }
+
+    unsigned long recorded_length = 0;
+    if (res == RES_OK && cur.valid && cur.pos < areplay->size) {
+        aresult->recorded_state = (enum GameStates)areplay->data[cur.pos++];
+        if (!readVarint(areplay, &cur.pos, &recorded_length)) {
+            res = RES_FAILED;
+        }
+        aresult->recorded_length = (int)recorded_length;
+    } else {
+        res = RES_FAILED;
+    }
+
+    aresult->matches = res == RES_OK &&
+                       cur.tick == aresult->ticks &&
+                       aresult->state == aresult->recorded_state &&
+                       aresult->length == aresult->recorded_length;
+
+    freeWorm(&theWorm);
+    freeBoard(&theBoard);
+    return res;
+}
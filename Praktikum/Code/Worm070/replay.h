@@ -0,0 +1,130 @@
+// Worm070 - Aufgabenblatt 8
+// ============================================================================
+//  replay.h – Aufzeichnung und Wiedergabe von Spielen
+//
+//  Ein Replay enthält alles, um ein Spiel exakt zu wiederholen: Level-Seed,
+//  Spielfeldgröße und die Eingaben pro Spieltakt. Die Spiellogik ist
+//  deterministisch, die Eingaben sind also der einzige Zufall.
+//
+//  Ein Spieltakt ist ein Aufruf von readUserInput() in doLevel(), also ein
+//  Durchlauf der Schrittschleife (auch während der Pause). Wiedergegeben
+//  wird mit derselben Regel wie in doLevel(): nach den Ereignissen eines
+//  Takts macht der Wurm einen Schritt, außer das Spiel ist pausiert und
+//  es kam keine Richtungstaste.
+//
+//  Dateiformat (Little Endian):
+//
+//    Kopf, 20 Byte:
+//      "WRPL"          Magic
+//      u8  version     REPLAY_VERSION
+//      u8  reserviert  (3 Byte, 0)
+//      u64 seed        Level-Seed, 0 = festes Standardlevel
+//      u16 rows, cols  Spielfeldgröße
+//
+//    Ereignisse, je:
+//      varint delta    Takte seit dem vorigen Ereignis (LEB128)
+//      u8  event       enum ReplayEvents
+//
+//    Abschluss (event REPLAY_EV_END, delta bis zum Spielende), danach:
+//      u8  state       enum GameStates am Ende
+//      varint length   Wurmlänge am Ende
+//    Damit kann der Player prüfen, ob die Wiedergabe übereinstimmt.
+//
+//  Eine typische Partie braucht damit nur wenige Byte pro Tastendruck.
+// ============================================================================
+
+#ifndef _REPLAY_H
+#define _REPLAY_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "worm.h"
+#include "render.h"
+#include "headless.h"
+
+#define REPLAY_VERSION 3
+
+// ---------------------------------------------------------------------------
+//  enum ReplayEvents
+// ---------------------------------------------------------------------------
+//  REPLAY_EV_HEADING_0 + dir: Richtungstaste (enum WormHeading), löst auch
+//  während der Pause einen Einzelschritt aus.
+// ---------------------------------------------------------------------------
+enum ReplayEvents {
+    REPLAY_EV_HEADING_0 = 0,
+    REPLAY_EV_GROW      = REPLAY_EV_HEADING_0 + WORM_HEADINGS,  // Taste g
+    REPLAY_EV_PAUSE,                                            // Taste s
+    REPLAY_EV_UNPAUSE,                                          // Leertaste
+    REPLAY_EV_QUIT,                                             // Taste q
+    REPLAY_EV_END
+};
+
+// ---------------------------------------------------------------------------
+//  Aufzeichnung
+// ---------------------------------------------------------------------------
+struct replayWriter {
+    FILE* file;
+    unsigned long tick;         // aktueller Spieltakt
+    unsigned long last_tick;    // Takt des zuletzt geschriebenen Ereignisses
+    long events;                // geschriebene Ereignisse
+};
+
+// Legt die Datei an und schreibt den Kopf. RES_FAILED, wenn das nicht geht.
+extern enum ResCodes openReplayWriter(struct replayWriter* awriter,
+                                      const char* path,
+                                      uint64_t seed,
+                                      int rows, int cols);
+
+// Hält ein Ereignis im aktuellen Takt fest.
+extern void recordReplayEvent(struct replayWriter* awriter,
+                              enum ReplayEvents event);
+
+// Schließt den aktuellen Takt ab (nach jedem readUserInput()).
+extern void endReplayTick(struct replayWriter* awriter);
+
+// Schreibt den Abschluss mit Endzustand und Wurmlänge und schließt die Datei.
+extern enum ResCodes closeReplayWriter(struct replayWriter* awriter,
+                                       enum GameStates final_state,
+                                       int worm_length);
+
+// ---------------------------------------------------------------------------
+//  Wiedergabe
+// ---------------------------------------------------------------------------
+struct replay {
+    uint64_t seed;
+    int rows;
+    int cols;
+
+    uint8_t* data;              // komplette Datei im Speicher
+    long size;
+};
+
+struct replayResult {
+    unsigned long ticks;        // wiedergegebene Spieltakte
+    long moves;                 // ausgeführte Spielschritte
+    double seconds;             // Laufzeit der Wiedergabe
+
+    enum GameStates state;              // Endzustand der Wiedergabe
+    int length;                         // Wurmlänge am Ende
+    enum GameStates recorded_state;     // laut Datei
+    int recorded_length;                // laut Datei
+    bool matches;                       // Wiedergabe == Aufzeichnung
+};
+
+// Liest eine Replay-Datei komplett ein und prüft Kopf und Version.
+extern enum ResCodes loadReplay(struct replay* areplay, const char* path);
+
+// Gibt den Speicher des Replays frei.
+extern void freeReplay(struct replay* areplay);
+
+// Spielt das Replay ab. Mit dem Null-Renderer läuft es so schnell wie die
+// Spiellogik. Mit einem Renderer mit Ausgabe wird nur jeder frame_every-te
+// Takt dargestellt (presentBoard()), ohne zu warten.
+// RES_FAILED bei beschädigten Daten.
+extern enum ResCodes playReplay(struct replay* areplay,
+                                struct renderer* arenderer,
+                                int frame_every,
+                                struct replayResult* aresult);
+
+#endif  // _REPLAY_H
@@ -0,0 +1,107 @@
+// Worm070 - Aufgabenblatt 8
+// ============================================================================
+//  rng.h – Zählerbasierte Zufallszahlen mit unabhängigen Strömen
+//
+//  Idee (zählerbasiert, wie Philox/Threefry):
+//    Die n-te Zahl eines Stroms ist eine feste Funktion von Schlüssel und
+//    Zähler: rngAt(key, n). Der Zustand eines Stroms besteht nur aus diesen
+//    beiden Wörtern; es gibt nichts Gemeinsames zwischen Strömen, also
+//    keine Sperren und keine Abhängigkeit von Threadanzahl oder Reihenfolge.
+//
+//    Mischfunktion: zwei Runden des SplitMix64-Finalizers, die erste über
+//    Zähler * Goldener Schnitt + Schlüssel, die zweite zusätzlich mit dem
+//    Schlüssel verknüpft. Der Finalizer ist bijektiv, aufeinanderfolgende
+//    Zähler liefern also nie dieselbe Zahl innerhalb von 2^64 Werten.
+//
+//  Ströme:
+//    initRngStream(seed, stream) leitet den Schlüssel aus Seed und einer
+//    Stromnummer ab (z. B. Nummer des Spiels, des Levels, des Pakets).
+//    splitRngStream() leitet aus einem Strom Kinderströme ab, ohne ihn zu
+//    verändern. Beides kostet eine Mischung, ist also billig genug für
+//    tausende Spiele oder einen Strom pro Arbeitspaket.
+//
+//    Wer Ergebnisse unabhängig von der Threadanzahl will, nummeriert die
+//    Ströme nach der Arbeit (Spiel i, Level k), nicht nach dem Thread.
+//
+//  Ziehen:
+//    rngNext()    64 Bit
+//    rngBelow()   gleichverteilt in 0 .. n - 1 (Lemire: Multiplikation,
+//                 Verwerfen nur im seltenen Randbereich, kein Modulo im
+//                 Normalfall)
+//    rngUnit()    double in [0, 1) mit 53 Bit
+// ============================================================================
+
+#ifndef _RNG_H
+#define _RNG_H
+
+#include <stdint.h>
+
+#define RNG_GOLDEN 0x9e3779b97f4a7c15ULL
+
+// ---------------------------------------------------------------------------
+//  struct rngStream – Schlüssel und Zähler (16 Byte, POD)
+// ---------------------------------------------------------------------------
+struct rngStream {
+    uint64_t key;
+    uint64_t counter;           // Nummer der nächsten Zahl
+};
+
+// Finalizer aus SplitMix64
+static inline uint64_t rngMix(uint64_t x)
+{
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+// Zahl Nummer counter des Stroms mit Schlüssel key
+static inline uint64_t rngAt(uint64_t key, uint64_t counter)
+{
+    return rngMix(rngMix(counter * RNG_GOLDEN + key) ^ key);
+}
+
+// Strom Nummer stream zu seed, beginnend bei der ersten Zahl
+static inline void initRngStream(struct rngStream* as, uint64_t seed, uint64_t stream)
+{
+    as->key     = rngMix(rngMix(seed) ^ (stream * RNG_GOLDEN + RNG_GOLDEN));
+    as->counter = 0;
+}
+
+// Kinderstrom Nummer id von parent (parent bleibt unverändert)
+static inline struct rngStream splitRngStream(const struct rngStream* parent, uint64_t id)
+{
+    struct rngStream child;
+    initRngStream(&child, parent->key, id);
+    return child;
+}
+
+static inline uint64_t rngNext(struct rngStream* as)
+{
+    return rngAt(as->key, as->counter++);
+}
+
+// Gleichverteilt in 0 .. n - 1, n > 0
+static inline uint32_t rngBelow(struct rngStream* as, uint32_t n)
+{
+    uint64_t m = (rngNext(as) >> 32) * n;
+
+    if ((uint32_t)m < n) {
+        // Randbereich: Werte unterhalb von 2^32 mod n verwerfen
+        uint32_t threshold = (uint32_t)(-n) % n;
+        while ((uint32_t)m < threshold) {
+            m = (rngNext(as) >> 32) * n;
+        }
+    }
+    return (uint32_t)(m >> 32);
+}
+
+// Gleichverteilt in [0, 1)
+static inline double rngUnit(struct rngStream* as)
+{
+    return (double)(rngNext(as) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+#endif  // _RNG_H
@@ -0,0 +1,337 @@
+// Worm070 - Aufgabenblatt 8
+// ============================================================================
+//  Modul: snapshot.c  –  Spielzustand sichern und wiederherstellen
+// ============================================================================
+
+#include <string.h>
+#include <stdatomic.h>
+
+#include "worm.h"
+#include "board_model.h"
+#include "worm_model.h"
+#include "bitboard.h"
+#include "reach.h"
+#include "snapshot.h"
+
+// Fortlaufende Nummer für gameSnapshot.id (auch aus mehreren Threads)
+static atomic_uint_least64_t next_snapshot_id = 1;
+
+// ============================================================================
+//  Hilfsfunktionen
+// ============================================================================
+
+// Daten direkt hinter dem Kopf
+static inline uint8_t* snapshotData(struct gameSnapshot* snap)
+{
+    return (uint8_t*)(snap + 1);
+}
+
+static inline const uint8_t* snapshotDataConst(const struct gameSnapshot* snap)
+{
+    return (const uint8_t*)(snap + 1);
+}
+
+// Größe des Zellblocks inklusive Rand (immer ein Vielfaches von 64)
+static inline long boardBytes(struct board* aboard)
+{
+    return (long)(aboard->last_row + 1 + 2 * BOARD_BORDER) * aboard->stride;
+}
+
+// Größen werden auf 8 Byte aufgerundet, damit Snapshots in einem Puffer
+// direkt hintereinander liegen können
+static inline size_t alignSize(size_t size)
+{
+    return (size + 7) & ~(size_t)7;
+}
+
+static inline uint64_t loadWord(const cell_t* p)
+{
+    uint64_t w;
+    memcpy(&w, p, sizeof(w));
+    return w;
+}
+
+static bool sameGeometry(struct board* aboard, const struct gameSnapshot* snap)
+{
+    return snap->rows == aboard->last_row + 1 &&
+           snap->cols == aboard->last_col + 1 &&
+           snap->stride == aboard->stride;
+}
+
+static void fillHeader(struct gameSnapshot* out,
+                       struct board* aboard,
+                       struct worm* aworm,
+                       enum GameStates game_state)
+{
+    out->flags      = 0;
+    out->id         = atomic_fetch_add(&next_snapshot_id, 1);
+    out->parent_id  = 0;
+    out->board_hash = aboard->hash;
+    out->worm_hash  = aworm->hash;
+    out->food_key     = aboard->food_rng.key;
+    out->food_counter = aboard->food_rng.counter;
+
+    out->rows        = aboard->last_row + 1;
+    out->cols        = aboard->last_col + 1;
+    out->stride      = aboard->stride;
+    out->food_items  = aboard->food_items;
+    out->food_eaten  = (int32_t)aboard->food_eaten;
+    out->game_state  = game_state;
+    out->cells_bytes = (uint32_t)boardBytes(aboard);
+    out->cell_words  = 0;
+
+    out->tail           = aworm->tail;
+    out->head           = aworm->head;
+    out->pending_growth = aworm->pending_growth;
+    out->maxlen         = aworm->maxlen;
+    out->heading        = aworm->heading;
+    out->head_y         = aworm->headpos.y;
+    out->head_x         = aworm->headpos.x;
+    out->wcolor         = aworm->wcolor;
+}
+
+// Kopiert die Segmente first .. first + count - 1 (Zähler) nach dst.
+static void copySegmentsOut(struct worm* aworm, unsigned int first,
+                            unsigned int count, uint8_t* dst)
+{
+    cellidx_t* segs = (cellidx_t*)dst;
+    for (unsigned int k = 0; k < count; k++) {
+        segs[k] = aworm->wormcells[(first + k) & aworm->mask];
+    }
+}
+
+// Übernimmt den Wurm aus dem Kopf und die gespeicherten Segmente. Segmente
+// vor seg_first müssen bereits in der Deque stehen (Delta).
+static enum ResCodes restoreWorm(struct worm* aworm,
+                                 const struct gameSnapshot* snap,
+                                 const uint8_t* segdata)
+{
+    unsigned int len = snap->head - snap->tail + 1;
+
+    if (reserveWormCells(aworm, len + snap->pending_growth) != RES_OK) {
+        return RES_FAILED;
+    }
+
+    const cellidx_t* segs = (const cellidx_t*)segdata;
+    for (unsigned int k = 0; k < snap->seg_count; k++) {
+        aworm->wormcells[(snap->seg_first + k) & aworm->mask] = segs[k];
+    }
+
+    aworm->tail           = snap->tail;
+    aworm->head           = snap->head;
+    aworm->pending_growth = snap->pending_growth;
+    aworm->maxlen         = snap->maxlen;
+    aworm->headpos.y      = snap->head_y;
+    aworm->headpos.x      = snap->head_x;
+    aworm->wcolor         = (enum ColorPairs)snap->wcolor;
+    aworm->hash           = snap->worm_hash;
+    setWormHeading(aworm, (enum WormHeading)snap->heading);
+    return RES_OK;
+}
+
+// ============================================================================
+//  snapshotSize / snapshotGame
+// ============================================================================
+
+size_t snapshotSize(struct board* aboard, struct worm* aworm)
+{
+    return alignSize(sizeof(struct gameSnapshot)
+                     + boardBytes(aboard)
+                     + sizeof(cellidx_t) * (size_t)(aworm->head - aworm->tail + 1));
+}
+
+static enum ResCodes snapshotFull(struct board* aboard,
+                                  struct worm* aworm,
+                                  enum GameStates game_state,
+                                  struct gameSnapshot* out,
+                                  size_t capacity)
+{
+    size_t size = snapshotSize(aboard, aworm);
+    if (size > capacity) {
+        return RES_FAILED;
+    }
+
+    fillHeader(out, aboard, aworm, game_state);
+    out->seg_first = aworm->tail;
+    out->seg_count = aworm->head - aworm->tail + 1;
+    out->size      = (uint32_t)size;
+
+    uint8_t* data = snapshotData(out);
+    memcpy(data, aboard->cells, out->cells_bytes);
+    copySegmentsOut(aworm, out->seg_first, out->seg_count, data + out->cells_bytes);
+    return RES_OK;
+}
+
+// ----------------------------------------------------------------------------
+//  Delta
+// ----------------------------------------------------------------------------
+// Vorgehen:
+//    - Zellblock wortweise mit dem Eltern-Snapshot vergleichen (erster
+//      Durchlauf zählt, zweiter schreibt Werte und Indizes)
+//    - Wurm: drop = am Schwanz entfernte Segmente seit dem Eltern-Snapshot.
+//      Liegt der Wurm noch (teilweise) auf den Eltern-Segmenten, werden nur
+//      die Segmente nach parent->head gespeichert, sonst alle.
+//    - ist das Delta nicht kleiner als ein vollständiger Snapshot, wird
+//      ein vollständiger geschrieben
+// ----------------------------------------------------------------------------
+enum ResCodes snapshotGame(struct board* aboard,
+                           struct worm* aworm,
+                           enum GameStates game_state,
+                           const struct gameSnapshot* parent,
+                           struct gameSnapshot* out,
+                           size_t capacity)
+{
+    if (parent == NULL) {
+        return snapshotFull(aboard, aworm, game_state, out, capacity);
+    }
+
+    if ((parent->flags & SNAPSHOT_DELTA) || !sameGeometry(aboard, parent)) {
+        return RES_FAILED;
+    }
+
+    const cell_t* old_cells = snapshotDataConst(parent);
+    long words = boardBytes(aboard) / sizeof(uint64_t);
+    uint32_t changed = 0;
+
+    for (long i = 0; i < words; i++) {
+        changed += loadWord(aboard->cells + i * 8) != loadWord(old_cells + i * 8);
+    }
+
+    unsigned int len  = aworm->head - aworm->tail + 1;
+    unsigned int plen = parent->head - parent->tail + 1;
+    unsigned int drop = aworm->tail - parent->tail;
+    unsigned int seg_first = aworm->tail;
+    unsigned int seg_count = len;
+
+    if (drop <= plen && aworm->head - parent->head <= len) {
+        seg_first = parent->head + 1;
+        seg_count = aworm->head - parent->head;
+    }
+
+    size_t size = alignSize(sizeof(struct gameSnapshot)
+                            + (size_t)changed * (sizeof(uint64_t) + sizeof(uint32_t))
+                            + sizeof(cellidx_t) * (size_t)seg_count);
+
+    if (size >= snapshotSize(aboard, aworm)) {
+        return snapshotFull(aboard, aworm, game_state, out, capacity);
+    }
+    if (size > capacity) {
+        return RES_FAILED;
+    }
+
+    fillHeader(out, aboard, aworm, game_state);
+    out->flags      = SNAPSHOT_DELTA;
+    out->parent_id  = parent->id;
+    out->cell_words = changed;
+    out->seg_first  = seg_first;
+    out->seg_count  = seg_count;
+    out->size       = (uint32_t)size;
+
+    uint8_t*  data    = snapshotData(out);
+    uint64_t* values  = (uint64_t*)data;
+    uint32_t* indices = (uint32_t*)(data + changed * sizeof(uint64_t));
+    uint32_t  k = 0;
+
+    for (long i = 0; i < words && k < changed; i++) {
+        uint64_t w = loadWord(aboard->cells + i * 8);
+        if (w != loadWord(old_cells + i * 8)) {
+            values[k]  = w;
+            indices[k] = (uint32_t)i;
+            k++;
+        }
+    }
+
+    copySegmentsOut(aworm, seg_first, seg_count, (uint8_t*)(indices + changed));
+    return RES_OK;
+}
+
+// ============================================================================
+//  restoreGame
+// ============================================================================
+
+static enum ResCodes restoreFull(struct board* aboard,
+                                 struct worm* aworm,
+                                 const struct gameSnapshot* snap)
+{
+    const uint8_t* data = snapshotDataConst(snap);
+
+    copyCellsToBoard(aboard, 0, data, snap->cells_bytes);
+    aboard->food_items = snap->food_items;
+    aboard->food_eaten = snap->food_eaten;
+    aboard->food_rng.key     = snap->food_key;
+    aboard->food_rng.counter = snap->food_counter;
+    aboard->hash       = snap->board_hash;
+
+    if (aboard->bits != NULL) {
+        loadBitboardFromBoard(aboard->bits, aboard);
+    }
+
+    return restoreWorm(aworm, snap, data + snap->cells_bytes);
+}
+
+static enum ResCodes restoreDelta(struct board* aboard,
+                                  struct worm* aworm,
+                                  const struct gameSnapshot* snap)
+{
+    const uint8_t*  data    = snapshotDataConst(snap);
+    const uint64_t* values  = (const uint64_t*)data;
+    const uint32_t* indices = (const uint32_t*)(data + snap->cell_words * sizeof(uint64_t));
+
+    for (uint32_t k = 0; k < snap->cell_words; k++) {
+        cell_t* dst = aboard->cells + (long)indices[k] * 8;
+
+        if (aboard->bits == NULL) {
+            copyCellsToBoard(aboard, (cellidx_t)(indices[k] * 8),
+                             (const cell_t*)&values[k], sizeof(uint64_t));
+        } else {
+            // Über setContentAtIndex(), damit das Bitboard mitläuft
+            const cell_t* src = (const cell_t*)&values[k];
+            cellidx_t base = (cellidx_t)(indices[k] * 8);
+            for (int b = 0; b < 8; b++) {
+                if (dst[b] != src[b]) {
+                    setContentAtIndex(aboard, base + b, (enum BoardCodes)src[b]);
+                }
+            }
+        }
+    }
+    aboard->food_items = snap->food_items;
+    aboard->food_eaten = snap->food_eaten;
+    aboard->food_rng.key     = snap->food_key;
+    aboard->food_rng.counter = snap->food_counter;
+    aboard->hash       = snap->board_hash;
+
+    return restoreWorm(aworm, snap,
+                       (const uint8_t*)(indices + snap->cell_words));
+}
+
+enum ResCodes restoreGame(struct board* aboard,
+                          struct worm* aworm,
+                          enum GameStates* agame_state,
+                          const struct gameSnapshot* snap,
+                          const struct gameSnapshot* parent)
+{
+    if (!sameGeometry(aboard, snap)) {
+        return RES_FAILED;
+    }
+
+    if (snap->flags & SNAPSHOT_DELTA) {
+        if (parent != NULL) {
+            if (parent->id != snap->parent_id ||
+                restoreFull(aboard, aworm, parent) != RES_OK) {
+                return RES_FAILED;
+            }
+        }
+        if (restoreDelta(aboard, aworm, snap) != RES_OK) {
+            return RES_FAILED;
+        }
+    } else if (restoreFull(aboard, aworm, snap) != RES_OK) {
+        return RES_FAILED;
+    }
+
+    if (aboard->reach != NULL) {
+        invalidateReach(aboard->reach, getWormHeadCell(aworm));
+    }
+
+    *agame_state = (enum GameStates)snap->game_state;
+    return RES_OK;
+}
@@ -0,0 +1,115 @@
+// Worm070 - Aufgabenblatt 8
+// ============================================================================
+//  snapshot.h – Spielzustand sichern und wiederherstellen
+//
+//  Ein Snapshot ist ein flacher Speicherblock ohne Zeiger (POD): er kann
+//  mit memcpy kopiert, in Arrays abgelegt oder in eine Datei geschrieben
+//  werden. Er enthält
+//
+//    - den kompletten Zellblock des Boards (inklusive Rand, 1 Byte/Zelle)
+//      und die Anzahl der Futterstücke, gefressenes Futter und den
+//      Zustand des Futtergenerators (gleiche Futterfolge nach Restore)
+//    - den Wurm: Zähler, Richtung, Wachstum und nur die tatsächlich
+//      belegten Segmente (Zellnummern vom Schwanz zum Kopf)
+//    - den Spielzustand (enum GameStates)
+//
+//  Delta-Snapshots:
+//    Eine Suche verzweigt von einem Zustand aus tausende Male, jeder Zweig
+//    ändert aber nur wenige Zellen. Ein Delta-Snapshot speichert gegenüber
+//    einem vollständigen Eltern-Snapshot nur
+//      - die geänderten 8-Byte-Wörter des Zellblocks (Index + Wert)
+//      - die seit dem Eltern-Snapshot neu angefügten Wurmsegmente
+//        (am Schwanz entfernte Segmente ergeben sich aus dem Zähler tail)
+//    Voraussetzung: der Zustand ist aus dem Eltern-Snapshot hervorgegangen
+//    (gleiches Spiel, keine neue initializeWorm()). Der Eltern-Snapshot
+//    muss selbst vollständig sein.
+//
+//  Aufbau: struct gameSnapshot als Kopf, dahinter die Daten
+//    vollständig:  Zellblock (cells_bytes), Segmente (seg_count)
+//    Delta:        Werte (cell_words * 8 Byte), Indizes (cell_words * 4
+//                  Byte), Segmente (seg_count)
+// ============================================================================
+
+#ifndef _SNAPSHOT_H
+#define _SNAPSHOT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "worm.h"
+#include "board_model.h"
+#include "worm_model.h"
+
+// Kennzeichen in gameSnapshot.flags
+#define SNAPSHOT_DELTA 0x1
+
+// ---------------------------------------------------------------------------
+//  struct gameSnapshot – Kopf eines Snapshots (die Daten folgen direkt)
+// ---------------------------------------------------------------------------
+struct gameSnapshot {
+    uint32_t size;              // Gesamtgröße in Byte inklusive Kopf
+    uint32_t flags;             // SNAPSHOT_DELTA
+    uint64_t id;                // eindeutige Nummer dieses Snapshots
+    uint64_t parent_id;         // bei Delta: id des Eltern-Snapshots
+    uint64_t board_hash;        // board.hash und worm.hash (zobrist.h)
+    uint64_t worm_hash;
+    uint64_t food_key;          // Zufallsstrom für neues Futter (rng.h)
+    uint64_t food_counter;
+
+    // Board
+    int32_t rows;               // Geometrie, muss beim Wiederherstellen passen
+    int32_t cols;
+    int32_t stride;
+    int32_t food_items;
+    int32_t food_eaten;
+    int32_t game_state;         // enum GameStates
+    uint32_t cells_bytes;       // Größe des Zellblocks
+    uint32_t cell_words;        // Delta: Anzahl geänderter Wörter
+
+    // Wurm
+    uint32_t tail;              // Zähler wie in struct worm
+    uint32_t head;
+    int32_t pending_growth;
+    int32_t maxlen;
+    int32_t heading;            // enum WormHeading
+    int32_t head_y;
+    int32_t head_x;
+    int32_t wcolor;             // enum ColorPairs
+    uint32_t seg_first;         // Zähler des ersten gespeicherten Segments
+    uint32_t seg_count;         // Anzahl gespeicherter Segmente
+};
+
+// Obergrenze für die Größe eines Snapshots dieses Spiels (vollständig;
+// ein Delta ist nie größer).
+extern size_t snapshotSize(struct board* aboard, struct worm* aworm);
+
+// Sichert Board, Wurm und Spielzustand nach out (capacity Byte).
+// parent == NULL: vollständiger Snapshot, sonst Delta gegenüber parent
+// (muss vollständig sein und zur selben Geometrie gehören). Ist das Delta
+// nicht kleiner als ein vollständiger Snapshot, wird ein vollständiger
+// geschrieben. out->size enthält danach die belegte Größe.
+// Liefert RES_FAILED, wenn capacity nicht reicht oder parent nicht passt.
+extern enum ResCodes snapshotGame(struct board* aboard,
+                                  struct worm* aworm,
+                                  enum GameStates game_state,
+                                  const struct gameSnapshot* parent,
+                                  struct gameSnapshot* out,
+                                  size_t capacity);
+
+// Stellt den Zustand aus snap wieder her. Das Board muss bereits mit
+// derselben Größe initialisiert sein (z. B. durch initializeLevel()), der
+// Wurm muss mit Nullen initialisiert oder bereits benutzt sein.
+// Für ein Delta:
+//   - parent != NULL: zuerst wird parent vollständig wiederhergestellt
+//   - parent == NULL: Board und Wurm sind bereits im Zustand des Eltern-
+//     Snapshots, es werden nur die Änderungen übernommen (am schnellsten)
+// Angehängte Bitboards und die Menge der freien Zellen werden mitgeführt,
+// ein angehängter Reach-Tracker wird als veraltet markiert. Die Ausgabe wird nicht aktualisiert; bei
+// Bedarf renderBoard() und showWholeWorm() aufrufen.
+// Liefert RES_FAILED bei unpassender Geometrie oder Eltern-Snapshot.
+extern enum ResCodes restoreGame(struct board* aboard,
+                                 struct worm* aworm,
+                                 enum GameStates* agame_state,
+                                 const struct gameSnapshot* snap,
+                                 const struct gameSnapshot* parent);
+
+#endif  // _SNAPSHOT_H
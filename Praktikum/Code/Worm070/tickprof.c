@@ -0,0 +1,126 @@
+// Worm070 - Aufgabenblatt 8
+// ============================================================================
+//  Modul: tickprof.c  –  Zeitprofil der Spielschleife je Phase
+// ============================================================================
+
+#include <stdio.h>
+#include <string.h>
+
+#include "worm.h"
+#include "tickprof.h"
+
+static const char* phase_names[PHASE_COUNT] = {
+    [PHASE_INPUT]   = "eingabe",
+    [PHASE_PLAN]    = "planen",
+    [PHASE_TAIL]    = "schwanz",
+    [PHASE_MOVE]    = "bewegen",
+    [PHASE_SHOW]    = "zeichnen",
+    [PHASE_STATUS]  = "status",
+    [PHASE_PRESENT] = "ausgabe",
+};
+
+const char* tickPhaseName(enum TickPhases phase)
+{
+    return phase_names[phase];
+}
+
+void initializeTickProfile(struct tickProfile* aprof)
+{
+    memset(aprof, 0, sizeof(*aprof));
+}
+
+void setProfileWormLength(struct tickProfile* aprof, int length)
+{
+    int band = (length - 1) / PROF_BAND_WIDTH;
+
+    if (band < 0) {
+        band = 0;
+    }
+    aprof->current_band = band < PROF_BANDS ? band : PROF_BANDS - 1;
+}
+
+// Größte Dauer, die noch in Bucket idx fällt (Umkehrung von latencyBucket)
+static long long bucketHigh(int idx)
+{
+    if (idx < PROF_SUB) {
+        return idx;
+    }
+    int e = (idx >> PROF_SUB_BITS) + PROF_SUB_BITS - 1;
+    int m = idx & (PROF_SUB - 1);
+    unsigned long long low = (unsigned long long)(PROF_SUB + m) << (e - PROF_SUB_BITS);
+
+    return (long long)(low + (1ULL << (e - PROF_SUB_BITS)) - 1);
+}
+
+long long latencyPercentile(const struct latencyHistogram* ah, double q)
+{
+    if (ah->count == 0) {
+        return 0;
+    }
+
+    // Rang der gesuchten Messung, 1 .. count
+    long rank = (long)(q * ah->count + 0.999999);
+    long seen = 0;
+
+    if (rank < 1) {
+        rank = 1;
+    }
+    for (int i = 0; i < PROF_BUCKETS; i++) {
+        seen += ah->buckets[i];
+        if (seen >= rank) {
+            long long high = bucketHigh(i);
+            return high < ah->max_ns ? high : ah->max_ns;
+        }
+    }
+    return ah->max_ns;
+}
+
+static void writeCsvLine(FILE* f, const char* phase, const char* range,
+                         const struct latencyHistogram* ah)
+{
+    fprintf(f, "%s,%s,%ld,%.2f,%.2f,%.2f,%.2f\n",
+            phase,
+            range,
+            ah->count,
+            ah->sum_ns / 1e3 / ah->count,
+            latencyPercentile(ah, 0.50) / 1e3,
+            latencyPercentile(ah, 0.99) / 1e3,
+            ah->max_ns / 1e3);
+}
+
+enum ResCodes writeTickProfileCsv(const struct tickProfile* aprof,
+                                  const char* path)
+{
+    FILE* f = fopen(path, "w");
+    if (f == NULL) {
+        return RES_FAILED;
+    }
+
+    fprintf(f, "phase,laenge,anzahl,mittel_us,p50_us,p99_us,max_us\n");
+    for (int p = 0; p < PHASE_COUNT; p++) {
+        if (aprof->all[p].count == 0) {
+            continue;
+        }
+        writeCsvLine(f, phase_names[p], "alle", &aprof->all[p]);
+
+        for (int b = 0; b < PROF_BANDS; b++) {
+            char range[32];
+
+            if (aprof->band[p][b].count == 0) {
+                continue;
+            }
+            if (b == PROF_BANDS - 1) {
+                sprintf(range, "%d-", b * PROF_BAND_WIDTH + 1);
+            } else {
+                sprintf(range, "%d-%d", b * PROF_BAND_WIDTH + 1,
+                        (b + 1) * PROF_BAND_WIDTH);
+            }
+            writeCsvLine(f, phase_names[p], range, &aprof->band[p][b]);
+        }
+    }
+    if (aprof->key_to_move.count > 0) {
+        writeCsvLine(f, "taste_bis_schritt", "alle", &aprof->key_to_move);
+    }
+
+    return fclose(f) == 0 ? RES_OK : RES_FAILED;
+}
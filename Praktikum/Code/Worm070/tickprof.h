@@ -0,0 +1,159 @@
+// Worm070 - Aufgabenblatt 8
+// ============================================================================
+//  tickprof.h – Zeitprofil der Spielschleife je Phase
+//
+//  Idee:
+//    Ein Takt von doLevel() besteht aus mehreren Phasen (Eingabe, Planung
+//    des Bots, Schwanz löschen, Bewegen, Zeichnen, Statuszeilen, Ausgabe).
+//    Jede Phase wird mit der monotonen Uhr gemessen: ein clock_gettime()
+//    an jeder Phasengrenze, die Endzeit einer Phase ist die Startzeit der
+//    nächsten.
+//
+//  Histogramme:
+//    Die Dauer landet in einem logarithmisch eingeteilten Histogramm:
+//    je Zweierpotenz PROF_SUB Unterbereiche, also höchstens 12,5 % relativer
+//    Fehler bei p50 und p99, von 1 ns bis zur vollen Wertebreite. Eintragen
+//    kostet einen Zählzugriff, es wird nichts sortiert und nichts
+//    allokiert.
+//
+//    Jede Phase hat ein Gesamthistogramm und eines je Längenband des Wurms
+//    (PROF_BAND_WIDTH Segmente). So zeigt die Auswertung, wie sich die
+//    Zeit mit wachsendem Wurm verschiebt.
+//
+//    Dazu kommt die Zeit von einer Richtungstaste bis zu dem Schritt, der
+//    sie ausführt (key_to_move): vom Lesen der Taste, sobald sie anliegt,
+//    bis nach moveWorm().
+//
+//  Ausgabe:
+//    Live in der Message Area (Taste t, showProfileStatus() in messages.h)
+//    und am Ende als CSV (writeTickProfileCsv(), Option -T).
+// ============================================================================
+
+#ifndef _TICKPROF_H
+#define _TICKPROF_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "worm.h"
+#include "timing.h"
+
+#define PROF_SUB_BITS   3
+#define PROF_SUB        (1 << PROF_SUB_BITS)
+#define PROF_BUCKETS    ((64 - PROF_SUB_BITS + 1) << PROF_SUB_BITS)
+
+#define PROF_BAND_WIDTH 32          // Wurmlänge je Band
+#define PROF_BANDS      16          // das letzte Band ist nach oben offen
+
+// ---------------------------------------------------------------------------
+//  Phasen eines Takts
+// ---------------------------------------------------------------------------
+enum TickPhases {
+    PHASE_INPUT,        // readUserInput()
+    PHASE_PLAN,         // planAutopilot() / planMcts()
+    PHASE_TAIL,         // cleanWormTail()
+    PHASE_MOVE,         // moveWorm()
+    PHASE_SHOW,         // showWorm()
+    PHASE_STATUS,       // showStatus(), showTimingStatus(), Einblendung
+    PHASE_PRESENT,      // presentBoard(), also refresh() bzw. write()
+    PHASE_COUNT
+};
+
+// ---------------------------------------------------------------------------
+//  struct latencyHistogram
+// ---------------------------------------------------------------------------
+struct latencyHistogram {
+    long count;
+    long long sum_ns;
+    long long max_ns;
+    uint32_t buckets[PROF_BUCKETS];
+};
+
+// ---------------------------------------------------------------------------
+//  struct tickProfile
+// ---------------------------------------------------------------------------
+struct tickProfile {
+    struct latencyHistogram all[PHASE_COUNT];
+    struct latencyHistogram band[PHASE_COUNT][PROF_BANDS];
+    struct latencyHistogram key_to_move;   // Richtungstaste bis Schritt
+    int current_band;           // Band des laufenden Takts
+};
+
+// Bucket zu einer Dauer: unterhalb PROF_SUB exakt, darüber Exponent und
+// die PROF_SUB_BITS Bits hinter der führenden Eins.
+static inline int latencyBucket(uint64_t ns)
+{
+    if (ns < PROF_SUB) {
+        return (int)ns;
+    }
+    int e = 63 - __builtin_clzll(ns);
+    return ((e - PROF_SUB_BITS + 1) << PROF_SUB_BITS) |
+           (int)((ns >> (e - PROF_SUB_BITS)) & (PROF_SUB - 1));
+}
+
+static inline void addLatency(struct latencyHistogram* ah, long long ns)
+{
+    if (ns < 0) {
+        ns = 0;
+    }
+    ah->count++;
+    ah->sum_ns += ns;
+    if (ns > ah->max_ns) {
+        ah->max_ns = ns;
+    }
+    ah->buckets[latencyBucket((uint64_t)ns)]++;
+}
+
+// ---------------------------------------------------------------------------
+//  profilePhase
+// ---------------------------------------------------------------------------
+// Trägt die Zeit seit start_ns für phase ein und liefert die jetzige Zeit
+// als Start der nächsten Phase:
+//
+//      long long t = monotonicNowNs();
+//      readUserInput(...);
+//      t = profilePhase(&prof, PHASE_INPUT, t);
+//      cleanWormTail(...);
+//      t = profilePhase(&prof, PHASE_TAIL, t);
+// ---------------------------------------------------------------------------
+static inline long long profilePhase(struct tickProfile* aprof,
+                                     enum TickPhases phase,
+                                     long long start_ns)
+{
+    long long now = monotonicNowNs();
+
+    addLatency(&aprof->all[phase], now - start_ns);
+    addLatency(&aprof->band[phase][aprof->current_band], now - start_ns);
+    return now;
+}
+
+// Setzt alle Histogramme zurück.
+extern void initializeTickProfile(struct tickProfile* aprof);
+
+// Wählt das Längenband für die folgenden Messungen.
+extern void setProfileWormLength(struct tickProfile* aprof, int length);
+
+// Dauer, unter der der Anteil q (0 .. 1) der Messungen liegt: obere Grenze
+// des Buckets, höchstens der Größtwert. 0 ohne Messungen.
+extern long long latencyPercentile(const struct latencyHistogram* ah, double q);
+
+// Kurzname der Phase für Einblendung und CSV.
+extern const char* tickPhaseName(enum TickPhases phase);
+
+// ---------------------------------------------------------------------------
+//  writeTickProfileCsv
+// ---------------------------------------------------------------------------
+// Schreibt je Phase eine Zeile für alle Messungen ("alle") und eine je
+// belegtem Längenband, am Ende die Zeit von Taste bis Schritt:
+//
+//      phase,laenge,anzahl,mittel_us,p50_us,p99_us,max_us
+//      bewegen,alle,1834,1.92,1.79,4.61,18.30
+//      bewegen,1-32,412,1.71,1.54,3.07,9.98
+//      taste_bis_schritt,alle,57,48210.11,47185.92,98566.14,99873.02
+//
+// Liefert RES_OK oder RES_FAILED.
+// ---------------------------------------------------------------------------
+extern enum ResCodes writeTickProfileCsv(const struct tickProfile* aprof,
+                                         const char* path);
+
+#endif  // _TICKPROF_H
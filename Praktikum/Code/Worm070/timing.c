@@ -0,0 +1,281 @@
+// Worm070 - Aufgabenblatt 8
+// ============================================================================
+//  Modul: timing.c  –  Taktgeber mit absoluten Terminen auf der monotonen Uhr
+// ============================================================================
+
+#include <time.h>
+#include <errno.h>
+#include <stdint.h>
+#include <poll.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/timerfd.h>
+#endif
+
+#include "timing.h"
+
+#define NS_PER_SEC 1000000000LL
+#define NS_PER_MS  1000000LL
+
+// ============================================================================
+//  Uhr und Schlafen
+// ============================================================================
+
+long long monotonicNowNs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * NS_PER_SEC + ts.tv_nsec;
+}
+
+void sleepUntilNs(long long deadline_ns)
+{
+#ifdef TIMER_ABSTIME
+    // Absoluter Termin: kein Aufsummieren von Verzögerungen, und ein durch
+    // ein Signal unterbrochener Schlaf wird einfach wiederholt.
+    struct timespec ts;
+    ts.tv_sec  = deadline_ns / NS_PER_SEC;
+    ts.tv_nsec = deadline_ns % NS_PER_SEC;
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+    }
+#else
+    // Systeme ohne clock_nanosleep (z. B. macOS): Restzeit jedes Mal neu
+    // aus dem absoluten Termin berechnen.
+    long long now;
+    while ((now = monotonicNowNs()) < deadline_ns) {
+        struct timespec ts;
+        long long rest = deadline_ns - now;
+        ts.tv_sec  = rest / NS_PER_SEC;
+        ts.tv_nsec = rest % NS_PER_SEC;
+        nanosleep(&ts, NULL);
+    }
+#endif
+}
+
+// ============================================================================
+//  Scheduler
+// ============================================================================
+
+void initializeScheduler(struct tickScheduler* asched,
+                         int tick_ms,
+                         int frame_ms,
+                         int max_catchup)
+{
+    asched->tick_period_ns  = tick_ms * NS_PER_MS;
+    asched->frame_period_ns = frame_ms * NS_PER_MS;
+    asched->max_catchup     = max_catchup;
+
+    asched->ticks          = 0;
+    asched->frames         = 0;
+    asched->frames_skipped = 0;
+    asched->overruns       = 0;
+    asched->dropped_ticks  = 0;
+
+    asched->jitter_last_ns = 0;
+    asched->jitter_max_ns  = 0;
+    asched->jitter_sum_ns  = 0;
+    asched->jitter_samples = 0;
+
+    asched->input_fd      = -1;
+    asched->timer_fd      = -1;
+    asched->input_wakeups = 0;
+
+    rebaseScheduler(asched);
+}
+
+void rebaseScheduler(struct tickScheduler* asched)
+{
+    long long now = monotonicNowNs();
+
+    asched->next_tick_ns  = now + asched->tick_period_ns;
+    asched->next_frame_ns = now + asched->frame_period_ns;
+}
+
+// ============================================================================
+//  Warten auf Termin oder Eingabe
+// ============================================================================
+
+void attachSchedulerInput(struct tickScheduler* asched, int fd)
+{
+    asched->input_fd = fd;
+#ifdef __linux__
+    if (asched->timer_fd < 0) {
+        asched->timer_fd = timerfd_create(CLOCK_MONOTONIC,
+                                          TFD_NONBLOCK | TFD_CLOEXEC);
+    }
+#endif
+}
+
+void detachSchedulerInput(struct tickScheduler* asched)
+{
+    if (asched->timer_fd >= 0) {
+        close(asched->timer_fd);
+    }
+    asched->timer_fd = -1;
+    asched->input_fd = -1;
+}
+
+// ----------------------------------------------------------------------------
+//  pollUntilNs
+// ----------------------------------------------------------------------------
+// Wartet bis deadline_ns (< 0: ohne Zeitgrenze) oder bis die Eingabe
+// lesbar ist; liefert true bei Eingabe.
+//
+// Ablauf:
+//    - timerfd auf den absoluten Termin stellen; ohne timerfd die Restzeit
+//      vor jedem poll() neu in Millisekunden umrechnen (aufgerundet, also
+//      nie zu früh)
+//    - durch ein Signal unterbrochenes poll() (z. B. SIGWINCH) wiederholen
+//    - meldet die Eingabe Fehler oder Dateiende, wird sie nicht mehr
+//      überwacht und der Rest bis zum Termin geschlafen; sonst würde poll()
+//      ab jetzt sofort zurückkehren
+// ----------------------------------------------------------------------------
+static bool pollUntilNs(struct tickScheduler* asched, long long deadline_ns)
+{
+    struct pollfd fds[2] = {
+        { .fd = asched->input_fd, .events = POLLIN },
+        { .fd = asched->timer_fd, .events = POLLIN },
+    };
+    int nfds = 1;
+
+#ifdef __linux__
+    if (asched->timer_fd >= 0 && deadline_ns >= 0) {
+        struct itimerspec its = {0};
+        its.it_value.tv_sec  = deadline_ns / NS_PER_SEC;
+        its.it_value.tv_nsec = deadline_ns % NS_PER_SEC;
+        if (timerfd_settime(asched->timer_fd, TFD_TIMER_ABSTIME, &its, NULL) == 0) {
+            nfds = 2;
+        }
+    }
+#endif
+
+    for (;;) {
+        int timeout = -1;
+
+        if (nfds == 1 && deadline_ns >= 0) {
+            long long now = monotonicNowNs();
+            if (now >= deadline_ns) {
+                return false;
+            }
+            timeout = (int)((deadline_ns - now + NS_PER_MS - 1) / NS_PER_MS);
+        }
+
+        if (poll(fds, nfds, timeout) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        if (fds[0].revents & (POLLERR | POLLHUP | POLLNVAL)) {
+            asched->input_fd = -1;
+            break;
+        }
+        if (fds[0].revents & POLLIN) {
+            return true;
+        }
+        if (nfds == 2 && (fds[1].revents & POLLIN)) {
+            uint64_t expirations;
+            while (read(asched->timer_fd, &expirations, sizeof(expirations)) < 0 &&
+                   errno == EINTR) {
+            }
+            return false;
+        }
+    }
+
+    if (deadline_ns >= 0) {
+        sleepUntilNs(deadline_ns);
+    }
+    return false;
+}
+
+void waitForInput(struct tickScheduler* asched)
+{
+    if (asched->input_fd < 0 || !pollUntilNs(asched, -1)) {
+        sleepUntilNs(monotonicNowNs() + asched->tick_period_ns);
+    }
+}
+
+// ----------------------------------------------------------------------------
+//  waitForTicks
+// ----------------------------------------------------------------------------
+// Ablauf:
+//    - bis zum früheren der beiden Termine schlafen; weckt eine Taste
+//      vorher, ohne Schritt zurückkehren (kein Jitter, der Termin bleibt)
+//    - Verspätung gegenüber dem Termin als Jitter erfassen
+//    - Anzahl der fälligen Schritte bestimmen; mehr als einer bedeutet,
+//      dass der vorige Durchlauf länger als eine Periode gedauert hat
+//    - der nächste Termin wird immer um ganze Perioden weitergeschaltet,
+//      nie von "jetzt" aus neu berechnet (driftfrei)
+// ----------------------------------------------------------------------------
+int waitForTicks(struct tickScheduler* asched)
+{
+    long long wake = asched->next_tick_ns < asched->next_frame_ns
+                   ? asched->next_tick_ns
+                   : asched->next_frame_ns;
+    long long now = monotonicNowNs();
+    bool slept = false;
+
+    if (now < wake) {
+        if (asched->input_fd >= 0) {
+            if (pollUntilNs(asched, wake) &&
+                (now = monotonicNowNs()) < asched->next_tick_ns) {
+                asched->input_wakeups++;
+                return 0;
+            }
+        } else {
+            sleepUntilNs(wake);
+        }
+        now = monotonicNowNs();
+        slept = true;
+    }
+
+    if (now < asched->next_tick_ns) {
+        return 0;   // nur ein Frame-Termin
+    }
+
+    long long late = now - asched->next_tick_ns;
+    if (slept) {
+        asched->jitter_last_ns = late;
+        asched->jitter_sum_ns += late;
+        asched->jitter_samples++;
+        if (late > asched->jitter_max_ns) {
+            asched->jitter_max_ns = late;
+        }
+    }
+
+    long due = 1 + (long)(late / asched->tick_period_ns);
+    asched->next_tick_ns += due * asched->tick_period_ns;
+
+    if (due > 1) {
+        asched->overruns += due - 1;
+    }
+    if (due > asched->max_catchup) {
+        asched->dropped_ticks += due - asched->max_catchup;
+        due = asched->max_catchup;
+    }
+
+    asched->ticks += due;
+    return (int)due;
+}
+
+bool frameDue(struct tickScheduler* asched, int ticks_done)
+{
+    long long now = monotonicNowNs();
+
+    if (now < asched->next_frame_ns) {
+        asched->frames_skipped += ticks_done;
+        return false;
+    }
+
+    asched->next_frame_ns += asched->frame_period_ns;
+    if (asched->next_frame_ns <= now) {
+        // Ausgabe hinkt mehr als eine Periode hinterher: nicht nachholen
+        asched->next_frame_ns = now + asched->frame_period_ns;
+    }
+
+    if (ticks_done > 1) {
+        asched->frames_skipped += ticks_done - 1;
+    }
+    asched->frames++;
+    return true;
+}
@@ -0,0 +1,115 @@
+// Worm070 - Aufgabenblatt 8
+// ============================================================================
+//  timing.h – Taktgeber für die Spielschleife
+//
+//  Bisher hat doLevel() nach jedem Schritt napms(NAP_TIME) aufgerufen.
+//  Die echte Taktzeit war dadurch NAP_TIME plus die Rechen- und
+//  Ausgabezeit – und sie wurde mit wachsendem Wurm immer länger.
+//
+//  Der Scheduler arbeitet stattdessen mit absoluten Zeitpunkten auf einer
+//  monotonen Uhr (CLOCK_MONOTONIC):
+//
+//    - Spielschritte finden exakt alle NAP_TIME Millisekunden statt
+//      (fester Simulationstakt, kein Aufsummieren von Verzögerungen).
+//    - Ausgaben (Frames) haben einen eigenen Takt (FRAME_TIME).
+//    - Hinkt das Programm hinterher, werden bis zu MAX_CATCHUP_TICKS Schritte
+//      nachgeholt und nur ein Frame dafür gezeichnet (Frame-Skip). Was darüber
+//      hinausgeht, wird verworfen und als Overrun gezählt.
+//    - Jitter (Verspätung beim Aufwachen) und Overruns werden mitgezählt und
+//      in der Message Area angezeigt.
+//
+//  Warten auf Termin oder Eingabe:
+//    Mit attachSchedulerInput() wartet waitForTicks() nicht mehr blind bis
+//    zum Termin, sondern mit poll() auf die Eingabe (stdin) und einen
+//    timerfd, der auf den absoluten Termin gestellt ist. Eine Taste weckt
+//    sofort, auch mitten im Warten; waitForTicks() liefert dann 0 fällige
+//    Schritte, und der Aufrufer liest die Tasten. Im Pausenmodus wartet
+//    waitForInput() nur auf die Eingabe, ohne Zeitgeber: ein pausiertes
+//    Spiel verbraucht keine Rechenzeit.
+//
+//    Der timerfd wird vor jedem Warten auf den früheren der beiden Termine
+//    gestellt (TFD_TIMER_ABSTIME) statt als fester periodischer Zeitgeber
+//    zu laufen: Schritt- und Frame-Takt sind unabhängig, und
+//    rebaseScheduler() verschiebt beide. Ohne timerfd (nicht Linux) dient
+//    die Wartezeit von poll() als Zeitgeber, auf Millisekunden gerundet.
+// ============================================================================
+
+#ifndef _TIMING_H
+#define _TIMING_H
+
+#include <stdbool.h>
+
+// Höchstens so viele Spielschritte werden in einem Durchlauf nachgeholt.
+#define MAX_CATCHUP_TICKS 5
+
+// ---------------------------------------------------------------------------
+//  struct tickScheduler
+// ---------------------------------------------------------------------------
+struct tickScheduler {
+    long long tick_period_ns;   // Simulationstakt
+    long long frame_period_ns;  // Ausgabetakt
+    int max_catchup;            // maximal nachzuholende Schritte
+
+    long long next_tick_ns;     // absoluter Zeitpunkt des nächsten Schritts
+    long long next_frame_ns;    // absoluter Zeitpunkt des nächsten Frames
+
+    // Statistik
+    long ticks;                 // ausgeführte Spielschritte
+    long frames;                // gezeichnete Frames
+    long frames_skipped;        // Schritte, die keinen eigenen Frame bekamen
+    long overruns;              // Schritte, deren Termin bereits verstrichen war
+    long dropped_ticks;         // verworfene Schritte (über max_catchup)
+
+    long long jitter_last_ns;   // Verspätung beim letzten Aufwachen
+    long long jitter_max_ns;    // größte Verspätung
+    long long jitter_sum_ns;    // Summe für den Mittelwert
+    long jitter_samples;        // Anzahl der Messungen
+
+    // Warten mit poll() (attachSchedulerInput())
+    int input_fd;               // überwachte Eingabe oder -1
+    int timer_fd;               // timerfd oder -1 (Wartezeit von poll())
+    long input_wakeups;         // vor dem Termin durch Eingabe geweckt
+};
+
+// Liefert die aktuelle Zeit der monotonen Uhr in Nanosekunden.
+extern long long monotonicNowNs(void);
+
+// Schläft bis zum absoluten Zeitpunkt deadline_ns (monotone Uhr).
+extern void sleepUntilNs(long long deadline_ns);
+
+// Initialisiert den Scheduler. Der erste Schritt ist eine Periode nach jetzt.
+// Gewartet wird mit sleepUntilNs(), bis attachSchedulerInput() aufgerufen
+// wird.
+extern void initializeScheduler(struct tickScheduler* asched,
+                                int tick_ms,
+                                int frame_ms,
+                                int max_catchup);
+
+// Setzt die Termine neu auf "jetzt + Periode", z. B. nach einer Pause.
+// Dadurch werden die während der Pause verstrichenen Schritte nicht
+// nachgeholt.
+extern void rebaseScheduler(struct tickScheduler* asched);
+
+// Ab jetzt auf Termin oder Eingabe von fd warten (siehe oben). Legt den
+// timerfd an; gelingt das nicht, wartet poll() mit Zeitgrenze.
+extern void attachSchedulerInput(struct tickScheduler* asched, int fd);
+
+// Schließt den timerfd; danach wird wieder mit sleepUntilNs() gewartet.
+extern void detachSchedulerInput(struct tickScheduler* asched);
+
+// Schläft bis zum nächsten Termin (Schritt oder Frame) und liefert die
+// Anzahl der jetzt fälligen Spielschritte (0 bis max_catchup). Mit
+// überwachter Eingabe endet das Warten auch, sobald eine Taste anliegt.
+extern int waitForTicks(struct tickScheduler* asched);
+
+// Wartet ohne Zeitgrenze, bis eine Taste anliegt (Pausenmodus). Ist keine
+// Eingabe überwacht oder ist sie geschlossen, wird eine Schrittperiode
+// geschlafen, damit der Aufrufer nicht im Kreis läuft.
+extern void waitForInput(struct tickScheduler* asched);
+
+// Liefert true, wenn ein Frame gezeichnet werden soll, und schaltet den
+// Frame-Termin weiter. Fällige, aber nicht gezeichnete Schritte zählen als
+// übersprungene Frames.
+extern bool frameDue(struct tickScheduler* asched, int ticks_done);
+
+#endif  // _TIMING_H
@@ -0,0 +1,131 @@
+// Worm070 - Aufgabenblatt 8
+// ============================================================================
+//  Modul: touchlog.c  –  Protokoll geänderter Zellen, Level-Neustart
+// ============================================================================
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "worm.h"
+#include "board_model.h"
+#include "bitboard.h"
+#include "touchlog.h"
+
+// ============================================================================
+//  attachTouchLog / freeTouchLog
+// ============================================================================
+
+enum ResCodes attachTouchLog(struct board* aboard,
+                             struct touchLog* alog,
+                             const cell_t* image)
+{
+    if (alog == NULL) {
+        aboard->touched = NULL;
+        return RES_OK;
+    }
+
+    long cells = (long)(aboard->last_row + 1 + 2 * BOARD_BORDER) * aboard->stride;
+    long words = (cells + 63) / 64;
+    int capacity = (int)(cells / TOUCH_LOG_FRACTION) + 64;
+
+    // Speicher wächst mit dem Zellblock und wird danach wiederverwendet
+    if (cells > alog->cells_bytes || words > alog->mark_words ||
+        capacity > alog->capacity) {
+        freeTouchLog(alog);
+        alog->own_image = malloc(cells * sizeof(cell_t));
+        alog->cells     = malloc(capacity * sizeof(cellidx_t));
+        alog->marks     = malloc(words * sizeof(uint64_t));
+        if (alog->own_image == NULL || alog->cells == NULL || alog->marks == NULL) {
+            freeTouchLog(alog);
+            return RES_FAILED;
+        }
+        alog->capacity   = capacity;
+        alog->mark_words = words;
+    }
+    alog->cells_bytes = cells;
+
+    if (image == NULL) {
+        memcpy(alog->own_image, aboard->cells, cells * sizeof(cell_t));
+        image = alog->own_image;
+    }
+    alog->image      = image;
+    alog->hash       = aboard->hash;
+    alog->food_items = aboard->food_items;
+    alog->food_rng   = aboard->food_rng;
+
+    memset(alog->marks, 0, words * sizeof(uint64_t));
+    alog->count    = 0;
+    alog->overflow = false;
+
+    aboard->touched = alog;
+    return RES_OK;
+}
+
+void freeTouchLog(struct touchLog* alog)
+{
+    free(alog->own_image);
+    free(alog->cells);
+    free(alog->marks);
+    alog->own_image   = NULL;
+    alog->cells       = NULL;
+    alog->marks       = NULL;
+    alog->image       = NULL;
+    alog->cells_bytes = 0;
+    alog->capacity    = 0;
+    alog->mark_words  = 0;
+    alog->count       = 0;
+}
+
+// ============================================================================
+//  resetLevel
+// ============================================================================
+// Vorgehen:
+//    - protokollierte Zellen direkt aus dem Abbild zurückschreiben, ein
+//      angehängtes Bitboard Zelle für Zelle nachführen, Bits löschen
+//    - nach einem Überlauf stattdessen den ganzen Block kopieren und das
+//      Bitboard neu laden
+//    - Hashwert, Futteranzahl und Futterstrom aus dem Abbild übernehmen
+//      statt sie Zelle für Zelle nachzurechnen
+//    - die Menge der freien Zellen als veraltet markieren (wie nach
+//      initializeLevel()); aufgebaut wird sie erst, wenn Futter nachwächst
+// ============================================================================
+
+void resetLevel(struct board* aboard)
+{
+    struct touchLog* log = aboard->touched;
+
+    if (log->overflow) {
+        memcpy(aboard->cells, log->image, log->cells_bytes * sizeof(cell_t));
+        memset(log->marks, 0, log->mark_words * sizeof(uint64_t));
+        if (aboard->bits != NULL) {
+            loadBitboardFromBoard(aboard->bits, aboard);
+        }
+        log->restored += log->cells_bytes;
+        log->full_resets++;
+    } else {
+        for (int i = 0; i < log->count; i++) {
+            cellidx_t idx = log->cells[i];
+
+            if (aboard->bits != NULL) {
+                updateBitboardIndex(aboard->bits, idx,
+                                    (enum BoardCodes)aboard->cells[idx],
+                                    (enum BoardCodes)log->image[idx]);
+            }
+            aboard->cells[idx] = log->image[idx];
+            log->marks[idx >> 6] &= ~(1ULL << (idx & 63));
+        }
+        log->restored += log->count;
+    }
+
+    log->count    = 0;
+    log->overflow = false;
+    log->resets++;
+
+    aboard->hash       = log->hash;
+    aboard->food_items = log->food_items;
+    aboard->food_rng   = log->food_rng;
+    aboard->food_eaten = 0;
+    aboard->dirty_len  = 0;
+    aboard->reach      = NULL;
+    invalidateFreeCells(aboard);
+}
@@ -0,0 +1,140 @@
+// Worm070 - Aufgabenblatt 8
+// ============================================================================
+//  touchlog.h – Protokoll geänderter Zellen für schnelle Level-Neustarts
+//
+//  Problem:
+//    Ein Neustart desselben Levels baute bisher das ganze Feld neu auf
+//    (initializeLevel(): placeItem() für jede Zelle) oder kopierte den
+//    ganzen Zellblock (Batch-Umgebung) samt Neuaufbau der Menge freier
+//    Zellen. Headless-Spiele dauern oft nur einige hundert Schritte; dann
+//    kostet der Neustart mehr als das Spiel.
+//
+//  Idee:
+//    Das Protokoll hängt wie Bitboard und Reach-Tracker am Board und hält
+//    das Abbild des Levels beim Anhängen fest (Zellen, Hashwert,
+//    Futteranzahl, Futterstrom). setContentAtIndex() trägt jede Zelle
+//    beim ersten Ändern in eine Liste ein; ein Bit je Zelle verhindert
+//    doppelte Einträge. resetLevel() schreibt nur diese Zellen aus dem
+//    Abbild zurück (ein angehängtes Bitboard wird mitgeführt) und löscht
+//    ihre Bits einzeln. Hashwert und Zähler kommen aus dem Abbild, statt
+//    Zelle für Zelle nachgerechnet zu werden. Der Aufwand hängt also nur
+//    von der Zahl der geänderten Zellen ab, nicht von der Feldgröße.
+//
+//    Die Liste fasst TOUCH_LOG_FRACTION der Zellen. Läuft sie über (sehr
+//    lange Spiele), wird beim nächsten resetLevel() einmal der ganze Block
+//    kopiert.
+//
+//  Der Wurm braucht kein Gegenstück: initializeWorm() leert die Deque über
+//  ihre Zähler und schreibt nur die Kopfzelle, unbenutzte Einträge werden
+//  nicht angefasst.
+//
+//  Grenzen:
+//    Wer cells direkt beschreibt (copyCellsToBoard(), memcpy), umgeht das
+//    Protokoll. Einen Reach-Tracker hängt resetLevel() ab; der Aufrufer
+//    hängt ihn wie nach initializeLevel() neu an (der Wurm beginnt von vorn).
+//
+//    Die Menge der freien Zellen ist danach wie nach initializeLevel()
+//    veraltet und wird erst aufgebaut, wenn Futter nachwächst. So fällt
+//    neues Futter nach einem Neustart auf dieselben Zellen wie in einem
+//    frisch aufgebauten Level; Headless- und Batch-Läufe bleiben Schritt
+//    für Schritt gleich.
+// ============================================================================
+
+#ifndef _TOUCHLOG_H
+#define _TOUCHLOG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "worm.h"
+#include "board_model.h"
+#include "rng.h"
+
+// Anteil der Zellen, den die Liste fasst (1 / TOUCH_LOG_FRACTION)
+#define TOUCH_LOG_FRACTION 8
+
+// ============================================================================
+//  struct touchLog
+// ============================================================================
+//
+//  image:        Zellen des Levels beim Anhängen (cells_bytes Zellen)
+//  own_image:    vom Protokoll angelegte Kopie (image == own_image) oder
+//                NULL, wenn image dem Aufrufer gehört
+//  hash / food_items / food_rng:
+//                Zustand des Boards beim Anhängen
+//  cells:        seit dem letzten Anhängen oder resetLevel() geänderte
+//                Zellnummern, count Einträge (capacity reserviert)
+//  marks:        ein Bit je Zellnummer: Zelle steht bereits in cells
+//  overflow:     Liste war voll, resetLevel() kopiert den ganzen Block
+//  resets / full_resets / restored:
+//                Statistik: Neustarts, davon mit voller Kopie, und
+//                zurückgeschriebene Zellen
+// ============================================================================
+struct touchLog {
+    const cell_t* image;
+    cell_t* own_image;
+    long cells_bytes;
+
+    uint64_t hash;
+    int food_items;
+    struct rngStream food_rng;
+
+    cellidx_t* cells;
+    int count;
+    int capacity;
+    uint64_t* marks;
+    long mark_words;
+    bool overflow;
+
+    long resets;
+    long full_resets;
+    long restored;
+};
+
+// Von setContentAtIndex() vor jeder Änderung von Zelle idx aufgerufen.
+static inline void logTouchedCell(struct touchLog* alog, cellidx_t idx)
+{
+    uint64_t bit = 1ULL << (idx & 63);
+
+    if (alog->marks[idx >> 6] & bit) {
+        return;
+    }
+    if (alog->count == alog->capacity) {
+        alog->overflow = true;
+        return;
+    }
+    alog->marks[idx >> 6] |= bit;
+    alog->cells[alog->count++] = idx;
+}
+
+// ---------------------------------------------------------------------------
+//  attachTouchLog
+// ---------------------------------------------------------------------------
+// Hängt das Protokoll an das Board und hält den jetzigen Zustand als
+// Abbild fest. Mit image == NULL wird der Zellblock kopiert; sonst muss
+// image genau den jetzigen Zellen entsprechen und so lange bestehen
+// bleiben wie das Protokoll (z. B. ein von mehreren Boards geteiltes
+// Startlevel). Aufruf direkt nach dem Aufbau des Levels, vor
+// initializeWorm(). Speicher wird beim ersten Aufruf angelegt (vorher mit
+// Nullen initialisieren) und danach wiederverwendet. NULL hängt ab.
+// RES_FAILED ohne Speicher.
+// ---------------------------------------------------------------------------
+extern enum ResCodes attachTouchLog(struct board* aboard,
+                                    struct touchLog* alog,
+                                    const cell_t* image);
+
+extern void freeTouchLog(struct touchLog* alog);
+
+// ---------------------------------------------------------------------------
+//  resetLevel
+// ---------------------------------------------------------------------------
+// Setzt das Board auf das Abbild des angehängten Protokolls zurück: nur
+// die protokollierten Zellen (oder nach einem Überlauf der ganze Block),
+// Hashwert, Futteranzahl und Futterstrom wie beim Anhängen, food_eaten 0.
+// Die Dirty-Liste wird verworfen, gezeichnet wird nichts, ein Reach-Tracker
+// ist danach abgehängt. Anschließend den Wurm mit initializeWorm() neu
+// anlegen.
+// ---------------------------------------------------------------------------
+extern void resetLevel(struct board* aboard);
+
+#endif  // _TOUCHLOG_H
@@ -0,0 +1,261 @@
+// Worm070 - Aufgabenblatt 8
+// ============================================================================
+//  Modul: workpool.c  –  Thread-Pool mit Work Stealing
+// ============================================================================
+
+#include <stdlib.h>
+#include <sched.h>
+#include <unistd.h>
+
+#include "worm.h"
+#include "workpool.h"
+
+#define WORKPOOL_MASK (WORKPOOL_QUEUE_SIZE - 1)
+
+// Argument der Worker-Threads
+struct workerStart {
+    struct workPool* pool;
+    int id;
+};
+
+// ============================================================================
+//  Warteschlangen
+// ============================================================================
+
+static bool pushTask(struct workQueue* q, struct workTask task)
+{
+    bool ok = false;
+
+    pthread_mutex_lock(&q->lock);
+    if (q->tail - q->head < WORKPOOL_QUEUE_SIZE) {
+        q->tasks[q->tail & WORKPOOL_MASK] = task;
+        q->tail++;
+        ok = true;
+    }
+    pthread_mutex_unlock(&q->lock);
+    return ok;
+}
+
+// Besitzer: jüngste Aufgabe (LIFO)
+static bool popTask(struct workQueue* q, struct workTask* atask)
+{
+    bool ok = false;
+
+    pthread_mutex_lock(&q->lock);
+    if (q->tail != q->head) {
+        q->tail--;
+        *atask = q->tasks[q->tail & WORKPOOL_MASK];
+        ok = true;
+    }
+    pthread_mutex_unlock(&q->lock);
+    return ok;
+}
+
+// Dieb: älteste Aufgabe (FIFO)
+static bool stealTask(struct workQueue* q, struct workTask* atask)
+{
+    bool ok = false;
+
+    pthread_mutex_lock(&q->lock);
+    if (q->tail != q->head) {
+        *atask = q->tasks[q->head & WORKPOOL_MASK];
+        q->head++;
+        ok = true;
+    }
+    pthread_mutex_unlock(&q->lock);
+    return ok;
+}
+
+// Eigene Schlange, sonst reihum bei den anderen Workern stehlen
+static bool findTask(struct workPool* apool, int id, struct workTask* atask)
+{
+    if (popTask(&apool->queues[id], atask)) {
+        return true;
+    }
+
+    for (int k = 1; k < apool->workers; k++) {
+        int victim = (id + k) % apool->workers;
+        if (stealTask(&apool->queues[victim], atask)) {
+            atomic_fetch_add_explicit(&apool->steals, 1, memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+// ============================================================================
+//  Worker-Thread
+// ============================================================================
+
+static void* workerMain(void* arg)
+{
+    struct workerStart* start = arg;
+    struct workPool* apool = start->pool;
+    int id = start->id;
+    free(start);
+
+    for (;;) {
+        struct workTask task;
+
+        if (findTask(apool, id, &task)) {
+            atomic_fetch_sub(&apool->queued, 1);
+            task.func(task.arg, id);
+
+            if (atomic_fetch_sub(&apool->pending, 1) == 1) {
+                pthread_mutex_lock(&apool->lock);
+                pthread_cond_broadcast(&apool->idle);
+                pthread_mutex_unlock(&apool->lock);
+            }
+            continue;
+        }
+
+        // Nichts zu tun: schlafen, bis submitWork() weckt. queued wird
+        // unter der Sperre geprüft, ein Wecken kann also nicht verloren gehen.
+        pthread_mutex_lock(&apool->lock);
+        while (atomic_load(&apool->queued) == 0 && !apool->stop) {
+            pthread_cond_wait(&apool->wake, &apool->lock);
+        }
+        bool stop = apool->stop && atomic_load(&apool->queued) == 0;
+        pthread_mutex_unlock(&apool->lock);
+
+        if (stop) {
+            return NULL;
+        }
+    }
+}
+
+// ============================================================================
+//  Öffentliche Funktionen
+// ============================================================================
+
+int availableCores(void)
+{
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+}
+
+enum ResCodes initializeWorkPool(struct workPool* apool, int workers)
+{
+    if (workers <= 0) {
+        workers = availableCores();
+    }
+
+    apool->workers = 0;
+    apool->stop    = false;
+    atomic_init(&apool->queued, 0);
+    atomic_init(&apool->pending, 0);
+    atomic_init(&apool->next, 0);
+    atomic_init(&apool->steals, 0);
+
+    apool->threads = calloc(workers, sizeof(pthread_t));
+    apool->queues  = calloc(workers, sizeof(struct workQueue));
+    if (apool->threads == NULL || apool->queues == NULL) {
+        free(apool->threads);
+        free(apool->queues);
+        return RES_FAILED;
+    }
+
+    pthread_mutex_init(&apool->lock, NULL);
+    pthread_cond_init(&apool->wake, NULL);
+    pthread_cond_init(&apool->idle, NULL);
+    for (int i = 0; i < workers; i++) {
+        pthread_mutex_init(&apool->queues[i].lock, NULL);
+    }
+
+    // Schlangen müssen für alle Worker existieren, bevor der erste startet
+    apool->workers = workers;
+
+    for (int i = 0; i < workers; i++) {
+        struct workerStart* start = malloc(sizeof(*start));
+        if (start != NULL) {
+            start->pool = apool;
+            start->id   = i;
+        }
+        if (start == NULL ||
+            pthread_create(&apool->threads[i], NULL, workerMain, start) != 0) {
+            free(start);
+            // Bereits gestartete Worker beenden; ihre Schlangen bleiben
+            // erhalten, bis alle Threads fort sind
+            pthread_mutex_lock(&apool->lock);
+            apool->stop = true;
+            pthread_cond_broadcast(&apool->wake);
+            pthread_mutex_unlock(&apool->lock);
+            for (int k = 0; k < i; k++) {
+                pthread_join(apool->threads[k], NULL);
+            }
+            apool->workers = i;
+            freeWorkPool(apool);
+            return RES_FAILED;
+        }
+    }
+    return RES_OK;
+}
+
+void freeWorkPool(struct workPool* apool)
+{
+    if (apool->threads == NULL) {
+        return;
+    }
+
+    if (!apool->stop) {
+        waitWorkPool(apool);
+
+        pthread_mutex_lock(&apool->lock);
+        apool->stop = true;
+        pthread_cond_broadcast(&apool->wake);
+        pthread_mutex_unlock(&apool->lock);
+
+        for (int i = 0; i < apool->workers; i++) {
+            pthread_join(apool->threads[i], NULL);
+        }
+    }
+
+    for (int i = 0; i < apool->workers; i++) {
+        pthread_mutex_destroy(&apool->queues[i].lock);
+    }
+    pthread_cond_destroy(&apool->idle);
+    pthread_cond_destroy(&apool->wake);
+    pthread_mutex_destroy(&apool->lock);
+
+    free(apool->threads);
+    free(apool->queues);
+    apool->threads = NULL;
+    apool->queues  = NULL;
+    apool->workers = 0;
+}
+
+void submitWorkTo(struct workPool* apool, int worker,
+                  workFunc func, void* arg)
+{
+    struct workTask task = { func, arg };
+
+    // Zähler vor dem Einstellen erhöhen: waitWorkPool() darf nicht
+    // zurückkehren, solange die Aufgabe unterwegs ist, und ein Worker darf
+    // queued nicht unter 0 bringen
+    atomic_fetch_add(&apool->pending, 1);
+    atomic_fetch_add(&apool->queued, 1);
+
+    while (!pushTask(&apool->queues[worker], task)) {
+        sched_yield();
+    }
+
+    pthread_mutex_lock(&apool->lock);
+    pthread_cond_signal(&apool->wake);
+    pthread_mutex_unlock(&apool->lock);
+}
+
+void submitWork(struct workPool* apool, workFunc func, void* arg)
+{
+    unsigned int n = atomic_fetch_add_explicit(&apool->next, 1,
+                                               memory_order_relaxed);
+    submitWorkTo(apool, (int)(n % (unsigned int)apool->workers), func, arg);
+}
+
+void waitWorkPool(struct workPool* apool)
+{
+    pthread_mutex_lock(&apool->lock);
+    while (atomic_load(&apool->pending) > 0) {
+        pthread_cond_wait(&apool->idle, &apool->lock);
+    }
+    pthread_mutex_unlock(&apool->lock);
+}
@@ -0,0 +1,89 @@
+// Worm070 - Aufgabenblatt 8
+// ============================================================================
+//  workpool.h – Thread-Pool mit Work Stealing
+//
+//  Idee:
+//    Eine feste Anzahl Worker-Threads arbeitet Aufgaben (Funktion +
+//    Argument) ab. Jeder Worker hat eine eigene Warteschlange:
+//      - neue Aufgaben werden reihum verteilt (submitWork) oder gezielt
+//        einem Worker gegeben (submitWorkTo, z. B. eine Fortsetzung)
+//      - ein Worker nimmt zuerst die zuletzt eingestellte Aufgabe aus der
+//        eigenen Schlange (LIFO, Daten noch im Cache)
+//      - ist sie leer, stiehlt er die älteste Aufgabe eines anderen Workers
+//        (FIFO); so bleibt kein Kern untätig, solange es Arbeit gibt
+//      - ohne Arbeit schläft er auf einer Bedingungsvariablen, verbraucht
+//        also keine Rechenzeit
+//    Die Schlangen sind kleine Ringpuffer mit je einem Mutex; gesperrt wird
+//    nur für wenige Befehle, Aufgaben laufen ohne Sperre.
+//
+//  Die Aufgabenfunktion bekommt die Nummer des ausführenden Workers
+//  (0 .. workers - 1). Damit kann sie Daten pro Worker benutzen (eigene
+//  Spielkopie, eigener Zufallsgenerator), auch wenn die Aufgabe gestohlen
+//  wurde.
+// ============================================================================
+
+#ifndef _WORKPOOL_H
+#define _WORKPOOL_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "worm.h"
+
+// Plätze pro Warteschlange (Zweierpotenz). Ist eine Schlange voll, wartet
+// submitWork(), bis wieder ein Platz frei ist.
+#define WORKPOOL_QUEUE_SIZE 256
+
+typedef void (*workFunc)(void* arg, int worker);
+
+struct workTask {
+    workFunc func;
+    void* arg;
+};
+
+struct workQueue {
+    pthread_mutex_t lock;
+    struct workTask tasks[WORKPOOL_QUEUE_SIZE];
+    unsigned int head;          // älteste Aufgabe (hier wird gestohlen)
+    unsigned int tail;          // nächster freier Platz (hier arbeitet der Besitzer)
+};
+
+struct workPool {
+    int workers;
+    pthread_t* threads;
+    struct workQueue* queues;
+
+    pthread_mutex_t lock;       // schützt das Schlafen/Aufwecken
+    pthread_cond_t wake;        // neue Arbeit oder Ende
+    pthread_cond_t idle;        // alle Aufgaben erledigt
+
+    atomic_long queued;         // eingestellte, noch nicht begonnene Aufgaben
+    atomic_long pending;        // eingestellte, noch nicht beendete Aufgaben
+    atomic_uint next;           // Verteilung reihum
+    bool stop;
+
+    atomic_long steals;         // Statistik: gestohlene Aufgaben
+};
+
+// Startet workers Threads (workers <= 0: Anzahl der Prozessoren).
+// RES_FAILED, wenn Speicher oder Threads fehlen.
+extern enum ResCodes initializeWorkPool(struct workPool* apool, int workers);
+
+// Wartet auf alle Aufgaben, beendet die Threads und gibt alles frei.
+extern void freeWorkPool(struct workPool* apool);
+
+// Stellt eine Aufgabe ein (reihum auf die Worker verteilt).
+extern void submitWork(struct workPool* apool, workFunc func, void* arg);
+
+// Stellt eine Aufgabe in die Schlange von Worker worker.
+extern void submitWorkTo(struct workPool* apool, int worker,
+                         workFunc func, void* arg);
+
+// Wartet, bis alle eingestellten Aufgaben (auch solche, die während des
+// Wartens von Aufgaben eingestellt werden) erledigt sind.
+extern void waitWorkPool(struct workPool* apool);
+
+// Anzahl der verfügbaren Prozessoren (mindestens 1).
+extern int availableCores(void);
+
+#endif  // _WORKPOOL_H
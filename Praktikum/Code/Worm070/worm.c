@@ -16,14 +16,29 @@
 
 #include <curses.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <stdbool.h>
 #include <string.h>
+#include <unistd.h>
 
 #include "prep.h"
 #include "worm.h"
 #include "worm_model.h"
 #include "board_model.h"
 #include "messages.h"
+#include "render.h"
+#include "headless.h"
+#include "batch_env.h"
+#include "obs_encoder.h"
+#include "timing.h"
+#include "replay.h"
+#include "autopilot.h"
+#include "mcts.h"
+#include "bitboard.h"
+#include "reach.h"
+#include "level.h"
+#include "levelgen.h"
+#include "tickprof.h"
 
 // ---------------------------------------------------------------------------
 // Globale Variable zur Steuerung des Pausenmodus.
@@ -33,6 +48,73 @@
 // ---------------------------------------------------------------------------
 static bool paused = false;
 
+// ---------------------------------------------------------------------------
+// Aufzeichnung des laufenden Spiels (Option -r), sonst NULL.
+// readUserInput() hält jede ausgewertete Taste als Ereignis fest.
+// ---------------------------------------------------------------------------
+static struct replayWriter* recorder = NULL;
+
+// ---------------------------------------------------------------------------
+// Autopilot (Taste a, Option -a): wählt in jedem Takt die Richtung über
+// planAutopilot(). Seine Richtungswechsel werden wie Tasten aufgezeichnet,
+// ein Replay läuft also auch ohne Autopilot identisch ab.
+// ---------------------------------------------------------------------------
+static bool autopilot_on = false;
+
+// ---------------------------------------------------------------------------
+// MCTS-Bot (Taste m, Option -m): plant jeden Takt mit planMcts() auf
+// mcts_workers Threads (Option -j, 0 = alle Prozessoren). Aufgezeichnet
+// wird wie beim Autopiloten nur die gewählte Richtung.
+// ---------------------------------------------------------------------------
+static bool mcts_on = false;
+static int mcts_workers = 0;
+
+// ---------------------------------------------------------------------------
+// Framebuffer-Renderer (Option -F): zeichnet das Spielfeld im Terminal mit
+// einem write() pro Frame statt über ncurses (siehe render.h).
+// terminalRenderer() liefert den Renderer für Spiel und Replay-Anzeige.
+// ---------------------------------------------------------------------------
+static bool framebuffer_on = false;
+static struct frameRenderer framebuffer = {0};
+
+static struct renderer* terminalRenderer(void)
+{
+    return framebuffer_on ? &framebuffer.base : getCursesRenderer();
+}
+
+// ---------------------------------------------------------------------------
+// Zeitprofil der Spielschleife je Phase (siehe tickprof.h). Gemessen wird
+// immer; die Taste t blendet die Werte ein (profile_visible), Option -T
+// schreibt sie am Ende als CSV nach profile_path.
+// ---------------------------------------------------------------------------
+static struct tickProfile profile;
+static bool profile_visible = false;
+static const char* profile_path = NULL;
+
+// ---------------------------------------------------------------------------
+// Eingabepuffer: collectUserInput() liest alle anliegenden Tasten mit ihrer
+// Ankunftszeit, readUserInput() wertet sie im nächsten Takt gemeinsam aus.
+// heading_key_ns ist die Ankunft der ersten Richtungstaste, die noch auf
+// ihren Schritt wartet (0: keine).
+// ---------------------------------------------------------------------------
+#define INPUT_BUFFER_KEYS 64
+
+struct keyBuffer {
+    int keys[INPUT_BUFFER_KEYS];
+    long long key_ns[INPUT_BUFFER_KEYS];
+    int count;
+};
+
+static struct keyBuffer input;
+static long long heading_key_ns = 0;
+
+static void recordKey(enum ReplayEvents event)
+{
+    if (recorder != NULL) {
+        recordReplayEvent(recorder, event);
+    }
+}
+
 
 // ---------------------------------------------------------------------------
 // initializeColors
@@ -69,108 +151,178 @@ void initializeColors(void)
 }
 
 
+// ---------------------------------------------------------------------------
+// collectUserInput
+// ---------------------------------------------------------------------------
+// Aufgabe:
+//    Liest alle anliegenden Tasten (getch() im nodelay-Modus bis ERR) in
+//    den Eingabepuffer, jede mit dem Zeitpunkt des Lesens. doLevel() ruft
+//    die Funktion auf, sobald waitForTicks() wegen einer Taste aufwacht;
+//    dieser Zeitpunkt ist also praktisch die Ankunftszeit.
+//
+// Hinweis:
+//    Ist der Puffer voll, bleiben weitere Tasten bei ncurses liegen und
+//    werden beim nächsten Aufruf gelesen.
+// ---------------------------------------------------------------------------
+
+static void collectUserInput(void)
+{
+    long long now = monotonicNowNs();
+
+    while (input.count < INPUT_BUFFER_KEYS) {
+        int ch = getch();
+        if (ch == ERR) {
+            break;      // keine weitere Taste
+        }
+        input.keys[input.count]   = ch;
+        input.key_ns[input.count] = now;
+        input.count++;
+    }
+}
+
+
 // ---------------------------------------------------------------------------
 // readUserInput
 // ---------------------------------------------------------------------------
 // Aufgabe:
-//    Verarbeitet eine Tastatureingabe und reagiert darauf:
+//    Wertet alle seit dem letzten Takt angefallenen Tasten gemeinsam aus:
 //
-//    - Richtungsänderungen des Wurms
-//    - Spiel beenden
-//    - diagonale Bewegungen (Sondertasten 1 bis 4)
-//    - manuelles Wachstum
+//    - Richtungsänderungen des Wurms (auch diagonal, Sondertasten 1 bis 4):
+//      es gilt die letzte Richtungstaste, aufgezeichnet wird nur sie
+//    - manuelles Wachstum: jeder Druck auf g zählt
+//    - Spiel beenden (weitere Tasten werden verworfen)
 //    - Pause ein und aus
+//    - Autopilot und MCTS-Bot ein und aus
 //
 // Rückgabewert:
 //    true  wenn ein Bewegungsschritt durchgeführt werden soll
 //    false wenn keine Bewegung stattfinden soll (zum Beispiel bei Pause)
 //
 // Hinweis:
-//    Das Spiel nutzt standardmäßig non-blocking Eingabe. Nur Dialoge arbeiten
-//    blockierend. Das Abfangen von ERR bedeutet, dass keine Taste gedrückt wurde.
+//    Früher wurde pro Takt genau eine Taste gelesen: schnell getippte
+//    Tasten stauten sich und wirkten erst Takte später. Die Zeit von der
+//    ersten noch nicht ausgeführten Richtungstaste bis zum Schritt misst
+//    doLevel() über heading_key_ns.
 // ---------------------------------------------------------------------------
 
 static bool readUserInput(struct worm* aworm,
                           enum GameStates* agame_state)
 {
-    int ch;
-    bool do_step = false;
-
-    ch = getch();
-    if (ch == ERR) {
-        return false;    // Keine Eingabe vorhanden
+    int heading = -1;           // letzte Richtungstaste oder -1
+    long long heading_ns = 0;   // Ankunft der ersten Richtungstaste
+    int grow = 0;
+
+    collectUserInput();
+
+    for (int i = 0; i < input.count && *agame_state == WORM_GAME_ONGOING; i++) {
+        int dir = -1;
+
+        switch (input.keys[i]) {
+
+            case 'q':
+                *agame_state = WORM_GAME_QUIT;
+                recordKey(REPLAY_EV_QUIT);
+                break;
+
+            // Bewegungsrichtungen
+            case KEY_UP:
+                dir = WORM_UP;
+                break;
+
+            case KEY_DOWN:
+                dir = WORM_DOWN;
+                break;
+
+            case KEY_LEFT:
+                dir = WORM_LEFT;
+                break;
+
+            case KEY_RIGHT:
+                dir = WORM_RIGHT;
+                break;
+
+            // Diagonale Bewegungen
+            case '1':
+                dir = WORM_UP_LEFT;
+                break;
+
+            case '2':
+                dir = WORM_UP_RIGHT;
+                break;
+
+            case '3':
+                dir = WORM_DOWN_RIGHT;
+                break;
+
+            case '4':
+                dir = WORM_DOWN_LEFT;
+                break;
+
+            // Manuelles Wachstum durch Taste g
+            case 'g':
+                grow++;
+                break;
+
+            // Pause einschalten
+            case 's':
+                paused = true;
+                recordKey(REPLAY_EV_PAUSE);
+                break;
+
+            // Pause beenden
+            case ' ':
+                paused = false;
+                recordKey(REPLAY_EV_UNPAUSE);
+                break;
+
+            // Autopilot umschalten (kein Ereignis: aufgezeichnet werden die
+            // Richtungen, die er wählt)
+            case 'a':
+                autopilot_on = !autopilot_on;
+                mcts_on = false;
+                break;
+
+            // MCTS-Bot umschalten (ersetzt den Autopiloten)
+            case 'm':
+                mcts_on = !mcts_on;
+                autopilot_on = false;
+                break;
+
+            // Zeitprofil ein- und ausblenden (nur Anzeige, keine Aufzeichnung)
+            case 't':
+                profile_visible = !profile_visible;
+                break;
+
+            default:
+                break;
+        }
+
+        if (dir >= 0) {
+            if (heading < 0) {
+                heading_ns = input.key_ns[i];
+            }
+            heading = dir;
+        }
     }
+    input.count = 0;
 
-    switch(ch) {
-
-        case 'q':
-            *agame_state = WORM_GAME_QUIT;
-            break;
-
-        // Bewegungsrichtungen
-        case KEY_UP:
-            setWormHeading(aworm, WORM_UP);
-            do_step = true;
-            break;
-
-        case KEY_DOWN:
-            setWormHeading(aworm, WORM_DOWN);
-            do_step = true;
-            break;
-
-        case KEY_LEFT:
-            setWormHeading(aworm, WORM_LEFT);
-            do_step = true;
-            break;
-
-        case KEY_RIGHT:
-            setWormHeading(aworm, WORM_RIGHT);
-            do_step = true;
-            break;
-
-        // Diagonale Bewegungen
-        case '1':
-            setWormHeading(aworm, WORM_UP_LEFT);
-            do_step = true;
-            break;
-
-        case '2':
-            setWormHeading(aworm, WORM_UP_RIGHT);
-            do_step = true;
-            break;
-
-        case '3':
-            setWormHeading(aworm, WORM_DOWN_RIGHT);
-            do_step = true;
-            break;
-
-        case '4':
-            setWormHeading(aworm, WORM_DOWN_LEFT);
-            do_step = true;
-            break;
-
-        // Manuelles Wachstum durch Taste g
-        case 'g':
-            growWorm(aworm, BONUS_MANUAL);
-            break;
-
-        // Pause einschalten
-        case 's':
-            paused = true;
-            nodelay(stdscr, FALSE);
-            break;
-
-        // Pause beenden
-        case ' ':
-            paused = false;
-            nodelay(stdscr, TRUE);
-            break;
+    // Wachstum und Richtung wirken unabhängig voneinander; die Reihenfolge
+    // der Ereignisse innerhalb des Takts spielt für das Replay keine Rolle
+    for (int i = 0; i < grow; i++) {
+        growWorm(aworm, BONUS_MANUAL);
+        recordKey(REPLAY_EV_GROW);
+    }
 
-        default:
-            break;
+    if (heading < 0 || *agame_state != WORM_GAME_ONGOING) {
+        return false;
     }
 
-    return do_step;
+    setWormHeading(aworm, (enum WormHeading)heading);
+    recordKey(REPLAY_EV_HEADING_0 + heading);
+    if (heading_key_ns == 0) {
+        heading_key_ns = heading_ns;
+    }
+    return true;
 }
 
 
@@ -230,7 +382,7 @@ void showGameOverMessage(enum GameStates gamestate)
 // Ablauf:
 //    - Text in der Mitte des Bildschirms ausgeben
 //    - auf Tastendruck warten
-//    - Spielfeld neu aufbauen
+//    - Spielfeld aus dem Modell neu zeichnen
 //    - Wurm zeichnen
 // ---------------------------------------------------------------------------
 
@@ -253,9 +405,9 @@ static void showStartScreen(struct board* aboard,
 
     clear();
 
-    initializeLevel(aboard);
-    showWorm(aboard, aworm);
-    refresh();
+    renderBoard(aboard);
+    showWholeWorm(aboard, aworm);
+    presentBoard(aboard);
 
     nodelay(stdscr, TRUE);
 }
@@ -273,115 +425,821 @@ static void showStartScreen(struct board* aboard,
 //    1. Board und Wurm initialisieren
 //    2. Startbildschirm anzeigen
 //    3. Status und Trennlinie zeigen
-//    4. Endlosschleife:
-//       - Eingaben auswerten
+//    4. Endlosschleife im festen Takt (siehe timing.h):
+//       - bis zum nächsten Termin warten, ggf. Schritte nachholen; eine
+//         Taste weckt sofort und wird mit ihrer Ankunftszeit gepuffert, im
+//         Pausenmodus wird nur auf Tasten gewartet
+//       - alle gepufferten Eingaben des Takts gemeinsam auswerten
+//       - bei aktivem Autopiloten oder MCTS-Bot (und ohne Pause) Richtung
+//         planen; der Bot teilt sich das Zeitbudget eines Takts mit den
+//         nachzuholenden Schritten
 //       - Wurm bewegen
 //       - Futter, Kollisionen, Wachstum verarbeiten
-//       - Spielfeld neu darstellen
+//       - geänderte Zellen darstellen (showWorm) und im Frame-Takt
+//         ausgeben (presentBoard), zusammen mit Jitter und Overruns
+//       - jede dieser Phasen geht in das Zeitprofil (tickprof.h), dazu
+//         die Zeit von der Richtungstaste bis zum Schritt
 //    5. Bei Game Over letzten Zustand darstellen und Meldung anzeigen
 // ---------------------------------------------------------------------------
 
 enum ResCodes doLevel(void)
 {
-    struct board theBoard;
-    struct worm  userWorm;
+    struct board theBoard = {0};
+    struct worm  userWorm = {0};
+    struct autopilot pilot = {0};
+    struct mctsBot bot = {0};
+    struct bitboard bits = {0};
+    struct reachTracker reach = {0};
 
     enum GameStates game_state = WORM_GAME_ONGOING;
+    bool profile_shown = false;
 
     paused = false;
     nodelay(stdscr, TRUE);
+    initializeTickProfile(&profile);
+    input.count    = 0;
+    heading_key_ns = 0;
+
+    // Standardlevel oder das erste Level der Datei aus Option -l
+    if (startGame(&theBoard,
+                  &userWorm,
+                  terminalRenderer(),
+                  MIN_NUMBER_OF_ROWS,
+                  MIN_NUMBER_OF_COLS) != RES_OK) {
+        freeWorm(&userWorm);
+        freeBoard(&theBoard);
+        return RES_FAILED;
+    }
 
-    initializeLevel(&theBoard);
-
-    struct pos headpos;
-    headpos.y = getLastRowOnBoard(&theBoard);
-    headpos.x = 0;
-
-    initializeWorm(&userWorm,
-                   WORM_LENGTH,
-                   WORM_INITIAL_LENGTH,
-                   headpos,
-                   WORM_RIGHT,
-                   COLP_USER_WORM);
+    // Bitboard und Reach-Tracker für die Fallenprüfung des Autopiloten
+    if (initializeAutopilot(&pilot, &theBoard) != RES_OK ||
+        initializeBitboard(&bits,
+                           getLastRowOnBoard(&theBoard) + 1,
+                           getLastColOnBoard(&theBoard) + 1) != RES_OK ||
+        attachBitboard(&theBoard, &bits) != RES_OK ||
+        attachReachTracker(&theBoard, &reach, &userWorm) != RES_OK) {
+        freeReachTracker(&reach);
+        freeBitboard(&bits);
+        freeAutopilot(&pilot);
+        freeWorm(&userWorm);
+        freeBoard(&theBoard);
+        return RES_FAILED;
+    }
 
-    showWorm(&theBoard, &userWorm);
-    refresh();
+    showWholeWorm(&theBoard, &userWorm);
+    presentBoard(&theBoard);
 
     showStartScreen(&theBoard, &userWorm);
 
+    // clear() im Startbildschirm hat auch die Statuszeile gelöscht
+    invalidateStatusLine();
     showBorderLine();
     showStatus(&theBoard, &userWorm);
 
-    while (game_state == WORM_GAME_ONGOING) {
+    struct tickScheduler sched;
+    initializeScheduler(&sched, NAP_TIME, FRAME_TIME, MAX_CATCHUP_TICKS);
+    attachSchedulerInput(&sched, STDIN_FILENO);
 
-        bool step = readUserInput(&userWorm, &game_state);
+    while (game_state == WORM_GAME_ONGOING) {
+        int ticks;
+
+        if (paused) {
+            // Nur auf Tasten warten (kein Zeitgeber); die Tasten werden in
+            // einem Takt ausgewertet
+            waitForInput(&sched);
+            ticks = 1;
+        } else {
+            // Bis zum nächsten absoluten Termin warten; liefert die Anzahl
+            // der fälligen Spielschritte (mehr als 1, wenn nachgeholt werden
+            // muss, 0, wenn eine Taste vorher geweckt hat)
+            ticks = waitForTicks(&sched);
+        }
+        collectUserInput();
+
+        int ticks_done = 0;
+
+        for (int i = 0; i < ticks; i++) {
+            bool was_paused = paused;
+            long long t = monotonicNowNs();
+
+            setProfileWormLength(&profile, getWormLength(&userWorm));
+            bool step = readUserInput(&userWorm, &game_state);
+            profilePhase(&profile, PHASE_INPUT, t);
+
+            // Threads des Bots erst beim ersten Einschalten starten
+            if (mcts_on && bot.workers == NULL &&
+                initializeMctsBot(&bot, &theBoard, mcts_workers) != RES_OK) {
+                mcts_on = false;
+            }
+
+            if ((autopilot_on || mcts_on) &&
+                !paused && game_state == WORM_GAME_ONGOING) {
+                enum WormHeading dir;
+                t = monotonicNowNs();
+                if (mcts_on) {
+                    dir = planMcts(&bot, &theBoard, &userWorm,
+                                   mctsBudgetNs() / ticks, NULL);
+                } else {
+                    planAutopilot(&pilot, &theBoard, &userWorm, &dir);
+                }
+                profilePhase(&profile, PHASE_PLAN, t);
+                if (dir != userWorm.heading) {
+                    setWormHeading(&userWorm, dir);
+                    recordKey(REPLAY_EV_HEADING_0 + dir);
+                }
+            }
+
+            if (recorder != NULL)
+                endReplayTick(recorder);
+
+            if (game_state != WORM_GAME_ONGOING)
+                break;
+
+            if (paused || was_paused) {
+                // Die Pausenzeit soll nicht nachgeholt werden, auch nicht
+                // im Takt, der die Pause beendet
+                rebaseScheduler(&sched);
+                if (paused && !step)
+                    continue;
+            }
+
+            t = monotonicNowNs();
+            cleanWormTail(&theBoard, &userWorm);
+            t = profilePhase(&profile, PHASE_TAIL, t);
+
+            moveWorm(&theBoard,
+                     &userWorm,
+                     &game_state);
+            t = profilePhase(&profile, PHASE_MOVE, t);
+
+            if (heading_key_ns != 0) {
+                addLatency(&profile.key_to_move, t - heading_key_ns);
+                heading_key_ns = 0;
+            }
+
+            if (game_state != WORM_GAME_ONGOING)
+                break;
+
+            showWorm(&theBoard, &userWorm);
+            profilePhase(&profile, PHASE_SHOW, t);
+            ticks_done++;
+        }
 
         if (game_state != WORM_GAME_ONGOING)
             break;
 
-        if (paused && !step)
-            continue;
+        // Ausgabe im eigenen Takt; nachgeholte Schritte teilen sich einen
+        // Frame. Im Pausenmodus gibt es keinen Takt: jede ausgewertete
+        // Taste bekommt sofort ihren Frame.
+        bool frame = frameDue(&sched, ticks_done);
+        if (frame || paused) {
+            long long t = monotonicNowNs();
+
+            showStatus(&theBoard, &userWorm);
+            if (profile_visible) {
+                showProfileStatus(&profile, true);
+                profile_shown = true;
+            } else {
+                if (profile_shown) {
+                    showProfileStatus(&profile, false);
+                    profile_shown = false;
+                }
+                showTimingStatus(&sched);
+            }
+            t = profilePhase(&profile, PHASE_STATUS, t);
+
+            presentBoard(&theBoard);
+            profilePhase(&profile, PHASE_PRESENT, t);
+        }
+    }
 
-        cleanWormTail(&theBoard, &userWorm);
+    detachSchedulerInput(&sched);
 
-        moveWorm(&theBoard,
-                 &userWorm,
-                 &game_state);
+    if (game_state != WORM_GAME_QUIT) {
+        showWorm(&theBoard, &userWorm);
+        showStatus(&theBoard, &userWorm);
+    }
+    presentBoard(&theBoard);
 
-        if (game_state != WORM_GAME_ONGOING)
-            break;
+    if (recorder != NULL)
+        closeReplayWriter(recorder, game_state, getWormLength(&userWorm));
 
-        showWorm(&theBoard, &userWorm);
+    showGameOverMessage(game_state);
 
-        showStatus(&theBoard, &userWorm);
+    freeMctsBot(&bot);
+    freeReachTracker(&reach);
+    freeBitboard(&bits);
+    freeAutopilot(&pilot);
+    freeWorm(&userWorm);
+    freeBoard(&theBoard);
+    return RES_OK;
+}
+
+
+// ---------------------------------------------------------------------------
+// doHeadlessRun
+// ---------------------------------------------------------------------------
+// Aufgabe:
+//    Führt ticks Spielschritte ohne Terminal aus und gibt den Durchsatz aus.
+//    Mit batch > 0 laufen batch Spiele im Gleichschritt (siehe batch_env.h),
+//    jedes davon ticks Schritte. Mit game_ticks > 0 endet jedes Spiel nach
+//    spätestens game_ticks Schritten. Mit planes != BATCH_PLANES_NONE
+//    werden die Spiele nach jedem Schritt als Ebenen kodiert und die
+//    Kosten der Kodierung neben denen des Schritts ausgegeben.
+// ---------------------------------------------------------------------------
 
-        napms(NAP_TIME);
-        refresh();
+static enum ResCodes doHeadlessRun(long ticks, long game_ticks, int batch,
+                                   int planes, bool planes_f32,
+                                   int rows, int cols)
+{
+    struct headlessStats stats = {0};
+    enum ResCodes res = batch > 0
+                      ? runBatchHeadless(ticks, game_ticks, batch, rows, cols,
+                                         planes, planes_f32, &stats)
+                      : runHeadless(ticks, game_ticks, rows, cols, &stats);
+
+    if (res != RES_OK) {
+        fprintf(stderr, "Headless-Lauf fehlgeschlagen\n");
+        return RES_FAILED;
     }
 
-    if (game_state != WORM_GAME_QUIT) {
-        showWorm(&theBoard, &userWorm);
-        showStatus(&theBoard, &userWorm);
-        refresh();
+    printf("headless %s%dx%d: %ld Schritte, %ld Spiele, %.3f s, %.0f Schritte/s\n",
+           batch > 0 ? "batch " : "",
+           rows,
+           cols,
+           stats.ticks,
+           stats.games,
+           stats.seconds,
+           stats.seconds > 0 ? stats.ticks / stats.seconds : 0.0);
+    if (batch == 0 && stats.games > 0) {
+        printf("  Levelaufbau: %.2f us pro Spiel\n",
+               stats.start_seconds * 1e6 / stats.games);
     }
+    if (batch == 0) {
+        printf("  Hashwerte %ld-mal geprüft, keine Abweichung\n", stats.hash_checks);
+    }
+    if (planes != BATCH_PLANES_NONE && stats.ticks > 0) {
+        long elems = planes == BATCH_PLANES_FULL
+                   ? (long)OBS_PLANE_COUNT * rows * cols
+                   : obsCropElements(planes);
+
+        printf("  Ebenen %s, %s: %ld Bytes pro Spiel\n",
+               planes == BATCH_PLANES_FULL ? "ganzes Feld" : "Ausschnitt",
+               planes_f32 ? "f32" : "u8",
+               elems * (long)(planes_f32 ? sizeof(float) : sizeof(uint8_t)));
+        printf("  pro Spielschritt: Schritt %.1f ns, Kodierung %.1f ns (%.0f %%)\n",
+               stats.step_seconds * 1e9 / stats.ticks,
+               stats.encode_seconds * 1e9 / stats.ticks,
+               stats.step_seconds > 0
+                   ? 100.0 * stats.encode_seconds / stats.step_seconds : 0.0);
+    }
+    return RES_OK;
+}
 
-    showGameOverMessage(game_state);
+
+// ---------------------------------------------------------------------------
+// doCompileLevels
+// ---------------------------------------------------------------------------
+// Aufgabe:
+//    Übersetzt Level-Textdateien in ein Level-Paket (siehe level.h) und
+//    meldet, wie viele Level es enthält.
+// ---------------------------------------------------------------------------
+
+static enum ResCodes doCompileLevels(const char* out_path,
+                                     char* const inputs[], int n)
+{
+    const char* failed;
+    int count, line;
+
+    if (n == 0) {
+        fprintf(stderr, "Keine Level-Dateien angegeben\n");
+        return RES_FAILED;
+    }
+
+    if (compileLevels(out_path, inputs, n, &count, &failed, &line) != RES_OK) {
+        if (line > 0) {
+            fprintf(stderr, "Level-Datei fehlerhaft: %s, Zeile %d\n", failed, line);
+        } else {
+            fprintf(stderr, "Level-Datei fehlerhaft oder nicht lesbar: %s\n",
+                    failed != NULL ? failed : out_path);
+        }
+        return RES_FAILED;
+    }
+
+    printf("levels: %d Level aus %d Datei(en) -> %s\n", count, n, out_path);
     return RES_OK;
 }
 
 
 // ---------------------------------------------------------------------------
-// main
+// doAutopilotBenchmark
 // ---------------------------------------------------------------------------
 // Aufgabe:
-//    Programmanfang. Initialisiert ncurses und Farben,
-//    prüft die Fenstergröße und startet das Level.
-//
-// Rückgabe:
-//    RES_OK bei Erfolg
-//    RES_FAILED wenn das Fenster zu klein ist
+//    Misst die Planungskosten des Autopiloten pro Takt (siehe autopilot.h)
+//    und gibt je Spielfeldgröße eine Tabelle nach Wurmlänge aus. Ohne -s
+//    werden mehrere Größen vom Standardfeld bis 512x512 gemessen.
+// ---------------------------------------------------------------------------
+
+static enum ResCodes doAutopilotBenchmark(long ticks, int rows, int cols,
+                                          bool size_given)
+{
+    static const int sizes[][2] = {
+        { MIN_NUMBER_OF_ROWS, MIN_NUMBER_OF_COLS },
+        { 64, 128 },
+        { 256, 256 },
+        { 512, 512 }
+    };
+    int count = size_given ? 1 : (int)(sizeof(sizes) / sizeof(sizes[0]));
+
+    for (int s = 0; s < count; s++) {
+        struct autopilotBench bench;
+        int r = size_given ? rows : sizes[s][0];
+        int c = size_given ? cols : sizes[s][1];
+
+        if (runAutopilotBenchmark(ticks, r, c, &bench) != RES_OK) {
+            fprintf(stderr, "Autopilot-Benchmark fehlgeschlagen (%dx%d)\n", r, c);
+            return RES_FAILED;
+        }
+
+        printf("autopilot %dx%d: %ld Schritte, %ld Spiele, %ld Futter\n",
+               r, c, bench.ticks, bench.games, bench.food);
+        printf("  Fallen: %ld Plaene geaendert; Reach-Tracker: %ld lokal, "
+               "%ld Flood Fills\n",
+               bench.avoided, bench.reach_incremental, bench.reach_fills);
+        printf("  %-13s %10s %12s %14s\n",
+               "Laenge", "Plaene", "us/Plan", "Zellen/Plan");
+
+        for (int k = 0; k < AP_BENCH_CLASSES; k++) {
+            if (bench.plans[k] == 0) {
+                continue;
+            }
+            printf("  %6ld-%-6ld %10ld %12.2f %14.0f\n",
+                   1L << k,
+                   (2L << k) - 1,
+                   bench.plans[k],
+                   bench.ns[k] / 1e3 / bench.plans[k],
+                   (double)bench.expanded[k] / bench.plans[k]);
+        }
+    }
+    return RES_OK;
+}
+
+
+// ---------------------------------------------------------------------------
+// doMctsBenchmark
+// ---------------------------------------------------------------------------
+// Aufgabe:
+//    Lässt den MCTS-Bot ticks Schritte headless spielen, jeden mit vollem
+//    Zeitbudget, und gibt Rollouts pro Sekunde und Kern sowie die längste
+//    Planung im Vergleich zum Budget aus.
 // ---------------------------------------------------------------------------
 
-int main(void)
+static enum ResCodes doMctsBenchmark(long ticks, int rows, int cols)
 {
+    struct mctsBench bench;
+
+    if (runMctsBenchmark(ticks, rows, cols, mcts_workers, &bench) != RES_OK) {
+        fprintf(stderr, "MCTS-Benchmark fehlgeschlagen\n");
+        return RES_FAILED;
+    }
+
+    double per_core = bench.plan_seconds > 0
+                    ? bench.rollouts / bench.plan_seconds / bench.workers
+                    : 0.0;
+
+    printf("mcts %dx%d: %ld Schritte, %ld Spiele, %ld Futter, %d Threads\n",
+           rows, cols, bench.ticks, bench.games, bench.food, bench.workers);
+    printf("  %ld Rollouts, %.0f Rollouts/Plan, %.0f Rollouts/s/Kern\n",
+           bench.rollouts,
+           bench.ticks > 0 ? (double)bench.rollouts / bench.ticks : 0.0,
+           per_core);
+    printf("  Planung: Budget %.1f ms, Mittel %.1f ms, Maximum %.1f ms\n",
+           mctsBudgetNs() / 1e6,
+           bench.ticks > 0 ? bench.plan_seconds * 1e3 / bench.ticks : 0.0,
+           bench.max_plan_seconds * 1e3);
+    return RES_OK;
+}
+
+
+// ---------------------------------------------------------------------------
+// startFramebuffer / reportFramebuffer
+// ---------------------------------------------------------------------------
+// Aufgabe:
+//    Mit Option -F nach dem Start von ncurses die Puffer des
+//    Framebuffer-Renderers anlegen (sonst nichts tun) bzw. nach endwin()
+//    die Ausgabemenge je Frame ausgeben und die Puffer freigeben.
+// ---------------------------------------------------------------------------
+
+static enum ResCodes startFramebuffer(void)
+{
+    if (!framebuffer_on) {
+        return RES_OK;
+    }
+    if (initializeFrameRenderer(&framebuffer, STDOUT_FILENO) != RES_OK) {
+        cleanupCursesApp();
+        fprintf(stderr, "Kein Speicher fuer den Framebuffer\n");
+        return RES_FAILED;
+    }
+    return RES_OK;
+}
+
+static void reportFramebuffer(void)
+{
+    if (!framebuffer_on) {
+        return;
+    }
+
+    printf("framebuffer: %ld Frames (%ld mit Ausgabe), %ld Bytes, "
+           "%.1f Bytes/Frame, max %ld Bytes, %ld Zellen, %ld volle Neuzeichnungen\n",
+           framebuffer.frames,
+           framebuffer.frames_sent,
+           framebuffer.bytes,
+           framebuffer.frames_sent > 0
+               ? (double)framebuffer.bytes / framebuffer.frames_sent : 0.0,
+           framebuffer.max_bytes,
+           framebuffer.cells,
+           framebuffer.full_redraws);
+    freeFrameRenderer(&framebuffer);
+}
+
+
+// ---------------------------------------------------------------------------
+// doReplay
+// ---------------------------------------------------------------------------
+// Aufgabe:
+//    Spielt eine Replay-Datei ab und prüft das Ergebnis gegen die
+//    Aufzeichnung. Ohne frame_every läuft die Wiedergabe headless mit voller
+//    Geschwindigkeit, sonst im Terminal mit jedem frame_every-ten Takt als
+//    Frame.
+// ---------------------------------------------------------------------------
+
+static enum ResCodes doReplay(const char* path, int frame_every)
+{
+    struct replay rep = {0};
+    struct replayResult result;
+    struct renderer* renderer = getNullRenderer();
+
+    if (loadReplay(&rep, path) != RES_OK) {
+        fprintf(stderr, "Replay kann nicht gelesen werden: %s\n", path);
+        return RES_FAILED;
+    }
+
+    if (frame_every > 0) {
+        initializeCursesApplication();
+        initializeColors();
+        if (startFramebuffer() != RES_OK) {
+            freeReplay(&rep);
+            return RES_FAILED;
+        }
+        renderer = terminalRenderer();
+    }
+
+    enum ResCodes res = playReplay(&rep, renderer, frame_every, &result);
+
+    if (frame_every > 0) {
+        showDialog("Replay beendet.", "Bitte eine beliebige Taste drücken.");
+        cleanupCursesApp();
+        reportFramebuffer();
+    }
+    freeReplay(&rep);
+
+    if (res != RES_OK) {
+        fprintf(stderr, "Replay beschaedigt oder Spielfeld ungueltig: %s\n", path);
+        return RES_FAILED;
+    }
+
+    printf("replay %dx%d: %lu Takte, %ld Schritte, %.3f s, %.0f Takte/s\n",
+           rep.rows,
+           rep.cols,
+           result.ticks,
+           result.moves,
+           result.seconds,
+           result.seconds > 0 ? result.ticks / result.seconds : 0.0);
+    printf("Ende: Zustand %d, Laenge %d (aufgezeichnet: %d, %d) - %s\n",
+           result.state,
+           result.length,
+           result.recorded_state,
+           result.recorded_length,
+           result.matches ? "identisch" : "ABWEICHUNG");
+
+    return result.matches ? RES_OK : RES_FAILED;
+}
+
+
+// ---------------------------------------------------------------------------
+// doGenerateLevels
+// ---------------------------------------------------------------------------
+// Aufgabe:
+//    Erzeugt count zufällige Level der Größe rows x cols auf mcts_workers
+//    Threads (siehe levelgen.h) und gibt den Durchsatz aus. Ist alf nicht
+//    NULL, bleiben die Level darin erhalten (zum Spielen oder Speichern).
+// ---------------------------------------------------------------------------
+
+static enum ResCodes doGenerateLevels(int count, int rows, int cols,
+                                      struct levelFile* alf)
+{
+    struct levelGenParams params;
+    struct levelGenStats stats;
+
+    defaultLevelGenParams(&params, rows, cols);
+    if (generateLevels(&params, count, mcts_workers, alf, &stats) != RES_OK) {
+        fprintf(stderr, "Level-Erzeugung fehlgeschlagen (%dx%d)\n", rows, cols);
+        return RES_FAILED;
+    }
+
+    printf("levelgen %dx%d: %ld Level, %d Threads, %.3f s, %.0f Level/s, "
+           "%ld Wandanordnungen verworfen\n",
+           rows,
+           cols,
+           stats.levels,
+           stats.workers,
+           stats.seconds,
+           stats.seconds > 0 ? stats.levels / stats.seconds : 0.0,
+           stats.retries);
+    return RES_OK;
+}
+
+
+// ---------------------------------------------------------------------------
+// doTerminalGame
+// ---------------------------------------------------------------------------
+// Aufgabe:
+//    Spiel im Terminal: optional Aufzeichnung öffnen, ncurses und Farben
+//    initialisieren, Fenstergröße prüfen und das Level spielen. Danach
+//    ggf. Framebuffer-Statistik und Zeitprofil (Option -T) ausgeben.
+// ---------------------------------------------------------------------------
+
+static enum ResCodes doTerminalGame(const char* record_path)
+{
+    struct replayWriter writer;
+
+    if (record_path != NULL) {
+        if (openReplayWriter(&writer, record_path, 0,
+                             MIN_NUMBER_OF_ROWS, MIN_NUMBER_OF_COLS) != RES_OK) {
+            fprintf(stderr, "Replay kann nicht angelegt werden: %s\n", record_path);
+            return RES_FAILED;
+        }
+        recorder = &writer;
+    }
+
     initializeCursesApplication();
     initializeColors();
+    if (startFramebuffer() != RES_OK) {
+        return RES_FAILED;
+    }
 
     if (LINES < MIN_NUMBER_OF_ROWS + ROWS_RESERVED ||
         COLS  < MIN_NUMBER_OF_COLS)
     {
         endwin();
+        freeFrameRenderer(&framebuffer);
         printf("\nDas Fenster ist zu klein! Mindestgröße: %dx%d\n",
                 MIN_NUMBER_OF_COLS,
                 MIN_NUMBER_OF_ROWS + ROWS_RESERVED);
         return RES_FAILED;
     }
 
-    doLevel();
+    // Bei Erfolg beendet showGameOverMessage() ncurses
+    if (doLevel() != RES_OK) {
+        cleanupCursesApp();
+        freeFrameRenderer(&framebuffer);
+        fprintf(stderr, "Level kann nicht aufgebaut werden (Fenster zu klein?)\n");
+        return RES_FAILED;
+    }
+    reportFramebuffer();
+
+    if (profile_path != NULL) {
+        if (writeTickProfileCsv(&profile, profile_path) != RES_OK) {
+            fprintf(stderr, "Zeitprofil kann nicht geschrieben werden: %s\n",
+                    profile_path);
+            return RES_FAILED;
+        }
+        printf("Zeitprofil: %s (%ld Takte)\n",
+               profile_path, profile.all[PHASE_MOVE].count);
+    }
     return RES_OK;
 }
 
 
+// ---------------------------------------------------------------------------
+// main
+// ---------------------------------------------------------------------------
+// Aufgabe:
+//    Programmanfang. Wertet die Kommandozeile aus, initialisiert ncurses
+//    und Farben, prüft die Fenstergröße und startet das Level.
+//
+// Optionen:
+//    -H ticks   Headless-Lauf ohne Terminal über ticks Spielschritte
+//    -s RxC     Spielfeldgröße für den Headless-Lauf (z. B. 1024x1024)
+//    -E n       Headless-Lauf mit n Spielen im Gleichschritt (Batch)
+//    -O art     mit -E: nach jedem Schritt alle Spiele als Ebenen kodieren
+//               (obs_encoder.h) und die Kosten messen; art ist u8 oder f32,
+//               mit :r ein Ausschnitt mit Radius r um den Kopf (u8:5)
+//    -g ticks   Headless: jedes Spiel nach spätestens ticks Schritten beenden
+//    -r datei   Spiel im Terminal als Replay aufzeichnen
+//    -p datei   Replay headless mit voller Geschwindigkeit abspielen
+//    -f n       mit -p: im Terminal abspielen, jeder n-te Takt ein Frame
+//    -F         im Terminal den Framebuffer-Renderer benutzen (ein write()
+//               je Frame) und am Ende die Bytes pro Frame ausgeben
+//    -T datei   Zeitprofil der Spielschleife je Phase am Ende als CSV
+//               schreiben (Taste t blendet es während des Spiels ein)
+//    -a         Spiel mit eingeschaltetem Autopiloten beginnen
+//    -B ticks   Planungskosten des Autopiloten messen (ticks je Feldgröße)
+//    -m         Spiel mit eingeschaltetem MCTS-Bot beginnen
+//    -M ticks   MCTS-Bot headless über ticks Schritte messen
+//    -j n       Threads des MCTS-Bots (Standard: alle Prozessoren)
+//    -l datei   Level aus einer Datei (Text oder Level-Paket, siehe level.h);
+//               Headless-Läufe und Benchmarks spielen die Level reihum
+//    -c datei   die übrigen Argumente (Level-Textdateien) in das
+//               Level-Paket datei übersetzen
+//    -G n       n zufällige Level erzeugen (Größe -s, Threads -j); mit -c
+//               als Paket speichern, mit -H, -B oder -M reihum spielen,
+//               sonst nur den Durchsatz messen
+//
+// Rückgabe:
+//    RES_OK bei Erfolg
+//    RES_FAILED wenn das Fenster zu klein ist oder die Optionen fehlerhaft
+// ---------------------------------------------------------------------------
+
+int main(int argc, char* argv[])
+{
+    long headless_ticks = 0;
+    long game_ticks = 0;
+    int batch = 0;
+    int planes = BATCH_PLANES_NONE;
+    bool planes_f32 = false;
+    const char* record_path = NULL;
+    const char* replay_path = NULL;
+    int frame_every = 0;
+    long bench_ticks = 0;
+    long mcts_ticks = 0;
+    bool size_given = false;
+    const char* level_path = NULL;
+    const char* compile_path = NULL;
+    int generate = 0;
+    struct levelFile levels = {0};
+    enum ResCodes res;
+    int rows = MIN_NUMBER_OF_ROWS;
+    int cols = MIN_NUMBER_OF_COLS;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "H:s:E:O:g:r:p:f:FT:aB:mM:j:l:c:G:")) != -1) {
+        switch (opt) {
+            case 'H':
+                headless_ticks = atol(optarg);
+                break;
+            case 'E':
+                batch = atoi(optarg);
+                break;
+            case 'O': {
+                char fmt[4];
+                int radius = BATCH_PLANES_FULL;
+                int fields = sscanf(optarg, "%3[a-z0-9]:%d", fmt, &radius);
+
+                if (fields < 1 || (fields == 2 && (radius < 1 ||
+                                                   radius > OBS_MAX_CROP_RADIUS)) ||
+                    (strcmp(fmt, "u8") != 0 && strcmp(fmt, "f32") != 0)) {
+                    fprintf(stderr, "Ungueltige Ebenen: %s\n", optarg);
+                    return RES_FAILED;
+                }
+                planes = radius;
+                planes_f32 = strcmp(fmt, "f32") == 0;
+                break;
+            }
+            case 'g':
+                game_ticks = atol(optarg);
+                break;
+            case 'r':
+                record_path = optarg;
+                break;
+            case 'p':
+                replay_path = optarg;
+                break;
+            case 'f':
+                frame_every = atoi(optarg);
+                break;
+            case 'F':
+                framebuffer_on = true;
+                break;
+            case 'T':
+                profile_path = optarg;
+                break;
+            case 'a':
+                autopilot_on = true;
+                break;
+            case 'B':
+                bench_ticks = atol(optarg);
+                break;
+            case 'm':
+                mcts_on = true;
+                break;
+            case 'M':
+                mcts_ticks = atol(optarg);
+                break;
+            case 'j':
+                mcts_workers = atoi(optarg);
+                break;
+            case 'l':
+                level_path = optarg;
+                break;
+            case 'c':
+                compile_path = optarg;
+                break;
+            case 'G':
+                generate = atoi(optarg);
+                break;
+            case 's':
+                if (sscanf(optarg, "%dx%d", &rows, &cols) != 2) {
+                    fprintf(stderr, "Ungueltige Groesse: %s\n", optarg);
+                    return RES_FAILED;
+                }
+                size_given = true;
+                break;
+            default:
+                fprintf(stderr, "Aufruf: %s [-H ticks] [-s RxC] [-E n [-O art]] [-g ticks] [-r datei] [-p datei [-f n]] [-F] [-T datei] [-a] [-B ticks] [-m] [-M ticks] [-j n] [-l datei] [-c datei text...] [-G n]\n", argv[0]);
+                return RES_FAILED;
+        }
+    }
+
+    if (generate > 0) {
+        bool keep = compile_path != NULL ||
+                    headless_ticks > 0 || bench_ticks > 0 || mcts_ticks > 0;
+
+        if (level_path != NULL || batch > 0 ||
+            record_path != NULL || replay_path != NULL) {
+            fprintf(stderr, "-G ist nicht mit -l, -E, -r oder -p kombinierbar\n");
+            return RES_FAILED;
+        }
+        if (doGenerateLevels(generate, rows, cols, keep ? &levels : NULL) != RES_OK) {
+            return RES_FAILED;
+        }
+        if (!keep) {
+            return RES_OK;
+        }
+        if (compile_path != NULL) {
+            res = writeLevelFile(compile_path, &levels);
+            if (res != RES_OK) {
+                fprintf(stderr, "Level-Paket kann nicht geschrieben werden: %s\n",
+                        compile_path);
+            }
+            closeLevelFile(&levels);
+            return res;
+        }
+        useLevelFile(&levels);
+        size_given = true;
+    } else if (compile_path != NULL) {
+        return doCompileLevels(compile_path, argv + optind, argc - optind);
+    }
+
+    if (level_path != NULL) {
+        // Replays zeichnen nur das Standardlevel auf, die Batch-Umgebung
+        // spielt ein einziges Startlevel
+        if (batch > 0 || record_path != NULL || replay_path != NULL) {
+            fprintf(stderr, "-l ist nicht mit -E, -r oder -p kombinierbar\n");
+            return RES_FAILED;
+        }
+        if (openLevelFile(&levels, level_path) != RES_OK) {
+            if (levels.error_line > 0) {
+                fprintf(stderr, "Level-Datei fehlerhaft: %s, Zeile %d\n",
+                        level_path, levels.error_line);
+            } else {
+                fprintf(stderr, "Level-Datei kann nicht gelesen werden: %s\n",
+                        level_path);
+            }
+            return RES_FAILED;
+        }
+        useLevelFile(&levels);
+        rows = levels.rows;
+        cols = levels.cols;
+        size_given = true;
+    }
+
+    if (planes != BATCH_PLANES_NONE && (batch == 0 || headless_ticks == 0)) {
+        fprintf(stderr, "-O braucht -H und -E\n");
+        return RES_FAILED;
+    }
+
+    if (headless_ticks > 0) {
+        res = doHeadlessRun(headless_ticks, game_ticks, batch,
+                            planes, planes_f32, rows, cols);
+    } else if (bench_ticks > 0) {
+        res = doAutopilotBenchmark(bench_ticks, rows, cols, size_given);
+    } else if (mcts_ticks > 0) {
+        res = doMctsBenchmark(mcts_ticks, rows, cols);
+    } else if (replay_path != NULL) {
+        res = doReplay(replay_path, frame_every);
+    } else {
+        res = doTerminalGame(record_path);
+    }
+
+    if (level_path != NULL || generate > 0) {
+        useLevelFile(NULL);
+        closeLevelFile(&levels);
+    }
+    return res;
+}
+
+
 
 
 
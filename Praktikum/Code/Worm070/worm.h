@@ -52,8 +52,14 @@ enum ResCodes {
 //  Diese Konstanten legen das grundlegende Verhalten des Spiels fest.
 //
 //  NAP_TIME:
-//     Zeitverzögerung zwischen zwei Spielschritten in Millisekunden.
-//     Kleinere Werte = schnelleres Spiel.
+//     Zeitabstand zwischen zwei Spielschritten in Millisekunden.
+//     Kleinere Werte = schnelleres Spiel. Der Takt wird über absolute
+//     Termine eingehalten (siehe timing.h), die Rechenzeit pro Schritt
+//     verlängert ihn also nicht.
+//
+//  FRAME_TIME:
+//     Zeitabstand zwischen zwei Bildschirmausgaben in Millisekunden.
+//     Unabhängig vom Simulationstakt NAP_TIME.
 //
 //  ROWS_RESERVED:
 //     Anzahl der Bildschirmzeilen, die **nicht** Teil des Spielfelds sind.
@@ -62,12 +68,20 @@ enum ResCodes {
 //  MIN_NUMBER_OF_ROWS / MIN_NUMBER_OF_COLS:
 //     Mindestgröße des Spielfelds. Das Programm prüft beim Start,
 //     ob das Terminal groß genug ist. Falls nicht, wird abgebrochen.
+//     Im Terminal wird genau mit dieser Größe gespielt.
+//
+//  MAX_NUMBER_OF_ROWS / MAX_NUMBER_OF_COLS:
+//     Größte Spielfeldgröße, die zur Laufzeit gewählt werden kann
+//     (Headless-Simulation, siehe initializeBoard()).
 // ============================================================================
 
 #define NAP_TIME            100
+#define FRAME_TIME          100
 #define ROWS_RESERVED       4
 #define MIN_NUMBER_OF_ROWS  26
 #define MIN_NUMBER_OF_COLS  70
+#define MAX_NUMBER_OF_ROWS  4096
+#define MAX_NUMBER_OF_COLS  4096
 
 
 // ============================================================================
@@ -155,6 +169,40 @@ enum GameStates {
 };
 
 
+// ============================================================================
+//  Bewegungsrichtungen des Wurms
+// ============================================================================
+//
+//  Jede Richtung bestimmt die Werte für dx und dy, die später von
+//  moveWorm() eingesetzt werden.
+//
+//     WORM_UP:        y - 1
+//     WORM_DOWN:      y + 1
+//     WORM_LEFT:      x - 1
+//     WORM_RIGHT:     x + 1
+//
+//  Dazu vier diagonale Richtungen. WORM_HEADINGS ist die Anzahl der
+//  Richtungen (Größe der Tabellen, die mit enum WormHeading indiziert werden).
+// ============================================================================
+
+enum WormHeading {
+    WORM_UP,
+    WORM_DOWN,
+    WORM_LEFT,
+    WORM_RIGHT,
+    WORM_UP_LEFT,
+    WORM_UP_RIGHT,
+    WORM_DOWN_RIGHT,
+    WORM_DOWN_LEFT
+};
+
+#define WORM_HEADINGS 8
+
+// Koordinatenänderung je Richtung (definiert in board_model.c)
+extern const int heading_dy[WORM_HEADINGS];
+extern const int heading_dx[WORM_HEADINGS];
+
+
 #endif  // _WORM_H
 
 
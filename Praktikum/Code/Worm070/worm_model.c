@@ -1,11 +1,58 @@
 // Worm070 - Aufgabenblatt 8
 // ============================================================================
 
-#include <curses.h>
+#include <stdlib.h>
 
 #include "worm.h"
 #include "board_model.h"
 #include "worm_model.h"
+#include "zobrist.h"
+
+// Kleinste Kapazität der Deque (Zweierpotenz)
+#define WORM_MIN_CAPACITY 16
+
+// ============================================================================
+//  reserveWormCells – Kapazität der Deque sicherstellen
+// ============================================================================
+// Vergrößert die Deque auf die nächste Zweierpotenz >= len. Die Zähler
+// head und tail bleiben dabei unverändert; jedes Segment i wandert nur von
+// wormcells[i & alte mask] nach wormcells[i & neue mask]. Ein Zählerwert
+// bezeichnet damit für die ganze Lebensdauer eines Segments dieselbe
+// Zelle (darauf bauen die Delta-Snapshots in snapshot.c auf).
+// Liefert RES_FAILED, wenn kein Speicher verfügbar ist (die Deque bleibt
+// dann unverändert).
+// ============================================================================
+enum ResCodes reserveWormCells(struct worm* aworm, unsigned int len)
+{
+    if (len <= aworm->capacity) {
+        return RES_OK;
+    }
+
+    unsigned int new_capacity = aworm->capacity > 0 ? aworm->capacity
+                                                    : WORM_MIN_CAPACITY;
+    while (new_capacity < len) {
+        new_capacity *= 2;
+    }
+
+    cellidx_t* cells = malloc(sizeof(cellidx_t) * new_capacity);
+    if (cells == NULL) {
+        return RES_FAILED;
+    }
+
+    if (aworm->wormcells != NULL) {
+        unsigned int new_mask = new_capacity - 1;
+        for (unsigned int i = aworm->tail; i != aworm->head + 1; i++) {
+            cells[i & new_mask] = aworm->wormcells[i & aworm->mask];
+        }
+        free(aworm->wormcells);
+    }
+
+    aworm->wormcells = cells;
+    aworm->capacity  = new_capacity;
+    aworm->mask      = new_capacity - 1;
+    return RES_OK;
+}
+
 
 // ============================================================================
 //  initializeWorm
@@ -16,6 +63,7 @@
 //    Länge, Kopfindex und Bewegungsrichtung gesetzt.
 //
 // Parameter:
+//    aboard    : Zeiger auf das Spielfeld (Kopfzelle wird dort markiert)
 //    aworm     : Zeiger auf die Wurmstruktur
 //    len_max   : maximal mögliche Länge des Wurms
 //    len_cur   : tatsächliche Startlänge
@@ -25,14 +73,18 @@
 //
 // Vorgehen:
 //    - Falls len_cur > len_max ist, wird korrigiert.
-//    - Alle Positionen des Ringspeichers werden in UNUSED_POS_ELEM gesetzt.
-//    - Die Kopfposition wird eingetragen.
+//    - Die Deque wird geleert und bei Bedarf auf len_cur Einträge vergrößert
+//      (nicht auf len_max: weiteres Wachstum reserviert growWorm()).
+//    - Die Kopfposition wird als einziges Segment eingetragen und im Board
+//      als belegt markiert; die restliche Startlänge ist ausstehendes
+//      Wachstum.
 //    - Richtung und Farbe werden gesetzt.
 //
 // Rückgabewert:
-//    RES_OK bei Erfolg.
+//    RES_OK bei Erfolg, RES_FAILED wenn kein Speicher verfügbar ist.
 // ============================================================================
-enum ResCodes initializeWorm(struct worm* aworm,
+enum ResCodes initializeWorm(struct board* aboard,
+                             struct worm* aworm,
                              int len_max,
                              int len_cur,
                              struct pos headpos,
@@ -42,18 +94,21 @@ enum ResCodes initializeWorm(struct worm* aworm,
     if (len_cur > len_max)
         len_cur = len_max;
 
-    aworm->maxindex      = len_max - 1;   // maximal genutzter Index im Ringspeicher
-    aworm->cur_lastindex = len_cur - 1;   // letzter Index der aktuellen Länge
-    aworm->headindex     = 0;             // Kopf befindet sich initial bei Index 0
+    // Deque leeren; vorhandener Speicher wird weiterverwendet
+    aworm->head = 0;
+    aworm->tail = 0;
+    aworm->hash = 0;    // ein Segment, keine Kanten
 
-    // Alle gespeicherten Positionen ungültig machen
-    for (int i = 0; i <= aworm->maxindex; i++) {
-        aworm->wormpos[i].x = UNUSED_POS_ELEM;
-        aworm->wormpos[i].y = UNUSED_POS_ELEM;
-    }
+    if (reserveWormCells(aworm, len_cur) != RES_OK)
+        return RES_FAILED;
+
+    aworm->maxlen         = len_max;
+    aworm->pending_growth = len_cur - 1;
 
     // Kopf auf Startposition setzen
-    aworm->wormpos[0] = headpos;
+    aworm->wormcells[aworm->head & aworm->mask] = posToCellIndex(aboard, headpos);
+    aworm->headpos = headpos;
+    setContentAt(aboard, headpos, BC_USED_BY_WORM);
 
     // Anfangsrichtung übernehmen
     setWormHeading(aworm, dir);
@@ -65,6 +120,18 @@ enum ResCodes initializeWorm(struct worm* aworm,
 }
 
 
+// ============================================================================
+//  freeWorm
+// ============================================================================
+void freeWorm(struct worm* aworm)
+{
+    free(aworm->wormcells);
+    aworm->wormcells = NULL;
+    aworm->capacity  = 0;
+    aworm->mask      = 0;
+}
+
+
 // ============================================================================
 //  setWormHeading
 // ============================================================================
@@ -72,9 +139,11 @@ enum ResCodes initializeWorm(struct worm* aworm,
 //    Setzt die Bewegungsrichtung des Wurms.
 //
 // Funktionsweise:
-//    Die Bewegungsrichtung wird durch zwei Werte beschrieben:
+//    Gespeichert wird die Richtung selbst (für den Nachbar-Versatz
+//    aboard->dir_offset[heading] in moveWorm()) und zusätzlich
 //       dx = Änderung der x-Koordinate
 //       dy = Änderung der y-Koordinate
+//    aus den Tabellen heading_dx / heading_dy.
 //
 //    Beispiel:
 //       WORM_UP bedeutet dy = -1 (eine Zeile nach oben), dx = 0.
@@ -84,16 +153,9 @@ enum ResCodes initializeWorm(struct worm* aworm,
 // ============================================================================
 void setWormHeading(struct worm* aworm, enum WormHeading dir)
 {
-    switch (dir) {
-        case WORM_UP:         aworm->dx =  0; aworm->dy = -1; break;
-        case WORM_DOWN:       aworm->dx =  0; aworm->dy =  1; break;
-        case WORM_LEFT:       aworm->dx = -1; aworm->dy =  0; break;
-        case WORM_RIGHT:      aworm->dx =  1; aworm->dy =  0; break;
-        case WORM_UP_LEFT:    aworm->dx = -1; aworm->dy = -1; break;
-        case WORM_UP_RIGHT:   aworm->dx =  1; aworm->dy = -1; break;
-        case WORM_DOWN_RIGHT: aworm->dx =  1; aworm->dy =  1; break;
-        case WORM_DOWN_LEFT:  aworm->dx = -1; aworm->dy =  1; break;
-    }
+    aworm->heading = dir;
+    aworm->dx = heading_dx[dir];
+    aworm->dy = heading_dy[dir];
 }
 
 
@@ -104,30 +166,42 @@ void setWormHeading(struct worm* aworm, enum WormHeading dir)
 //    Erhöht die Länge des Wurms um den angegebenen Bonuswert.
 //
 // Funktionsweise:
-//    Die Wurmlänge ergibt sich aus cur_lastindex + 1.
-//    Durch Wachstum wird cur_lastindex entsprechend vergrößert.
-//    Der maximale Wert bleibt aber durch maxindex begrenzt.
+//    Das Wachstum wird als pending_growth vorgemerkt; in den folgenden
+//    Schritten bleibt der Schwanz je einmal liegen (siehe cleanWormTail()).
+//    Die Gesamtlänge bleibt durch maxlen begrenzt.
+//
+//    Die Kapazität der Deque wird hier (beim Fressen, nicht bei jedem
+//    Schritt) auf die künftige Länge gebracht, durch Verdoppeln also
+//    amortisiert O(1) pro Segment. Ist kein Speicher mehr verfügbar, wächst
+//    der Wurm nur so weit, wie die vorhandene Kapazität reicht; der Aufrufer
+//    erfährt davon nichts.
 //
 // Wichtig:
 //    Es findet kein Doppelwachstum statt. Wachstum ist linear additiv.
 // ============================================================================
 void growWorm(struct worm* aworm, enum Boni growth)
 {
-    int new_lastindex = aworm->cur_lastindex + (int)growth;
+    int len = (int)(aworm->head - aworm->tail + 1);
+    int target = len + aworm->pending_growth + (int)growth;
+
+    if (target > aworm->maxlen)
+        target = aworm->maxlen;
 
-    if (new_lastindex > aworm->maxindex)
-        new_lastindex = aworm->maxindex;
+    if (reserveWormCells(aworm, target) != RES_OK)
+        target = (int)aworm->capacity;
 
-    aworm->cur_lastindex = new_lastindex;
+    if (target > len + aworm->pending_growth)
+        aworm->pending_growth = target - len;
 }
 
 
 // ============================================================================
-//  showWorm
+//  showWholeWorm
 // ============================================================================
 // Aufgabe:
-//    Zeichnet den gesamten Wurm auf das Spielfeld. Der Wurm liegt als
-//    Ringspeicher vor. Der Kopf ist headindex, der Schwanz ist headindex+1.
+//    Zeichnet den gesamten Wurm über den Renderer des Boards. Die Zellen
+//    sind bereits durch moveWorm() im Modell belegt; hier wird
+//    ausschließlich ausgegeben.
 //
 // Darstellung:
 //    Kopf   X (Symbol_WORM_HEAD)
@@ -135,52 +209,79 @@ void growWorm(struct worm* aworm, enum Boni growth)
 //    Körper 0 (Symbol_WORM_INNER)
 //
 // Vorgehen:
-//    - Start bei headindex
-//    - rückwärts durch den Ringspeicher laufen
-//    - an jeder gültigen Position das passende Symbol zeichnen
+//    - vom Schwanz (tail) bis zum Kopf (head) durch die Deque laufen
+//    - an jeder Position das passende Symbol zeichnen; der Kopf kommt
+//      zuletzt und gewinnt bei einem Wurm aus nur einem Segment
 //
 // Hinweis:
-//    Das Löschen des Schwanzsegments erfolgt separat durch cleanWormTail().
+//    Der Aufwand wächst mit der Wurmlänge. Im Spielschritt wird daher
+//    showWorm() verwendet; showWholeWorm() nur beim kompletten Neuzeichnen
+//    (Startbildschirm, nach renderBoard()).
 // ============================================================================
-void showWorm(struct board* aboard, struct worm* aworm)
+void showWholeWorm(struct board* aboard, struct worm* aworm)
 {
-    int ring_size = aworm->cur_lastindex + 1;
-    int idx = aworm->headindex;
-
-    // Schwanzindex ist der nächste Eintrag nach dem Kopf im Ringspeicher
-    int tailindex = (aworm->headindex + 1) % ring_size;
-
-    while (1) {
-        int y = aworm->wormpos[idx].y;
-        int x = aworm->wormpos[idx].x;
-
-        if (y != UNUSED_POS_ELEM) {
-
-            chtype sym;
-            enum ColorPairs col;
-
-            if (idx == aworm->headindex) {
-                sym = SYMBOL_WORM_HEAD;
-                col = COLP_WORM_HEAD;
-            }
-            else if (idx == tailindex) {
-                sym = SYMBOL_WORM_TAIL;
-                col = aworm->wcolor;
-            }
-            else {
-                sym = SYMBOL_WORM_INNER;
-                col = aworm->wcolor;
-            }
-
-            placeItem(aboard, y, x, BC_USED_BY_WORM, sym, col);
+    for (unsigned int i = aworm->tail; i != aworm->head + 1; i++) {
+        chtype sym;
+        enum ColorPairs col;
+
+        if (i == aworm->head) {
+            sym = SYMBOL_WORM_HEAD;
+            col = COLP_WORM_HEAD;
+        }
+        else if (i == aworm->tail) {
+            sym = SYMBOL_WORM_TAIL;
+            col = aworm->wcolor;
+        }
+        else {
+            sym = SYMBOL_WORM_INNER;
+            col = aworm->wcolor;
         }
 
-        if (idx == tailindex)
-            break;
+        struct pos p = cellIndexToPos(aboard, aworm->wormcells[i & aworm->mask]);
+        renderItem(aboard, p.y, p.x, sym, col);
+    }
+}
+
+
+// ============================================================================
+//  showWorm
+// ============================================================================
+// Aufgabe:
+//    Zeichnet nur die Zellen des Wurms neu, die sich im letzten Spielschritt
+//    verändert haben. Der Aufwand ist konstant, unabhängig von der Länge.
+//
+// Geänderte Zellen nach cleanWormTail() + moveWorm():
+//    - neuer Kopf             -> Kopfsymbol
+//    - bisheriger Kopf        -> jetzt Innensegment
+//    - neuer Schwanz          -> Schwanzsymbol
+//    - freigegebene Zelle     -> wurde bereits von cleanWormTail() gemeldet
+//
+// Hinweis:
+//    Die Segmente dazwischen stehen unverändert auf dem Bildschirm.
+//    Für ein komplettes Neuzeichnen gibt es showWholeWorm().
+// ============================================================================
+void showWorm(struct board* aboard, struct worm* aworm)
+{
+    unsigned int head = aworm->head;
+    unsigned int tail = aworm->tail;
 
-        // Im Ringspeicher rückwärts gehen
-        idx = (idx == 0) ? aworm->cur_lastindex : idx - 1;
+    // Ohne Ausgabe (headless) entfällt auch die Umrechnung der Positionen
+    if (!aboard->renderer->has_output)
+        return;
+
+    // Reihenfolge wie in showWholeWorm(): der Kopf gewinnt vor dem Schwanz
+    if (tail != head) {
+        struct pos p = cellIndexToPos(aboard, getWormTailCell(aworm));
+        renderItem(aboard, p.y, p.x, SYMBOL_WORM_TAIL, aworm->wcolor);
+    }
+
+    if (head - tail >= 2) {
+        struct pos p = cellIndexToPos(aboard, aworm->wormcells[(head - 1) & aworm->mask]);
+        renderItem(aboard, p.y, p.x, SYMBOL_WORM_INNER, aworm->wcolor);
     }
+
+    renderItem(aboard, aworm->headpos.y, aworm->headpos.x,
+               SYMBOL_WORM_HEAD, COLP_WORM_HEAD);
 }
 
 
@@ -191,25 +292,37 @@ void showWorm(struct board* aboard, struct worm* aworm)
 //    Löscht genau das Schwanzsegment des Wurms vom Spielfeld.
 //
 // Funktionsweise:
-//    tailindex = headindex + 1 im Ringspeicher.
-//    Diese Position wird wieder als freies Feld eingezeichnet.
+//    Steht Wachstum aus (pending_growth > 0), bleibt der Schwanz liegen
+//    und das Wachstum wird um eins verringert. Sonst wird das Schwanz-
+//    segment aus der Deque entfernt, im Board wieder als freies Feld
+//    eingetragen und dem Renderer gemeldet.
 //
 // Hinweis:
 //    Diese Funktion wird vor jeder Bewegung aufgerufen, bevor der neue
-//    Kopf eingezeichnet wird.
+//    Kopf eingezeichnet wird. Bei einem Wurm aus nur einem Segment ist die
+//    Deque danach kurz leer; moveWorm() liest die alte Kopfzelle trotzdem
+//    noch aus ihrem (nicht überschriebenen) Eintrag.
 // ============================================================================
 void cleanWormTail(struct board* aboard, struct worm* aworm)
 {
-    int ring_size = aworm->cur_lastindex + 1;
-    int tailindex = (aworm->headindex + 1) % ring_size;
-
-    if (aworm->wormpos[tailindex].y != UNUSED_POS_ELEM) {
-        placeItem(aboard,
-                  aworm->wormpos[tailindex].y,
-                  aworm->wormpos[tailindex].x,
-                  BC_FREE_CELL,
-                  SYMBOL_FREE_CELL,
-                  COLP_FREE_CELL);
+    if (aworm->pending_growth > 0) {
+        aworm->pending_growth--;
+        return;
+    }
+
+    cellidx_t tail = getWormTailCell(aworm);
+
+    // Kante zum nächsten Segment entfällt (nicht beim letzten Segment)
+    if (aworm->tail != aworm->head) {
+        aworm->hash ^= zobristEdgeKey(tail, aworm->wormcells[(aworm->tail + 1) & aworm->mask]);
+    }
+    aworm->tail++;
+
+    setContentAtIndex(aboard, tail, BC_FREE_CELL);
+
+    if (aboard->renderer->has_output) {
+        struct pos p = cellIndexToPos(aboard, tail);
+        renderItem(aboard, p.y, p.x, SYMBOL_FREE_CELL, COLP_FREE_CELL);
     }
 }
 
@@ -227,37 +340,36 @@ void cleanWormTail(struct board* aboard, struct worm* aworm)
 //       - Futter aufgenommen?
 //
 // Funktionsweise:
-//    - neue Kopfposition berechnen
-//    - Inhalt der Zielzelle auswerten
-//    - GameStates entsprechend setzen
+//    - neue Kopfzelle = alte Kopfzelle + Nachbar-Versatz der Richtung
+//    - Inhalt der Zielzelle auswerten; das Spielfeld ist von Barrieren
+//      umgeben, ein Schritt nach außen ist daher ebenfalls eine Barriere
+//    - GameStates entsprechend setzen (erst bei einer Barriere wird
+//      unterschieden, ob es der Rand war: WORM_OUT_OF_BOUNDS)
 //    - bei Futter: Wurm wachsen lassen + Futterzähler reduzieren
-//    - Kopfindex im Ringspeicher weiterschalten
+//    - neue Kopfzelle vorne an die Deque anfügen (Platz ist immer da:
+//      cleanWormTail() hat ein Segment entfernt oder growWorm() die
+//      Kapazität reserviert)
+//    - neue Kopfzelle im Board als BC_USED_BY_WORM markieren
+//    - Hashwerte nachführen: Kante alter -> neuer Kopf im Wurm, die Zelle
+//      selbst über setContentAtIndex() im Board (siehe zobrist.h)
+//
+// Hinweis:
+//    moveWorm() gibt nichts aus. Die Darstellung übernimmt showWorm().
 // ============================================================================
 void moveWorm(struct board* aboard,
               struct worm* aworm,
               enum GameStates* agame_state)
 {
-    struct pos headpos;
-
-    // Neue Kopfposition bestimmen
-    headpos.x = aworm->wormpos[aworm->headindex].x + aworm->dx;
-    headpos.y = aworm->wormpos[aworm->headindex].y + aworm->dy;
-
-    // Spielfeldgrenzen prüfen
-    if (headpos.x < 0 || headpos.x > aboard->last_col ||
-        headpos.y < 0 || headpos.y > aboard->last_row) {
-
-        *agame_state = WORM_OUT_OF_BOUNDS;
-        return;
-    }
-
-    // Inhalt der Zielzelle bestimmen
-    enum BoardCodes content = getContentAt(aboard, headpos);
+    // Eine Addition und ein Ladebefehl, keine Koordinatenprüfung
+    cellidx_t headcell = neighbourIndex(aboard, getWormHeadCell(aworm),
+                                        aworm->heading);
+    enum BoardCodes content = getContentAtIndex(aboard, headcell);
 
     switch (content) {
 
         case BC_BARRIER:
-            *agame_state = WORM_CRASH;
+            *agame_state = isBorderIndex(aboard, headcell) ? WORM_OUT_OF_BOUNDS
+                                                            : WORM_CRASH;
             return;
 
         case BC_USED_BY_WORM:
@@ -283,14 +395,18 @@ void moveWorm(struct board* aboard,
             break;
     }
 
-    // Kopfindex im Ringspeicher weiterschalten
-    aworm->headindex++;
-
-    if (aworm->headindex > aworm->cur_lastindex)
-        aworm->headindex = 0;
+    // Kante zum neuen Kopf, sofern die Deque nicht gerade leer ist (Wurm
+    // aus einem Segment, dessen Schwanz cleanWormTail() entfernt hat)
+    if (aworm->tail != aworm->head + 1) {
+        aworm->hash ^= zobristEdgeKey(getWormHeadCell(aworm), headcell);
+    }
 
-    // Neue Kopfposition schreiben
-    aworm->wormpos[aworm->headindex] = headpos;
+    // Neuen Kopf anfügen und im Modell belegen
+    aworm->head++;
+    aworm->wormcells[aworm->head & aworm->mask] = headcell;
+    aworm->headpos.y += aworm->dy;
+    aworm->headpos.x += aworm->dx;
+    setContentAtIndex(aboard, headcell, BC_USED_BY_WORM);
 }
 
 
@@ -298,19 +414,20 @@ void moveWorm(struct board* aboard,
 //  Getter-Funktionen
 // ============================================================================
 //  getWormHeadPos:
-//      Liefert die aktuelle Kopfposition aus dem Ringspeicher.
+//      Liefert die aktuelle Kopfposition (als Koordinate zwischengespeichert).
 //
 //  getWormLength:
-//      Berechnet die aktuelle Länge des Wurms aus cur_lastindex + 1.
+//      Länge des Wurms: Segmente in der Deque plus ausstehendes Wachstum
+//      (wie bisher wird die Startlänge also sofort angezeigt).
 // ============================================================================
 struct pos getWormHeadPos(struct worm* aworm)
 {
-    return aworm->wormpos[aworm->headindex];
+    return aworm->headpos;
 }
 
 int getWormLength(struct worm* aworm)
 {
-    return aworm->cur_lastindex + 1;
+    return (int)(aworm->head - aworm->tail + 1) + aworm->pending_growth;
 }
 
 
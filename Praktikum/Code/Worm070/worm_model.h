@@ -6,7 +6,7 @@
 //
 //    - die zentrale Datenstruktur struct worm
 //    - Bewegungsrichtungen
-//    - Ringpuffer-Größe und Markerwerte
+//    - Deque der Segmente (Zweierpotenz-Kapazität) und Markerwerte
 //    - Bonus-Werte für Futter und manuelles Wachstum
 //    - Funktionsprototypen für Initialisierung, Bewegung und Darstellung
 //
@@ -28,8 +28,10 @@
 // ============================================================================
 //
 //  UNUSED_POS_ELEM:
-//     Wird im Ringpuffer verwendet, um Positionen zu kennzeichnen,
-//     die momentan nicht belegt sind. Dies dient zur Initialisierung.
+//     Kennzeichnet eine ungültige Koordinate in struct pos.
+//
+//  In der Deque des Wurms stehen nur gültige Zellnummern (cellidx_t, siehe
+//  board_model.h); Lücken mit UNUSED_CELL_INDEX gibt es dort nicht mehr.
 // ============================================================================
 #define UNUSED_POS_ELEM -1
 
@@ -39,13 +41,15 @@
 // ============================================================================
 //
 //  WORM_LENGTH:
-//     Der Wurm verwendet einen Ringpuffer, dessen maximale Größe dem gesamten
-//     Spielfeld entspricht.
+//     Die maximale Länge des Wurms entspricht dem gesamten Spielfeld.
 //
 //     Hintergrund:
 //       Es könnte theoretisch jede Zelle des Spielfelds belegt werden.
 //       Deshalb ist die maximale Länge gleich der Anzahl aller Felder.
 //
+//     Da die Spielfeldgröße zur Laufzeit gewählt wird, gilt WORM_LENGTH nur
+//     für das Standardfeld. Allgemein liefert getNumberOfCells() die Länge.
+//
 //  WORM_INITIAL_LENGTH:
 //     Die Startlänge des Wurms beim Beginn eines Levels.
 // ============================================================================
@@ -79,45 +83,77 @@ enum Boni {
 //  Datenstruktur eines Wurms
 // ============================================================================
 //
-//  Die Struktur stellt einen Wurm als Ringpuffer dar.
+//  Die Struktur stellt einen Wurm als Deque (Ringpuffer mit Zweierpotenz-
+//  Kapazität) dar. Vorne wird der neue Kopf angefügt, hinten der Schwanz
+//  entfernt; die Segmente liegen lückenlos und in Reihenfolge vom Schwanz
+//  (tail) bis zum Kopf (head).
 //
 //  Felder:
 //
-//    cur_lastindex:
-//         Der letzte gültige Index im Ringpuffer. Dies bestimmt die aktuelle
-//         Länge des Wurms. Die tatsächliche Länge ist cur_lastindex + 1.
+//    wormcells[]:
+//         Array aller Segmente auf dem Heap (capacity Einträge). Jeder
+//         Eintrag ist die Zellnummer (cellidx_t) des Segments im Board.
 //
-//    maxindex:
-//         Größter zulässiger Index im Ringpuffer. Entspricht der maximal
-//         möglichen Wurmlänge.
+//    capacity / mask:
+//         capacity ist immer eine Zweierpotenz, mask = capacity - 1.
+//         Der Eintrag zum Zähler i liegt bei wormcells[i & mask]; es gibt
+//         weder Modulo noch Überlaufprüfungen.
 //
-//    headindex:
-//         Der Index, an dem sich der Kopf befindet.
-//         Alle anderen Segmente folgen rückwärts im Ringpuffer.
+//    head / tail:
+//         Frei laufende Zähler für Kopf und Schwanz. Sie werden nur erhöht
+//         und dürfen überlaufen (unsigned); die Länge ist head - tail + 1.
+//         Ein Segment behält seinen Zählerwert, bis es am Schwanz entfernt
+//         wird, auch wenn die Deque dazwischen wächst.
 //
-//    wormpos[]:
-//         Array aller Positionsdaten. Jeder Eintrag enthält eine x- und
-//         y-Koordinate. Unbenutzte Einträge stehen auf UNUSED_POS_ELEM.
+//    pending_growth:
+//         Noch ausstehendes Wachstum. Solange es größer 0 ist, bleibt der
+//         Schwanz bei einem Schritt liegen (cleanWormTail()), der Wurm wird
+//         also je Schritt um ein Segment länger.
 //
-//    dx, dy:
+//    maxlen:
+//         Maximal zulässige Länge (Segmente plus ausstehendes Wachstum).
+//
+//    headpos:
+//         Position des Kopfes als Koordinate. Entspricht
+//         wormcells[head & mask] und erspart die Rückrechnung (Division)
+//         im Spielschritt.
+//
+//    heading:
 //         Die Richtung, in die sich der Wurm beim nächsten Bewegungsschritt
-//         bewegen wird.
+//         bewegen wird. moveWorm() bestimmt damit die neue Kopfzelle als
+//         Kopfzelle + aboard->dir_offset[heading].
+//
+//    dx, dy:
+//         Dieselbe Richtung als Koordinatenänderung; damit wird headpos
+//         nachgeführt.
 //
 //    wcolor:
 //         Farbdefinition für den kompletten Wurm (außer Kopf).
+//
+//    hash:
+//         XOR der Zobrist-Schlüssel aller Kanten zwischen aufeinander-
+//         folgenden Segmenten (Reihenfolge des Körpers, siehe zobrist.h);
+//         von moveWorm() und cleanWormTail() inkrementell geführt.
 // ============================================================================
 struct worm {
-    int cur_lastindex;               // letzter gültiger Index (aktuelle Wurmlänge - 1)
-    int maxindex;                    // maximal zulässiger Index
+    cellidx_t* wormcells;            // Deque der Wurmsegmente (Heap)
+    unsigned int capacity;           // reservierte Einträge (Zweierpotenz)
+    unsigned int mask;               // capacity - 1
 
-    int headindex;                   // Position des Kopfes im Ringpuffer
+    unsigned int head;               // Zähler des Kopfes
+    unsigned int tail;               // Zähler des Schwanzes
+    int pending_growth;              // ausstehendes Wachstum in Segmenten
+    int maxlen;                      // maximal zulässige Länge
 
-    struct pos wormpos[WORM_LENGTH]; // Ringpuffer für Wurmsegmente
+    struct pos headpos;              // Kopfposition als Koordinate
 
+    enum WormHeading heading;        // aktuelle Bewegungsrichtung
     int dx;                          // Bewegungsrichtung in x-Richtung
     int dy;                          // Bewegungsrichtung in y-Richtung
 
     enum ColorPairs wcolor;          // Farbe des Wurms
+
+    uint64_t hash;                   // Zobrist-Anteil der Segmentfolge
 };
 
 
@@ -125,26 +161,9 @@ struct worm {
 //  Bewegungsrichtungen des Wurms
 // ============================================================================
 //
-//  Jede Richtung bestimmt die Werte für dx und dy, die später von
-//  moveWorm() eingesetzt werden.
-//
-//     WORM_UP:        y - 1
-//     WORM_DOWN:      y + 1
-//     WORM_LEFT:      x - 1
-//     WORM_RIGHT:     x + 1
-//
-//  Dazu vier diagonale Richtungen.
+//  enum WormHeading ist in worm.h definiert, da auch das Board (Tabelle der
+//  Nachbar-Versätze dir_offset) die Richtungen kennt.
 // ============================================================================
-enum WormHeading {
-    WORM_UP,
-    WORM_DOWN,
-    WORM_LEFT,
-    WORM_RIGHT,
-    WORM_UP_LEFT,
-    WORM_UP_RIGHT,
-    WORM_DOWN_RIGHT,
-    WORM_DOWN_LEFT
-};
 
 
 // ============================================================================
@@ -152,42 +171,82 @@ enum WormHeading {
 // ============================================================================
 //
 //  initializeWorm:
-//      Setzt die Startlänge, Position, Richtung und Farbe des Wurmes.
+//      Setzt die Startlänge, Position, Richtung und Farbe des Wurmes und
+//      markiert die Kopfzelle im Board als BC_USED_BY_WORM. Der Wurm
+//      beginnt mit einem Segment und wächst in den ersten Schritten auf
+//      len_cur. Vor dem ersten Aufruf muss der Wurm mit Nullen initialisiert
+//      sein (struct worm w = {0};), danach wird der Speicher weiterverwendet.
+//
+//  freeWorm:
+//      Gibt die Deque wieder frei.
 //
 //  growWorm:
-//      Erhöht die Länge durch Futter oder manuellen Bonus.
+//      Erhöht die Länge durch Futter oder manuellen Bonus. Reicht die
+//      Kapazität nicht, wird sie hier verdoppelt (amortisiert O(1) pro
+//      Segment). moveWorm() ruft growWorm() beim Fressen auf und kann
+//      deshalb auf einem Futterfeld Speicher anfordern. Schlägt das fehl,
+//      wird das Wachstum ohne Rückmeldung auf die vorhandene Kapazität
+//      gekürzt.
 //
 //  showWorm:
-//      Zeichnet den kompletten Wurm auf das Spielfeld.
+//      Gibt nur die im letzten Schritt geänderten Wurmzellen (neuer Kopf,
+//      alter Kopf, neuer Schwanz) über den Renderer aus. Konstanter Aufwand.
+//
+//  showWholeWorm:
+//      Gibt den kompletten Wurm über den Renderer aus (Neuzeichnen).
+//      Beide Funktionen verändern das Modell nicht.
 //
 //  cleanWormTail:
-//      Entfernt das Schwanzsegment vom Bildschirm.
+//      Entfernt den Schwanz (Zelle im Board frei, Meldung an den Renderer),
+//      außer es steht noch Wachstum aus.
 //
 //  moveWorm:
 //      Bewegt den Wurm und verarbeitet Futter, Kollisionen und Wachstum.
+//      Reine Spiellogik: die neue Kopfzelle wird nur im Board markiert,
+//      es findet keine Ausgabe statt (headless-fähig).
 //
 // Getter:
 //      getWormHeadPos  → liefert die aktuelle Kopfposition
-//      getWormLength   → liefert die Anzahl der Segmente
+//      getWormLength   → liefert die Länge inklusive ausstehendem Wachstum
 //
 // Setter:
 //      setWormHeading  → neue Bewegungsrichtung setzen
 // ============================================================================
-extern enum ResCodes initializeWorm(struct worm* aworm,
+extern enum ResCodes initializeWorm(struct board* aboard,
+                                    struct worm* aworm,
                                     int len_max,
                                     int len_cur,
                                     struct pos headpos,
                                     enum WormHeading dir,
                                     enum ColorPairs color);
 
+extern void freeWorm(struct worm* aworm);
+
+// Stellt sicher, dass die Deque len Segmente aufnehmen kann (Verdoppeln,
+// die Zähler head/tail bleiben gültig). RES_FAILED ohne Speicher.
+extern enum ResCodes reserveWormCells(struct worm* aworm, unsigned int len);
+
 extern void growWorm(struct worm* aworm, enum Boni growth);
 extern void showWorm(struct board* aboard, struct worm* aworm);
+extern void showWholeWorm(struct board* aboard, struct worm* aworm);
 extern void cleanWormTail(struct board* aboard, struct worm* aworm);
 
 extern void moveWorm(struct board* aboard,
                      struct worm* aworm,
                      enum GameStates* agame_state);
 
+// Zugriff auf die Deque (ohne Prüfung; der Wurm hat immer mindestens
+// ein Segment)
+static inline cellidx_t getWormHeadCell(struct worm* aworm)
+{
+    return aworm->wormcells[aworm->head & aworm->mask];
+}
+
+static inline cellidx_t getWormTailCell(struct worm* aworm)
+{
+    return aworm->wormcells[aworm->tail & aworm->mask];
+}
+
 // Getter-Funktionen
 extern struct pos getWormHeadPos(struct worm* aworm);
 extern int getWormLength(struct worm* aworm);
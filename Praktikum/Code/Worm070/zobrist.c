@@ -0,0 +1,135 @@
+// Worm070 - Aufgabenblatt 8
+// ============================================================================
+//  Modul: zobrist.c  –  Hashwert des Spielzustands, Transpositionstabelle
+// ============================================================================
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "worm.h"
+#include "board_model.h"
+#include "worm_model.h"
+#include "zobrist.h"
+
+_Static_assert(sizeof(struct ttData) == sizeof(uint64_t),
+               "struct ttData muss in ein 64-Bit-Wort passen");
+
+// ============================================================================
+//  Vollständige Berechnung
+// ============================================================================
+
+uint64_t computeBoardHash(struct board* aboard)
+{
+    uint64_t hash = 0;
+
+    // Rand und Auffüllung sind immer Barrieren und tragen nichts bei
+    for (int y = 0; y <= aboard->last_row; y++) {
+        cellidx_t idx = posToCellIndex(aboard, (struct pos){ y, 0 });
+        for (int x = 0; x <= aboard->last_col; x++, idx++) {
+            cell_t code = aboard->cells[idx];
+            if (code != BC_BARRIER) {
+                hash ^= zobristCellKey(idx, code)
+                      ^ zobristCellKey(idx, BC_BARRIER);
+            }
+        }
+    }
+    return hash;
+}
+
+uint64_t computeWormHash(struct worm* aworm)
+{
+    uint64_t hash = 0;
+
+    for (unsigned int i = aworm->tail; i != aworm->head; i++) {
+        hash ^= zobristEdgeKey(aworm->wormcells[i & aworm->mask],
+                               aworm->wormcells[(i + 1) & aworm->mask]);
+    }
+    return hash;
+}
+
+// ============================================================================
+//  Transpositionstabelle
+// ============================================================================
+
+static inline uint64_t packTTData(struct ttData data)
+{
+    uint64_t word;
+    memcpy(&word, &data, sizeof(word));
+    return word;
+}
+
+static inline struct ttData unpackTTData(uint64_t word)
+{
+    struct ttData data;
+    memcpy(&data, &word, sizeof(data));
+    return data;
+}
+
+enum ResCodes initializeTransTable(struct transTable* att, int log2_entries)
+{
+    if (log2_entries < 0 || log2_entries > TT_MAX_LOG2_ENTRIES) {
+        return RES_FAILED;
+    }
+
+    size_t count = (size_t)1 << log2_entries;
+
+    // Zwei Einträge pro Cache-Line, kein Eintrag über eine Grenze hinweg
+    att->entries = aligned_alloc(64, count * sizeof(struct ttEntry));
+    if (att->entries == NULL) {
+        att->mask = 0;
+        return RES_FAILED;
+    }
+    att->mask = count - 1;
+
+    clearTransTable(att);
+    return RES_OK;
+}
+
+void freeTransTable(struct transTable* att)
+{
+    free(att->entries);
+    att->entries = NULL;
+    att->mask    = 0;
+}
+
+void clearTransTable(struct transTable* att)
+{
+    for (uint64_t i = 0; i <= att->mask; i++) {
+        atomic_init(&att->entries[i].check, 0);
+        atomic_init(&att->entries[i].data, 0);
+    }
+}
+
+bool probeTransTable(struct transTable* att, uint64_t hash,
+                     struct ttData* out)
+{
+    struct ttEntry* e = &att->entries[hash & att->mask];
+    uint64_t data  = atomic_load_explicit(&e->data, memory_order_relaxed);
+    uint64_t check = atomic_load_explicit(&e->check, memory_order_relaxed);
+
+    // Leere Einträge (alles 0) passen nur zum Hashwert 0 und haben
+    // bound == TT_BOUND_NONE
+    if ((check ^ data) != hash || data == 0) {
+        return false;
+    }
+
+    *out = unpackTTData(data);
+    return true;
+}
+
+void storeTransTable(struct transTable* att, uint64_t hash,
+                     struct ttData data)
+{
+    struct ttEntry* e = &att->entries[hash & att->mask];
+    uint64_t old_data  = atomic_load_explicit(&e->data, memory_order_relaxed);
+    uint64_t old_check = atomic_load_explicit(&e->check, memory_order_relaxed);
+
+    if ((old_check ^ old_data) == hash &&
+        unpackTTData(old_data).depth > data.depth) {
+        return;
+    }
+
+    uint64_t word = packTTData(data);
+    atomic_store_explicit(&e->data, word, memory_order_relaxed);
+    atomic_store_explicit(&e->check, hash ^ word, memory_order_relaxed);
+}
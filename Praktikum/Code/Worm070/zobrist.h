@@ -0,0 +1,168 @@
+// Worm070 - Aufgabenblatt 8
+// ============================================================================
+//  zobrist.h – Inkrementeller Hashwert des Spielzustands und
+//              Transpositionstabelle
+//
+//  Idee (Zobrist-Hashing):
+//    Jeder Kombination aus Zelle und BoardCode ist ein fester 64-Bit-
+//    Schlüssel zugeordnet. Der Hashwert des Boards ist das XOR der
+//    Schlüssel aller Zellen. Ändert sich eine Zelle, werden nur der alte
+//    und der neue Schlüssel hineingeXORt; ein Spielschritt kostet damit
+//    wenige Operationen statt eines Durchlaufs über das ganze Feld.
+//
+//  Schlüssel:
+//    Die Felder sind bis zu 4096 x 4096 Zellen groß, eine Schlüsseltabelle
+//    pro Zelle und Code wäre also viel zu groß. Die Schlüssel werden daher
+//    bei Bedarf aus der Zellnummer berechnet (Mischfunktion aus SplitMix64,
+//    zwei Multiplikationen, drei Shifts) und sind für alle Boards gleich.
+//
+//  Board-Anteil (board.hash):
+//    XOR über alle Zellen von cellKey(idx, code) ^ cellKey(idx, BC_BARRIER).
+//    Ein Board, das nur aus Barrieren besteht (Zustand direkt nach
+//    initializeBoard()), hat also den Hashwert 0, und beim Ändern einer
+//    Zelle heben sich die Barrieren-Anteile auf:
+//        hash ^= cellKey(idx, alt) ^ cellKey(idx, neu)
+//    Das erledigt setContentAtIndex(), der einzige Schreibweg ins Modell.
+//
+//  Wurm-Anteil (worm.hash):
+//    Die belegten Zellen stehen schon im Board, nicht aber die Reihenfolge
+//    der Segmente (sie bestimmt, welche Zellen als nächstes frei werden).
+//    Der Wurm führt daher das XOR der Kanten zwischen aufeinanderfolgenden
+//    Segmenten mit: moveWorm() fügt die Kante alter Kopf -> neuer Kopf
+//    hinzu, cleanWormTail() entfernt die Kante Schwanz -> nächstes Segment.
+//
+//  Spielzustand (gameHash()):
+//    Board- und Wurm-Anteil, dazu Kopfzelle, Richtung und ausstehendes
+//    Wachstum. Diese drei Werte stehen direkt im Wurm und werden bei jeder
+//    Abfrage neu gemischt (konstanter Aufwand).
+// ============================================================================
+
+#ifndef _ZOBRIST_H
+#define _ZOBRIST_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "worm.h"
+#include "board_model.h"
+#include "worm_model.h"
+
+// Unterscheidet die Schlüsselarten (Zelle, Kante, Kopf, Zustand)
+#define ZOBRIST_SEED_CELL  0x243f6a8885a308d3ULL
+#define ZOBRIST_SEED_EDGE  0x13198a2e03707344ULL
+#define ZOBRIST_SEED_HEAD  0xa4093822299f31d0ULL
+#define ZOBRIST_SEED_STATE 0x082efa98ec4e6c89ULL
+
+// ============================================================================
+//  Schlüssel
+// ============================================================================
+
+// Mischfunktion aus SplitMix64 (bijektiv, gut verteilte Bits)
+static inline uint64_t zobristMix(uint64_t x, uint64_t seed)
+{
+    x ^= seed;
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+// Schlüssel für BoardCode code in Zelle idx (BoardCodes passen in 3 Bit)
+static inline uint64_t zobristCellKey(cellidx_t idx, cell_t code)
+{
+    return zobristMix((uint64_t)idx << 3 | code, ZOBRIST_SEED_CELL);
+}
+
+// Schlüssel für die Kante zwischen zwei aufeinanderfolgenden Segmenten
+static inline uint64_t zobristEdgeKey(cellidx_t from, cellidx_t to)
+{
+    return zobristMix((uint64_t)from << 32 | to, ZOBRIST_SEED_EDGE);
+}
+
+// Hashwert des kompletten Spielzustands (Board, Wurm, Richtung, Wachstum)
+static inline uint64_t gameHash(struct board* aboard, struct worm* aworm)
+{
+    uint64_t state = (uint64_t)aworm->pending_growth << 3 | aworm->heading;
+
+    return aboard->hash ^ aworm->hash
+         ^ zobristMix(getWormHeadCell(aworm), ZOBRIST_SEED_HEAD)
+         ^ zobristMix(state, ZOBRIST_SEED_STATE);
+}
+
+// Berechnet board.hash bzw. worm.hash vollständig neu (Aufwand über alle
+// Zellen bzw. Segmente). Für Prüfungen (runHeadless() vergleicht sie
+// regelmäßig mit den geführten Werten) und nach direktem Schreiben in
+// cells; im Spiel werden die Werte inkrementell geführt.
+extern uint64_t computeBoardHash(struct board* aboard);
+extern uint64_t computeWormHash(struct worm* aworm);
+
+// ============================================================================
+//  Transpositionstabelle
+//
+//  Feste Größe (2^log2_entries Einträge), ein Eintrag pro Hashwert-Index,
+//  ohne Sperren: mehrere Threads dürfen gleichzeitig lesen und schreiben.
+//
+//  Jeder Eintrag besteht aus zwei 64-Bit-Wörtern:
+//      data   gepackte struct ttData
+//      check  hash ^ data
+//  Beide Wörter werden einzeln atomar geschrieben. Überschneiden sich zwei
+//  Schreiber, passen check und data nicht mehr zusammen; probeTransTable()
+//  erkennt das, weil check ^ data dann nicht den gesuchten Hashwert ergibt,
+//  und meldet einen Fehlzugriff statt falscher Daten.
+//
+//  Ersetzung: ein Eintrag für denselben Zustand mit größerer Suchtiefe
+//  bleibt stehen, sonst gewinnt der neue Eintrag.
+// ============================================================================
+
+// Art des gespeicherten Werts (für Alpha-Beta-artige Suchen)
+enum TTBounds {
+    TT_BOUND_NONE,
+    TT_BOUND_EXACT,
+    TT_BOUND_LOWER,
+    TT_BOUND_UPPER
+};
+
+struct ttData {
+    int32_t value;      // Bewertung des Zustands
+    uint16_t depth;     // Suchtiefe, mit der value ermittelt wurde
+    uint8_t move;       // bester Zug (enum WormHeading)
+    uint8_t bound;      // enum TTBounds
+};
+
+struct ttEntry {
+    atomic_uint_least64_t check;
+    atomic_uint_least64_t data;
+};
+
+struct transTable {
+    struct ttEntry* entries;
+    uint64_t mask;          // Anzahl der Einträge - 1
+};
+
+#define TT_MAX_LOG2_ENTRIES 30
+
+// Legt eine leere Tabelle mit 2^log2_entries Einträgen an (16 Byte je
+// Eintrag). RES_FAILED bei ungültiger Größe oder ohne Speicher.
+extern enum ResCodes initializeTransTable(struct transTable* att,
+                                          int log2_entries);
+
+extern void freeTransTable(struct transTable* att);
+
+// Leert alle Einträge (nicht gleichzeitig mit anderen Zugriffen).
+extern void clearTransTable(struct transTable* att);
+
+// Sucht den Zustand hash. true und *out gefüllt bei einem Treffer.
+extern bool probeTransTable(struct transTable* att, uint64_t hash,
+                            struct ttData* out);
+
+// Speichert data für den Zustand hash (siehe Ersetzung oben).
+// Ein Eintrag, dessen data ganz 0 ist, gilt als leer (so hinterlässt ihn
+// clearTransTable()): data mit value 0, depth 0, move 0 und bound
+// TT_BOUND_NONE wird zwar gespeichert, von probeTransTable() aber nie
+// gefunden. Mit bound != TT_BOUND_NONE tritt das nicht auf.
+extern void storeTransTable(struct transTable* att, uint64_t hash,
+                            struct ttData data);
+
+#endif  // _ZOBRIST_H